@@ -0,0 +1,146 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Helpers shared by the benchmark drivers.
+ */
+
+#include "abczed.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <time.h>
+#include <unistd.h>
+
+double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int bench_synthetic_line(unsigned int *seed, char *buf, size_t bufsize) {
+    static const char words[][8] = {
+        "int", "return", "char", "if", "else", "while", "for", "static",
+        "E.row", "size", "len", "{", "}", "(x)", "0;", "/* */"
+    };
+    int len = 0;
+    int target = 20 + (int)(*seed % 60);
+
+    if (bufsize < 96) return 0;
+    while (len < target) {
+        *seed = *seed * 1103515245 + 12345;
+        const char *w = words[(*seed >> 16) % 16];
+        len += snprintf(buf + len, bufsize - len, "%s ", w);
+    }
+    buf[--len] = '\0';  /* Drop the trailing space */
+    return len;
+}
+
+void bench_load_synthetic(int lines) {
+    unsigned int seed = 12345;
+    char line[128];
+
+    for (int i = 0; i < lines; i++) {
+        int len = bench_synthetic_line(&seed, line, sizeof(line));
+        editor_insert_row(E.numrows, line, len);
+    }
+
+    /* Loading is not part of the workload */
+    free_operations_stack(E.undo_stack);
+    E.undo_stack = NULL;
+    E.dirty = 0;
+}
+
+char *bench_write_synthetic_file(long lines) {
+    const char *dir = getenv("TMPDIR");
+    char path[512];
+    unsigned int seed = 12345;
+    char line[128];
+
+    snprintf(path, sizeof(path), "%s/abczed-bench-XXXXXX", dir ? dir : "/tmp");
+    int fd = mkstemp(path);
+    if (fd == -1) return NULL;
+    FILE *fp = fdopen(fd, "w");
+    if (!fp) {
+        close(fd);
+        unlink(path);
+        return NULL;
+    }
+    for (long i = 0; i < lines; i++) {
+        int len = bench_synthetic_line(&seed, line, sizeof(line));
+        line[len++] = '\n';
+        fwrite(line, 1, len, fp);
+    }
+    if (fclose(fp) != 0) {
+        unlink(path);
+        return NULL;
+    }
+    return strdup(path);
+}
+
+long bench_rss_kb(void) {
+    long pages = 0, resident = 0;
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) return bench_peak_rss_kb();
+    if (fscanf(fp, "%ld %ld", &pages, &resident) != 2) resident = 0;
+    fclose(fp);
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+long bench_peak_rss_kb(void) {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+    return ru.ru_maxrss;  /* KiB on Linux */
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+double bench_percentile(double *samples, size_t n, double pct) {
+    if (n == 0) return 0.0;
+    qsort(samples, n, sizeof(double), cmp_double);
+    size_t i = (size_t)(pct / 100.0 * (double)(n - 1) + 0.5);
+    if (i >= n) i = n - 1;
+    return samples[i];
+}
+
+/* Allocation counting through the linker's --wrap option */
+
+static bench_alloc_stats alloc_stats;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+void *__real_realloc(void *ptr, size_t size);
+void __real_free(void *ptr);
+
+void *__wrap_malloc(size_t size) {
+    alloc_stats.allocs++;
+    alloc_stats.bytes += size;
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size) {
+    alloc_stats.allocs++;
+    alloc_stats.bytes += nmemb * size;
+    return __real_calloc(nmemb, size);
+}
+
+void *__wrap_realloc(void *ptr, size_t size) {
+    alloc_stats.allocs++;
+    alloc_stats.bytes += size;
+    return __real_realloc(ptr, size);
+}
+
+void __wrap_free(void *ptr) {
+    if (ptr) alloc_stats.frees++;
+    __real_free(ptr);
+}
+
+void bench_alloc_get(bench_alloc_stats *stats) {
+    *stats = alloc_stats;
+}
@@ -0,0 +1,45 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Helpers shared by the benchmark drivers.
+ */
+
+#ifndef ABCZED_BENCH_H
+#define ABCZED_BENCH_H
+
+#include <stddef.h>
+
+/* Monotonic clock in seconds */
+double bench_now(void);
+
+/* Write one deterministic pseudo-random line of code-like text into buf
+ * (without newline) and return its length. seed carries the state. */
+int bench_synthetic_line(unsigned int *seed, char *buf, size_t bufsize);
+
+/* Append lines synthetic lines to the buffer through editor_insert_row()
+ * and drop the undo history the load produced */
+void bench_load_synthetic(int lines);
+
+/* Write lines synthetic lines to a new temporary file; returns a malloc'd
+ * path the caller unlinks and frees, or NULL on error */
+char *bench_write_synthetic_file(long lines);
+
+/* Current and peak resident set size in KiB */
+long bench_rss_kb(void);
+long bench_peak_rss_kb(void);
+
+/* Allocation counters, maintained by the malloc wrappers in bench.c when
+ * the driver is linked with -Wl,--wrap=malloc,... (see Makefile) */
+typedef struct bench_alloc_stats {
+    unsigned long allocs;       /* malloc/calloc/realloc calls */
+    unsigned long frees;        /* free calls with a non-NULL pointer */
+    unsigned long bytes;        /* Bytes requested */
+} bench_alloc_stats;
+
+void bench_alloc_get(bench_alloc_stats *stats);
+
+/* Sort samples in place and return the given percentile (0-100) */
+double bench_percentile(double *samples, size_t n, double pct);
+
+#endif /* ABCZED_BENCH_H */
@@ -0,0 +1,278 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * micro - microbenchmarks for the buffer primitives.
+ *
+ * Every primitive is timed at the top, middle and end of synthetic files
+ * of growing size. The per-operation time is then fitted against the
+ * file size on a log-log scale: a slope near 0 means the primitive is
+ * O(1) per call, a slope near 1 means every call is O(n), so editing a
+ * whole file that way is O(n^2). Those cases are flagged.
+ *
+ * Usage: micro [-m max_lines] [-k ops] [-c]
+ *   -m  largest file size (default 262144 lines, sizes step by 4x from 1024)
+ *   -k  operations per measurement (default 512)
+ *   -c  exit with status 1 if any primitive scales with the file size
+ */
+
+#include "abczed.h"
+#include "bench.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define MAX_SIZES 16
+#define BATCHES 8
+
+/* Where in the file the primitive is applied */
+enum position { POS_TOP, POS_MIDDLE, POS_END };
+static const char *position_names[] = { "top", "middle", "end" };
+
+typedef struct primitive {
+    const char *name;
+    int ops_divisor;                /* Run ops / divisor calls (heavy primitives) */
+    void (*setup)(int at, int ops); /* Untimed preparation */
+    void (*run)(int at, int ops);   /* Timed part */
+} primitive;
+
+static int row_at(enum position pos) {
+    switch (pos) {
+        case POS_TOP:    return 0;
+        case POS_MIDDLE: return E.numrows / 2;
+        default:         return E.numrows - 1;
+    }
+}
+
+/* Put the cursor in the middle of row at */
+static void cursor_to(int at) {
+    E.cy = at;
+    E.cx = E.row[at].size / 2;
+}
+
+static void no_setup(int at, int ops) {
+    (void)at;
+    (void)ops;
+}
+
+static void run_insert_row(int at, int ops) {
+    static char line[] = "inserted row of text for the benchmark";
+    for (int i = 0; i < ops; i++) {
+        editor_insert_row(at > E.numrows ? E.numrows : at, line, sizeof(line) - 1);
+    }
+}
+
+static void run_del_row(int at, int ops) {
+    for (int i = 0; i < ops; i++) {
+        editor_del_row(at < E.numrows ? at : E.numrows - 1);
+    }
+}
+
+static void setup_cursor(int at, int ops) {
+    (void)ops;
+    cursor_to(at);
+}
+
+static void run_insert_char(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_insert_char('a' + i % 26);
+    }
+}
+
+static void setup_line_end(int at, int ops) {
+    (void)ops;
+    E.cy = at > 0 ? at : 1;
+    E.cx = E.row[E.cy].size;
+}
+
+/* Backspace; joins lines whenever the cursor reaches column 0 */
+static void run_del_char(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_del_char();
+    }
+}
+
+static void run_insert_newline(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_insert_newline();
+    }
+}
+
+static void setup_undo(int at, int ops) {
+    cursor_to(at);
+    for (int i = 0; i < ops; i++) {
+        editor_insert_char('a' + i % 26);
+        if (i % 32 == 31) editor_insert_newline();
+    }
+}
+
+static void run_undo(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_undo();
+    }
+}
+
+static void setup_redo(int at, int ops) {
+    setup_undo(at, ops);
+    run_undo(at, ops);
+}
+
+static void run_redo(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_redo();
+    }
+}
+
+/* Select 64 lines starting at row at */
+static void select_block(int at) {
+    int start = at + 64 >= E.numrows ? E.numrows - 65 : at;
+    E.sel_start_y = start;
+    E.sel_start_x = 0;
+    E.sel_end_y = start + 64;
+    E.sel_end_x = E.row[start + 64].size;
+    E.selecting = 1;
+}
+
+static void run_copy_selection(int at, int ops) {
+    for (int i = 0; i < ops; i++) {
+        select_block(at);
+        editor_copy_selection();
+    }
+}
+
+/* Copy 8 lines, then paste them at row at */
+static void setup_paste(int at, int ops) {
+    (void)ops;
+    int start = at + 8 >= E.numrows ? E.numrows - 9 : at;
+    E.sel_start_y = start;
+    E.sel_start_x = 0;
+    E.sel_end_y = start + 7;
+    E.sel_end_x = E.row[start + 7].size;
+    E.selecting = 1;
+    editor_copy_selection();
+    editor_selection_clear();
+    cursor_to(at);
+}
+
+static void run_paste(int at, int ops) {
+    (void)at;
+    for (int i = 0; i < ops; i++) {
+        editor_paste();
+    }
+}
+
+static const primitive primitives[] = {
+    { "insert_row",     1,  no_setup,       run_insert_row },
+    { "del_row",        1,  no_setup,       run_del_row },
+    { "insert_char",    1,  setup_cursor,   run_insert_char },
+    { "del_char",       1,  setup_line_end, run_del_char },
+    { "insert_newline", 1,  setup_cursor,   run_insert_newline },
+    { "undo",           1,  setup_undo,     run_undo },
+    { "redo",           1,  setup_redo,     run_redo },
+    { "copy_selection", 8,  no_setup,       run_copy_selection },
+    { "paste",          16, setup_paste,    run_paste },
+};
+
+/* Time one primitive at one position and size; returns ns per call */
+static double measure(const primitive *p, enum position pos, int lines, int ops) {
+    init_editor();
+    bench_load_synthetic(lines);
+    int at = row_at(pos);
+    if (p->run == run_insert_row && pos == POS_END) at = E.numrows;
+
+    p->setup(at, ops);
+
+    /* Time the calls in batches and keep the median batch, so a single
+     * allocator stall (heap growth, consolidation) does not decide the
+     * result */
+    double batch_ns[BATCHES];
+    int per_batch = ops / BATCHES;
+    for (int b = 0; b < BATCHES; b++) {
+        double t0 = bench_now();
+        p->run(at, per_batch);
+        batch_ns[b] = (bench_now() - t0) * 1e9 / per_batch;
+    }
+
+    editor_free_state();
+    return bench_percentile(batch_ns, BATCHES, 50.0);
+}
+
+/* Least-squares slope of log(y) against log(x) */
+static double loglog_slope(const int *x, const double *y, int n) {
+    double sx = 0, sy = 0, sxx = 0, sxy = 0;
+    for (int i = 0; i < n; i++) {
+        double lx = log((double)x[i]), ly = log(y[i] > 1e-3 ? y[i] : 1e-3);
+        sx += lx;
+        sy += ly;
+        sxx += lx * lx;
+        sxy += lx * ly;
+    }
+    double d = n * sxx - sx * sx;
+    return d != 0.0 ? (n * sxy - sx * sy) / d : 0.0;
+}
+
+int main(int argc, char *argv[]) {
+    int max_lines = 262144, ops = 512, check = 0;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "m:k:c")) != -1) {
+        switch (opt) {
+            case 'm': max_lines = atoi(optarg); break;
+            case 'k': ops = atoi(optarg); break;
+            case 'c': check = 1; break;
+            default:
+                fprintf(stderr, "Usage: %s [-m max_lines] [-k ops] [-c]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (ops < 256 || max_lines < 1024) {
+        fprintf(stderr, "micro: need -k >= 256 and -m >= 1024\n");
+        return 1;
+    }
+
+    int sizes[MAX_SIZES], nsizes = 0;
+    for (int n = 1024; n <= max_lines && nsizes < MAX_SIZES; n *= 4) sizes[nsizes++] = n;
+
+    printf("# ns per call; slope of log(time) vs log(lines): ~0 is O(1), ~1 is O(n) per call\n");
+    printf("%-15s %-7s", "primitive", "pos");
+    for (int s = 0; s < nsizes; s++) printf(" %9d", sizes[s]);
+    printf(" %7s  %s\n", "slope", "scaling");
+
+    int flagged = 0;
+    for (size_t i = 0; i < sizeof(primitives) / sizeof(primitives[0]); i++) {
+        const primitive *p = &primitives[i];
+        int calls = ops / p->ops_divisor;
+        for (int pos = POS_TOP; pos <= POS_END; pos++) {
+            double ns[MAX_SIZES];
+            printf("%-15s %-7s", p->name, position_names[pos]);
+            for (int s = 0; s < nsizes; s++) {
+                ns[s] = measure(p, pos, sizes[s], calls);
+                printf(" %9.0f", ns[s]);
+                fflush(stdout);
+            }
+            double slope = nsizes > 1 ? loglog_slope(sizes, ns, nsizes) : 0.0;
+            const char *verdict = "O(1)";
+            if (slope > 1.5) {
+                verdict = "O(n^2) per call  <-- superlinear";
+                flagged++;
+            } else if (slope > 0.5) {
+                verdict = "O(n) per call, O(n^2) per file  <-- quadratic";
+                flagged++;
+            } else if (slope > 0.25) {
+                verdict = "sublinear growth";
+            }
+            printf(" %7.2f  %s\n", slope, verdict);
+        }
+    }
+
+    if (flagged) printf("# %d primitive/position pairs scale with file size\n", flagged);
+    return check && flagged ? 1 : 0;
+}
@@ -0,0 +1,124 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * render_bench - headless frame benchmark.
+ *
+ * Replays scroll, typing and selection workloads against the in-memory
+ * cell grid backend and reports frames per second, cells written per
+ * frame and the bytes each frame would have sent to the TTY.
+ *
+ * Usage: render_bench [-l lines] [-f frames] [-r rows] [-c cols]
+ */
+
+#include "abczed.h"
+#include "render.h"
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+static void report(const char *name, double secs) {
+    render_grid_stats st;
+    render_grid_get_stats(&st);
+    double frames = st.frames ? (double)st.frames : 1.0;
+    printf("%-10s %8lu %12.1f %14.1f %14.1f %12.1f\n", name, st.frames,
+           st.frames / secs, st.cells_written / frames,
+           st.cells_changed / frames, st.tty_bytes / frames);
+}
+
+/* Scroll down one line per frame, wrapping at the end of the file */
+static void bench_scroll(int frames) {
+    E.mode = MODE_NORMAL;
+    E.cx = E.cy = E.rowoff = E.coloff = 0;
+    render_grid_reset_stats();
+    double t0 = bench_now();
+    for (int f = 0; f < frames; f++) {
+        E.cy = (E.cy + 1) % E.numrows;
+        if (E.cx > E.row[E.cy].size) E.cx = E.row[E.cy].size;
+        editor_refresh_screen();
+    }
+    report("scroll", bench_now() - t0);
+}
+
+/* Type text in the middle of the file, one frame per keystroke */
+static void bench_typing(int frames) {
+    static const char text[] = "the quick brown fox jumps over the lazy dog ";
+    E.mode = MODE_INSERT;
+    E.cy = E.numrows / 2;
+    E.cx = 0;
+    render_grid_reset_stats();
+    double t0 = bench_now();
+    for (int f = 0; f < frames; f++) {
+        if (f % 60 == 59) {
+            editor_insert_newline();
+        } else {
+            editor_insert_char(text[f % (sizeof(text) - 1)]);
+        }
+        editor_refresh_screen();
+    }
+    report("typing", bench_now() - t0);
+    E.mode = MODE_NORMAL;
+}
+
+/* Extend a visual selection down one line per frame */
+static void bench_selection(int frames) {
+    E.mode = MODE_SELECTION;
+    E.cy = 0;
+    E.cx = 5;
+    E.rowoff = 0;
+    editor_selection_start();
+    render_grid_reset_stats();
+    double t0 = bench_now();
+    for (int f = 0; f < frames; f++) {
+        if (E.cy < E.numrows - 1) E.cy++;
+        if (E.cx > E.row[E.cy].size) E.cx = E.row[E.cy].size;
+        editor_selection_update();
+        editor_refresh_screen();
+    }
+    report("selection", bench_now() - t0);
+    editor_selection_clear();
+    E.mode = MODE_NORMAL;
+}
+
+int main(int argc, char *argv[]) {
+    int lines = 100000, frames = 20000, rows = 50, cols = 160;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:f:r:c:")) != -1) {
+        switch (opt) {
+            case 'l': lines = atoi(optarg); break;
+            case 'f': frames = atoi(optarg); break;
+            case 'r': rows = atoi(optarg); break;
+            case 'c': cols = atoi(optarg); break;
+            default:
+                fprintf(stderr, "Usage: %s [-l lines] [-f frames] [-r rows] [-c cols]\n", argv[0]);
+                return 1;
+        }
+    }
+    if (lines < 1 || frames < 1 || rows < 3 || cols < 20) {
+        fprintf(stderr, "render_bench: invalid size\n");
+        return 1;
+    }
+
+    init_editor();
+    if (render_grid_init(rows, cols) != 0) {
+        fprintf(stderr, "render_bench: out of memory\n");
+        return 1;
+    }
+    render_set_backend(render_grid_backend());
+    bench_load_synthetic(lines);
+
+    printf("# %d lines, %dx%d screen, %d frames per workload\n", lines, cols, rows, frames);
+    printf("%-10s %8s %12s %14s %14s %12s\n", "workload", "frames", "fps",
+           "cells/frame", "changed/frame", "bytes/frame");
+    bench_scroll(frames);
+    bench_typing(frames);
+    bench_selection(frames);
+
+    render_grid_free();
+    editor_free_state();
+    return 0;
+}
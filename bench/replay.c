@@ -0,0 +1,232 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * replay - keystroke replay benchmark.
+ *
+ * Feeds recorded keystroke scripts through editor_process_keypress()
+ * with a headless screen (the cell grid backend), over synthetic files
+ * of the requested sizes, and prints per-key latency percentiles,
+ * allocation counts and RSS as JSON.
+ *
+ * Usage: replay [-l lines[,lines...]] [-n repeat] [-r rows] [-c cols] script.keys...
+ *
+ * Script format: every character is one key, except that newlines are
+ * ignored, lines starting with '#' are comments, and these names are
+ * written in angle brackets: <Esc> <CR> <BS> <Tab> <Left> <Right> <Up>
+ * <Down> <Home> <End> <PageUp> <PageDown> <lt> and <C-x> for Ctrl-x.
+ */
+
+#include "abczed.h"
+#include "input.h"
+#include "render.h"
+#include "bench.h"
+
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+/* A parsed keystroke script */
+typedef struct key_script {
+    char name[64];
+    int *keys;
+    size_t len;
+} key_script;
+
+static const struct {
+    const char *name;
+    int key;
+} key_names[] = {
+    { "Esc", 27 }, { "CR", '\r' }, { "BS", EKEY_BACKSPACE }, { "Tab", '\t' },
+    { "Left", EKEY_LEFT }, { "Right", EKEY_RIGHT }, { "Up", EKEY_UP },
+    { "Down", EKEY_DOWN }, { "Home", EKEY_HOME }, { "End", EKEY_END },
+    { "PageUp", EKEY_PPAGE }, { "PageDown", EKEY_NPAGE }, { "lt", '<' }
+};
+
+/* Parse "<...>" at s; returns the key and sets *used, or -1 if not a name */
+static int parse_key_name(const char *s, size_t *used) {
+    const char *end = strchr(s, '>');
+    if (!end || end - s > 16) return -1;
+    size_t n = end - s - 1;
+    *used = n + 2;
+
+    if (n == 3 && (s[1] == 'C' || s[1] == 'c') && s[2] == '-')
+        return CTRL_KEY(s[3]);
+    for (size_t i = 0; i < sizeof(key_names) / sizeof(key_names[0]); i++) {
+        if (strlen(key_names[i].name) == n && strncasecmp(s + 1, key_names[i].name, n) == 0)
+            return key_names[i].key;
+    }
+    return -1;
+}
+
+static int load_script(const char *path, key_script *ks) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        perror(path);
+        return -1;
+    }
+
+    const char *base = strrchr(path, '/');
+    base = base ? base + 1 : path;
+    snprintf(ks->name, sizeof(ks->name), "%s", base);
+    char *dot = strrchr(ks->name, '.');
+    if (dot) *dot = '\0';
+
+    size_t cap = 256;
+    ks->keys = malloc(cap * sizeof(int));
+    ks->len = 0;
+
+    char *line = NULL;
+    size_t linecap = 0;
+    ssize_t linelen;
+    while ((linelen = getline(&line, &linecap, fp)) != -1) {
+        if (line[0] == '#') continue;
+        for (ssize_t i = 0; i < linelen; i++) {
+            int key = (unsigned char)line[i];
+            if (key == '\n') continue;
+            if (key == '<') {
+                size_t used;
+                int named = parse_key_name(line + i, &used);
+                if (named != -1) {
+                    key = named;
+                    i += used - 1;
+                }
+            }
+            if (ks->len == cap) {
+                cap *= 2;
+                ks->keys = realloc(ks->keys, cap * sizeof(int));
+            }
+            ks->keys[ks->len++] = key;
+        }
+    }
+    free(line);
+    fclose(fp);
+    return 0;
+}
+
+/* Scripted input backend */
+
+static const int *script_keys;
+static size_t script_len, script_pos;
+
+static int script_read_key(int timeout_ms) {
+    /* No typeahead: a zero-timeout poll (escape-sequence flush) finds
+     * nothing, any real wait gets the next recorded key */
+    if (timeout_ms == 0 || script_pos >= script_len) return EKEY_NONE;
+    return script_keys[script_pos++];
+}
+
+static const input_backend script_input = {
+    script_read_key
+};
+
+/* Run one script over a fresh file of the given size and print a JSON object */
+static int run_one(const key_script *ks, long lines, int repeat, int first) {
+    char *path = bench_write_synthetic_file(lines);
+    if (!path) {
+        fprintf(stderr, "replay: cannot write synthetic file\n");
+        return -1;
+    }
+
+    init_editor();
+    double t0 = bench_now();
+    editor_open(path);
+    double open_sec = bench_now() - t0;
+    editor_refresh_screen();
+
+    size_t total = ks->len * (size_t)repeat;
+    double *lat = malloc(sizeof(double) * (total ? total : 1));
+    size_t n = 0;
+    bench_alloc_stats a0, a1;
+    bench_alloc_get(&a0);
+
+    double start = bench_now();
+    for (int r = 0; r < repeat; r++) {
+        script_keys = ks->keys;
+        script_len = ks->len;
+        script_pos = 0;
+        while (script_pos < script_len) {
+            double k0 = bench_now();
+            int quit = editor_process_keypress();
+            editor_refresh_screen();
+            lat[n++] = (bench_now() - k0) * 1e6;
+            if (quit) break;
+        }
+    }
+    double elapsed = bench_now() - start;
+    bench_alloc_get(&a1);
+    long rss = bench_rss_kb();
+
+    double mean = n ? elapsed * 1e6 / n : 0.0;
+    double p50 = bench_percentile(lat, n, 50.0);
+    double p99 = bench_percentile(lat, n, 99.0);
+    double max = n ? lat[n - 1] : 0.0;
+
+    printf("%s    {\"script\": \"%s\", \"lines\": %ld, \"keys\": %zu, "
+           "\"open_ms\": %.3f, \"total_ms\": %.3f, "
+           "\"latency_us\": {\"mean\": %.3f, \"p50\": %.3f, \"p99\": %.3f, \"max\": %.3f}, "
+           "\"allocs\": %lu, \"frees\": %lu, \"alloc_bytes\": %lu, "
+           "\"rss_kb\": %ld, \"peak_rss_kb\": %ld}",
+           first ? "" : ",\n", ks->name, lines, n,
+           open_sec * 1e3, elapsed * 1e3, mean, p50, p99, max,
+           a1.allocs - a0.allocs, a1.frees - a0.frees, a1.bytes - a0.bytes,
+           rss, bench_peak_rss_kb());
+    fflush(stdout);
+
+    free(lat);
+    editor_free_state();
+    unlink(path);
+    free(path);
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    const char *sizes = "1000,10000,100000,1000000";
+    int repeat = 1, rows = 50, cols = 160;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "l:n:r:c:")) != -1) {
+        switch (opt) {
+            case 'l': sizes = optarg; break;
+            case 'n': repeat = atoi(optarg); break;
+            case 'r': rows = atoi(optarg); break;
+            case 'c': cols = atoi(optarg); break;
+            default: goto usage;
+        }
+    }
+    if (optind >= argc || repeat < 1 || rows < 3 || cols < 20) goto usage;
+
+    if (render_grid_init(rows, cols) != 0) {
+        fprintf(stderr, "replay: out of memory\n");
+        return 1;
+    }
+    render_set_backend(render_grid_backend());
+    input_set_backend(&script_input);
+
+    printf("{\"bench\": \"replay\", \"rows\": %d, \"cols\": %d, \"repeat\": %d, \"results\": [\n",
+           rows, cols, repeat);
+    int first = 1;
+    for (int i = optind; i < argc; i++) {
+        key_script ks;
+        if (load_script(argv[i], &ks) != 0) return 1;
+
+        const char *p = sizes;
+        while (*p) {
+            long lines = strtol(p, (char **)&p, 10);
+            if (lines > 0 && run_one(&ks, lines, repeat, first) == 0) first = 0;
+            while (*p && !isdigit((unsigned char)*p)) p++;
+        }
+        free(ks.keys);
+    }
+    printf("\n]}\n");
+
+    render_grid_free();
+    return 0;
+
+usage:
+    fprintf(stderr, "Usage: %s [-l lines[,lines...]] [-n repeat] [-r rows] [-c cols] script.keys...\n", argv[0]);
+    return 1;
+}
@@ -0,0 +1,428 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * libabczed - the editor core.
+ *
+ * Buffer, undo/redo, file I/O and the command engine live here and do
+ * not depend on ncurses. Front ends (the terminal UI in abczed.c, the
+ * benchmark drivers) include this header and link against libabczed.a.
+ */
+
+#ifndef ABCZED_H
+#define ABCZED_H
+
+/* Enable POSIX.1-2008 features on Linux */
+#ifdef __linux__
+#ifndef _POSIX_C_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+#endif
+
+#include <stddef.h>
+#include <time.h>
+
+/* Safe implementation of strdup if not available (defined in buffer.c) */
+#ifndef HAVE_STRDUP
+char *strdup(const char *s);
+#endif
+
+#define ABCZED_VERSION "0.0.3"
+
+/* Editor modes */
+enum editor_mode {
+    MODE_NORMAL,
+    MODE_INSERT,
+    MODE_COMMAND,
+    MODE_SELECTION  // New mode for text selection
+};
+
+/* Line endings, encodings and compression of the file on disk */
+enum file_eol {
+    EOL_LF,
+    EOL_CRLF,
+    EOL_CR
+};
+
+enum file_encoding {
+    ENC_UTF8,
+    ENC_UTF16LE,
+    ENC_UTF16BE,
+    ENC_LATIN1
+};
+
+enum file_compression {
+    COMP_NONE,
+    COMP_GZIP,
+    COMP_ZSTD,
+    COMP_XZ
+};
+
+/* Undo/Redo operation types */
+enum operation_type {
+    OP_INSERT_CHAR,
+    OP_DELETE_CHAR,
+    OP_INSERT_LINE,
+    OP_DELETE_LINE,
+    OP_NEWLINE,
+    OP_REPLACE_ROWS,      // Batched edit of a run of rows
+    OP_SWAP_ROWS          // Batched edit of scattered rows, in place
+};
+
+/* Undo/Redo operation structure */
+typedef struct operation {
+    enum operation_type type;
+    int cx, cy;           // Cursor position
+    char c;               // Character (for insert/delete char)
+    char *line;           // Line content (for insert/delete line)
+    int line_size;        // Line size
+    struct erow *rows;    // Saved rows (for replace rows)
+    int nrows;            // Number of saved rows
+    int span;             // Rows the edit left in their place
+    int *ys;              // Row of each saved row (for swap rows)
+    struct operation *next;
+} operation;
+
+/* Data structure for a single line of text */
+typedef struct erow {
+    int size;
+    char *chars;
+} erow;
+
+/* Part of a row text block held by a register (see register.c) */
+typedef struct yank_piece {
+    char *text;                 /* Row text block, referenced */
+    int start, len;             /* Bytes of text taken */
+    int eol;                    /* Line break after this piece */
+} yank_piece;
+
+/* What a yank took: text, whole lines, which are put as rows, or a
+ * block, which is put column-wise */
+enum yank_kind {
+    YANK_CHARS = 0,
+    YANK_LINES,
+    YANK_BLOCK
+};
+
+/* Register contents, shared between registers by reference count */
+typedef struct yank_text {
+    unsigned refs;
+    int count, cap;             /* Pieces used and allocated */
+    int kind;                   /* enum yank_kind */
+    int lines;                  /* Line breaks + 1, or whole lines taken */
+    int width;                  /* Display columns of a block */
+    size_t bytes;               /* Text bytes, line breaks included */
+    yank_piece *pieces;
+} yank_text;
+
+/* Editor configuration structure */
+typedef struct editor_config {
+    int cx, cy;                  /* Cursor x and y position */
+    int rowoff;                  /* Row offset */
+    int coloff;                  /* Column offset */
+    int screenrows;              /* Number of rows that we can show */
+    int screencols;             /* Number of columns that we can show */
+    int numrows;                /* Number of rows */
+    erow *row;                  /* Rows */
+    int dirty;                  /* File modified but not saved */
+    char *filename;             /* Currently open filename */
+    enum file_eol eol;          /* Line ending the file is saved with */
+    enum file_encoding encoding; /* Encoding the file is saved in */
+    int bom;                    /* File starts with a byte order mark */
+    int noeol;                  /* Last line has no line ending */
+    enum file_compression compression; /* Compression the file is saved with */
+    char statusmsg[80];         /* Status message */
+    time_t statusmsg_time;      /* When to clear status message */
+    enum editor_mode mode;       /* Current editor mode */
+    int show_line_numbers;      /* Whether to show line numbers */
+    int font_size;              /* Font size for display */
+    char commandbuf[256];       /* Buffer for command input */
+    int commandlen;             /* Length of command in buffer */
+    int sel_start_x, sel_start_y; /* Selection start position */
+    int sel_end_x, sel_end_y;   /* Selection end position */
+    int selecting;              /* Currently selecting text */
+    int sel_block;              /* Selection is a rectangle (block visual) */
+    operation *undo_stack;      /* Stack for undo operations */
+    operation *redo_stack;      /* Stack for redo operations */
+} editor_config;
+
+extern editor_config E;
+
+/* Return values of editor_process_command() */
+#define EDITOR_CMD_IGNORED 0    /* Empty or invalid command */
+#define EDITOR_CMD_OK      1    /* Command handled */
+#define EDITOR_CMD_QUIT    2    /* Front end should clean up and exit */
+
+/* Editor state (editor.c) */
+void init_editor(void);
+void editor_free_state(void);
+void editor_set_status(const char *fmt, ...);
+void editor_change_font_size(int delta);
+
+/* Subsystem owning an allocation, for the per-tag accounting in mem.c */
+enum mem_tag {
+    MEM_ROW_TEXT,       /* erow.chars */
+    MEM_ROW_ARRAY,      /* E.row */
+    MEM_UNDO,           /* Undo/redo records and their saved text */
+    MEM_REGISTERS,      /* Register contents (the text itself is shared row text) */
+    MEM_RENDER,         /* Render backend buffers */
+    MEM_MISC,           /* Filename and other small state */
+    MEM_INDEX,          /* Indexes over the rows (brackets, folds) */
+    MEM_TAG_COUNT
+};
+
+/* Tagged allocator (mem.c). A block must be reallocated and freed with
+ * the tag it was allocated with. */
+void *editor_malloc(enum mem_tag tag, size_t size);
+void *editor_realloc(enum mem_tag tag, void *ptr, size_t size);
+void editor_free(enum mem_tag tag, void *ptr);
+char *editor_strdup(enum mem_tag tag, const char *s);
+
+/* Undo/redo (undo.c) */
+void free_operation(operation *op);
+void free_operations_stack(operation *stack);
+void push_operation(operation **stack, enum operation_type type, int cx, int cy, char c, char *line, int line_size);
+void editor_undo(void);
+void editor_redo(void);
+
+/* A batched edit saves rows [at, at+count) by reference before changing
+ * them and records how many rows it left in their place; it then undoes
+ * and redoes as one step. */
+int undo_begin_rows(int at, int count);
+void undo_end_rows(int count);
+
+/* Fold the records pushed since mark (the top of the stack then) into
+ * one step: rows [at, at+span) were the nbefore rows in before, a
+ * MEM_UNDO array it takes over. Returns -1 if mark is gone. */
+int undo_collapse(operation *mark, int cx, int at, erow *before, int nbefore, int span);
+
+/* A batched edit of rows ys[0..count), sorted, that changes them in
+ * place; only those rows are saved, however far apart they are */
+int undo_begin_row_set(const int *ys, int count);
+
+/* Rows and characters (buffer.c) */
+char *row_text_alloc(size_t len);
+char *row_text_new(const char *s, size_t len);
+char *row_text_ref(char *chars);
+void row_text_unref(char *chars);
+int row_text_reserve(erow *row, size_t size);
+void editor_row_changed(int y);
+void editor_insert_row(int at, char *s, size_t len);
+int editor_load_row(const char *s, size_t len, int *cap);
+void editor_rows_loaded(int at);
+void editor_free_row(erow *row);
+void editor_del_row(int at);
+int editor_swap_rows(int at, int count, erow **rows, int *nrows);
+int editor_row_cx_to_rx(erow *row, int cx);
+int editor_row_rx_to_cx(erow *row, int rx);
+void editor_insert_char(int c);
+void editor_insert_newline(void);
+void editor_del_char(void);
+void editor_del_char_forward(void);
+
+/* Batched edits (buffer.c); each is one undo step whatever the count */
+void editor_insert_text(const char *s, size_t len, long times);
+void editor_delete_lines(long n);
+void editor_delete_range(int y0, int x0, int y1, int x1);
+void editor_replace_range(int y0, int x0, int y1, int x1, const char *s, size_t len);
+int editor_yank_lines(int at, int count);
+
+/* Selection, yank and put (buffer.c) */
+void editor_selection_start(void);
+void editor_selection_update(void);
+void editor_selection_clear(void);
+void editor_selection_normalize(void);
+int is_position_selected(int x, int y);
+int editor_selection_span(int y, int *x0, int *x1);
+void editor_select_all(void);
+void editor_copy_selection(void);
+void editor_delete_selection(void);
+void editor_paste(void);
+void editor_put(long times, int before);
+
+/* Block selection edits (buffer.c). Each applies to every row of the
+ * block in one pass and is one undo step. */
+void editor_block_insert(const char *s, int len, int append);
+void editor_block_change(const char *s, int len);
+void editor_block_replace(int c);
+
+/* Registers (register.c). register_select() picks the register for the
+ * next yank or put; "A-"Z append to "a-"z. register_yank_block() takes
+ * display columns [x0, x1). */
+int register_select(int name);
+int register_pending(void);
+int register_yank(int y0, int x0, int y1, int x1);
+int register_yank_lines(int y0, int y1);
+int register_yank_block(int y0, int y1, int x0, int x1);
+const yank_text *register_take(void);
+const yank_text *register_get(int name);
+void register_list(char *buf, size_t size);
+void registers_free(void);
+yank_text *yank_ref(yank_text *t);
+void yank_unref(yank_text *t);
+
+/* Multiple cursors (cursors.c). Cursors are kept sorted by position;
+ * each edit applies at all of them in one pass over the affected rows
+ * and is one undo step. E.cx/E.cy follow the first cursor. Row edits
+ * move the cursors with their lines. */
+typedef struct cursor_pos {
+    int y, x;
+} cursor_pos;
+
+int cursors_add_matches(const char *s, int len);
+int cursors_add_lines(int y0, int y1, int x);
+void cursors_clear(void);
+void cursors_clamp(void);
+int cursors_count(void);
+const cursor_pos *cursors_list(void);
+int cursors_row_start(int y);
+void cursors_insert(const char *s, int len);
+void cursors_delete(int before, int after);
+void cursors_move(int dx);
+void cursors_set(int i, int y, int x);
+void cursors_settle(void);
+void cursors_rows_replaced(int at, int count, int n);
+
+/* Bracket index (brackets.c). Row edits report the rows they touch,
+ * after the change; bracket_match() finds the bracket matching the one
+ * at (y, x) and bracket_enclosing() the nearest unmatched open bracket
+ * at or before (y, x), or -1 if there is none. */
+void brackets_row_changed(int y);
+void brackets_rows_replaced(int at, int count, int n);
+void brackets_free(void);
+int bracket_match(int y, int x, int *my, int *mx);
+int bracket_enclosing(char open, int y, int x, int *oy, int *ox);
+
+/* Folds (fold.c). Screen rows count a closed fold as its first line;
+ * folds_visible() gives the screen row of buffer row y (counted from the
+ * top of the buffer) and folds_row() the buffer row of screen row v.
+ * fold_line() is the line shown for y, the fold's first line if y is
+ * hidden, and fold_closed_end() the last line of the closed fold shown
+ * on line y, or -1. */
+int fold_create(int y0, int y1);
+int fold_command(int key, int y);
+int folds_from(int brace, int level);
+int folds_count(void);
+int folds_visible(int y);
+int folds_row(int v);
+int folds_visible_count(void);
+int fold_line(int y);
+int fold_closed_end(int y);
+void folds_rows_replaced(int at, int count, int n);
+void folds_free(void);
+
+/* Tracked positions (anchor.c). anchor_new() returns a handle to a
+ * position that moves with its line as rows are inserted and deleted,
+ * or -1. row_map() is where row y goes when rows [at, at+count) become
+ * n rows; is_end maps a deleted row to the row before instead of after. */
+int anchor_new(int y, int x);
+int anchor_set(int h, int y, int x);
+int anchor_get(int h, int *y, int *x);
+void anchor_free(int h);
+int row_map(int y, int at, int count, int n, int is_end);
+void anchors_rows_replaced(int at, int count, int n);
+void anchors_free(void);
+
+/* Marks and jump list (mark.c). jump_push() records the position left
+ * by a jump; jumps_go() moves steps entries through the list (negative
+ * is back) from the cursor at (y, x). */
+int mark_set(int name, int y, int x);
+int mark_get(int name, int *y, int *x);
+void jump_push(int y, int x);
+int jumps_go(long steps, int y, int x, int *py, int *px);
+void marks_free(void);
+
+/* Indentation (indent.c). indent_newline() writes the indentation for
+ * the new line at the cursor into buf and returns its length;
+ * indent_electric() lines up a closing bracket just typed as the first
+ * thing on its line, returning 1 if it moved; editor_reindent() reindents rows y0..y1 as one undo step and returns
+ * how many lines changed, or -1. */
+void indent_set_auto(int on);
+int indent_auto(void);
+int indent_newline(char *buf, int cap);
+int indent_electric(void);
+int editor_reindent(int y0, int y1);
+
+/* Hex view (hex.c). While it is on the file is shown as offset, hex and
+ * text columns from a mapping instead of rows (E.numrows is 0), keys go
+ * to hex_key() outside the command line and editor_save() writes only
+ * the patched bytes back. Lines are HEX_LINE_BYTES bytes. */
+#define HEX_LINE_BYTES 16
+
+typedef struct hex_view {
+    long long size;             /* File length */
+    long long cursor;           /* Offset of the byte under the cursor */
+    long long top;              /* First line on screen */
+    int nibble;                 /* Next hex digit typed is the low one */
+    int text;                   /* Cursor is in the text column */
+    int width;                  /* Hex digits of the offset column */
+} hex_view;
+
+int hex_open(const char *filename);
+void hex_close(void);
+const hex_view *hex_state(void);
+int hex_column(int i, int text);
+size_t hex_read(long long off, unsigned char *buf, unsigned char *patched, size_t n);
+void hex_scroll(void);
+int hex_key(int c);
+int hex_save(void);
+
+/* CSV view (csv.c). While it is on (csv_delim() is the delimiter, 0
+ * when off) rows are drawn as aligned columns CSV_SEP cells apart, the
+ * header row stays on top and ] and [ move by field. csv_fields() gives
+ * the offsets ending each field of row y; csv_field() the text of field
+ * i without its quotes; csv_same_column() is the offset on row to in
+ * the same field as x on row from, for moving up and down. Positions are in screen cells from the left of
+ * the first column. csv_sort() reorders the rows below the header by
+ * column col as one undo step and returns how many it sorted, or -1.
+ * csv_from_filename() is the delimiter *.csv and *.tsv files open with,
+ * or 0. */
+#define CSV_SEP 3
+
+int csv_enable(int delim);
+void csv_disable(void);
+int csv_delim(void);
+int csv_from_filename(const char *name);
+void csv_set_header(int on);
+int csv_header_rows(void);
+int csv_fields(int y, const int **ends);
+void csv_field(int y, int i, int *start, int *end);
+int csv_width(int i);
+int csv_column_x(int i);
+int csv_field_at(int y, int x);
+int csv_same_column(int from, int x, int to);
+int csv_display_x(int y, int x);
+int csv_coloff(void);
+int csv_screen_row(int line);
+void csv_scroll(void);
+int csv_next_field(int y, int x, long count);
+int csv_sort(int col, int desc);
+void csv_row_changed(int y);
+void csv_rows_replaced(int at, int count, int n);
+
+/* Diff gutter (diff.c). While it is on, a column left of the text
+ * marks rows added (+), changed (~) and where rows were deleted (_)
+ * since the base: the file as last opened or saved, or its git HEAD
+ * blob. diff_mark() is the mark of row y, ' ' when it has none. */
+int diff_enable(int head);
+void diff_disable(void);
+int diff_head(void);
+int diff_gutter_width(void);
+int diff_mark(int y);
+void diff_summary(int *added, int *changed, int *deleted);
+void diff_saved(void);
+void diff_row_changed(int y);
+void diff_rows_replaced(int at, int count, int n);
+
+/* Viewport (buffer.c) */
+void editor_scroll(void);
+
+/* File I/O (fileio.c) */
+int editor_open(char *filename);
+int editor_save(void);
+
+/* Command engine (command.c) */
+int process_command_prefix(char *cmd);
+int editor_process_command(void);
+
+#endif /* ABCZED_H */
@@ -0,0 +1,197 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Tracked positions.
+ *
+ * Marks, the jump list and the selection anchor hold positions that
+ * must follow their lines as rows are inserted and deleted above them.
+ * They all live here, sorted by line. Each slot stores its line minus
+ * the line of the slot before, and a Fenwick tree sums those, so a
+ * slot's line is a prefix sum and the first slot at or after a line is
+ * found by descending the tree. A row edit then rewrites only the
+ * slots inside the replaced rows plus the one difference after them,
+ * which shifts every later position at once: O(log n) per edit instead
+ * of visiting every position.
+ *
+ * Creating, moving and freeing a position rebuilds the tree, O(n); those
+ * happen once per command, not once per edit.
+ */
+
+#include "abczed.h"
+
+#include <string.h>
+
+typedef struct anchor {
+    int slot;       /* Sorted slot, -1 if the handle is free */
+    int x;
+} anchor;
+
+static struct {
+    int *delta;     /* Line of each slot minus the line of the slot before */
+    int *tree;      /* Fenwick tree over delta, 1-based */
+    int *owner;     /* Handle in each slot */
+    int n, cap;
+    anchor *a;
+    int na, acap;
+} A;
+
+void anchors_free(void) {
+    editor_free(MEM_INDEX, A.delta);
+    editor_free(MEM_INDEX, A.tree);
+    editor_free(MEM_INDEX, A.owner);
+    editor_free(MEM_INDEX, A.a);
+    memset(&A, 0, sizeof(A));
+}
+
+int row_map(int y, int at, int count, int n, int is_end) {
+    if (y < at) return y;
+    if (y >= at + count) return y + n - count;
+    if (n == 0) return is_end ? at - 1 : at;
+    return at + (y - at < n - 1 ? y - at : n - 1);
+}
+
+/* Line of slot i */
+static int slot_line(int i) {
+    int sum = 0;
+    for (i++; i > 0; i -= i & -i) sum += A.tree[i];
+    return sum;
+}
+
+static void tree_add(int i, int v) {
+    for (i++; i <= A.n; i += i & -i) A.tree[i] += v;
+}
+
+static void tree_build(void) {
+    for (int i = 1; i <= A.n; i++) A.tree[i] = A.delta[i - 1];
+    for (int i = 1; i <= A.n; i++) {
+        int j = i + (i & -i);
+        if (j <= A.n) A.tree[j] += A.tree[i];
+    }
+}
+
+/* First slot whose line is y or more; A.n if none */
+static int slot_at_or_after(int y) {
+    int pos = 0, sum = 0, step = 1;
+    while (step * 2 <= A.n) step *= 2;
+    for (; step > 0; step /= 2) {
+        if (pos + step <= A.n && sum + A.tree[pos + step] < y) {
+            pos += step;
+            sum += A.tree[pos];
+        }
+    }
+    return pos;
+}
+
+static void slots_renumber(int from) {
+    for (int i = from; i < A.n; i++) A.a[A.owner[i]].slot = i;
+}
+
+static int slot_insert(int h, int y) {
+    if (A.n == A.cap) {
+        int cap = A.cap ? A.cap * 2 : 16;
+        int *d = editor_realloc(MEM_INDEX, A.delta, sizeof(int) * cap);
+        if (d == NULL) return -1;
+        A.delta = d;
+        int *o = editor_realloc(MEM_INDEX, A.owner, sizeof(int) * cap);
+        if (o == NULL) return -1;
+        A.owner = o;
+        int *t = editor_realloc(MEM_INDEX, A.tree, sizeof(int) * (cap + 1));
+        if (t == NULL) return -1;
+        A.tree = t;
+        A.cap = cap;
+    }
+    int p = slot_at_or_after(y + 1);
+    int prev = p > 0 ? slot_line(p - 1) : 0;
+    if (p < A.n) {
+        int next = slot_line(p);
+        memmove(&A.delta[p + 1], &A.delta[p], sizeof(int) * (A.n - p));
+        memmove(&A.owner[p + 1], &A.owner[p], sizeof(int) * (A.n - p));
+        A.delta[p + 1] = next - y;
+    }
+    A.delta[p] = y - prev;
+    A.owner[p] = h;
+    A.n++;
+    slots_renumber(p);
+    tree_build();
+    return 0;
+}
+
+static void slot_remove(int p) {
+    if (p + 1 < A.n) A.delta[p + 1] += A.delta[p];
+    memmove(&A.delta[p], &A.delta[p + 1], sizeof(int) * (A.n - p - 1));
+    memmove(&A.owner[p], &A.owner[p + 1], sizeof(int) * (A.n - p - 1));
+    A.n--;
+    slots_renumber(p);
+    tree_build();
+}
+
+static int valid(int h) {
+    return h >= 0 && h < A.na && A.a[h].slot >= 0;
+}
+
+int anchor_new(int y, int x) {
+    int h = 0;
+    while (h < A.na && A.a[h].slot >= 0) h++;
+    if (h == A.na) {
+        if (A.na == A.acap) {
+            int cap = A.acap ? A.acap * 2 : 16;
+            anchor *a = editor_realloc(MEM_INDEX, A.a, sizeof(anchor) * cap);
+            if (a == NULL) return -1;
+            A.a = a;
+            A.acap = cap;
+        }
+        A.na++;
+    }
+    if (slot_insert(h, y < 0 ? 0 : y) == -1) {
+        A.a[h].slot = -1;
+        return -1;
+    }
+    A.a[h].x = x;
+    return h;
+}
+
+int anchor_set(int h, int y, int x) {
+    if (!valid(h)) return -1;
+    slot_remove(A.a[h].slot);
+    if (slot_insert(h, y < 0 ? 0 : y) == -1) {
+        A.a[h].slot = -1;
+        return -1;
+    }
+    A.a[h].x = x;
+    return 0;
+}
+
+int anchor_get(int h, int *y, int *x) {
+    if (!valid(h)) return -1;
+    *y = slot_line(A.a[h].slot);
+    *x = A.a[h].x;
+    return 0;
+}
+
+void anchor_free(int h) {
+    if (!valid(h)) return;
+    slot_remove(A.a[h].slot);
+    A.a[h].slot = -1;
+}
+
+void anchors_rows_replaced(int at, int count, int n) {
+    if (A.n == 0 || count == n) return;
+    int i0 = slot_at_or_after(at);
+    if (i0 == A.n) return;
+    int i1 = slot_at_or_after(at + count);
+
+    /* Map the slots in the replaced rows, then move the one after them
+     * by the change in rows; the slots after that keep their deltas */
+    int prev = i0 > 0 ? slot_line(i0 - 1) : 0;
+    int old = prev;
+    int last = i1 < A.n ? i1 : A.n - 1;
+    for (int i = i0; i <= last; i++) {
+        old += A.delta[i];
+        int line = i < i1 ? row_map(old, at, count, n, 0) : old + n - count;
+        int d = line - prev;
+        tree_add(i, d - A.delta[i]);
+        A.delta[i] = d;
+        prev = line;
+    }
+}
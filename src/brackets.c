@@ -0,0 +1,373 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Bracket matching index.
+ *
+ * Rows are grouped into blocks of one to two BRACKET_BLOCKs. For each
+ * kind of bracket a block keeps its net depth and the lowest depth
+ * reached reading it forwards (and the highest reading it backwards),
+ * and a segment tree over the blocks combines them. A match is found by
+ * scanning the rest of the bracket's own block, descending the tree to
+ * the first block where the depth can return to zero, and scanning that
+ * one: O(log n) steps plus two blocks of text, however far apart the
+ * brackets are.
+ *
+ * The index is built on the first lookup. After that, row edits only
+ * mark their block stale and adjust row counts; stale blocks are
+ * rescanned on the next lookup, so a burst of typing costs one rescan.
+ */
+
+#include "abczed.h"
+
+#include <string.h>
+
+/* Rows per block; blocks grow to twice this before splitting */
+#define BRACKET_BLOCK 64
+
+static const char brackets[] = "()[]{}";
+#define KINDS 3
+
+/* Depth summary of a run of text for one kind of bracket. Combining a
+ * run a with the run b after it: net = a.net + b.net, low =
+ * min(a.low, a.net + b.low), high = max(b.high, b.net + a.high). */
+typedef struct depth_sum {
+    int net;        /* Opens minus closes */
+    int low;        /* Lowest depth reached reading forwards, <= 0 */
+    int high;       /* Highest depth reached reading backwards, >= 0 */
+} depth_sum;
+
+typedef struct bracket_node {
+    int rows;
+    int stale;      /* Blocks only: text changed since the last scan */
+    depth_sum d[KINDS];
+} bracket_node;
+
+static struct {
+    int built;
+    bracket_node *blocks;
+    int nblocks;
+    bracket_node *tree;     /* tree[1] is the root, block i is tree[leaves + i] */
+    int leaves;
+    int *stale;             /* Stale block numbers */
+    int nstale, stale_cap;
+} X;
+
+/* Bracket kind and depth change of c, or 0 */
+static int bracket_step(char c, int *kind) {
+    const char *b = c != '\0' ? strchr(brackets, c) : NULL;
+    if (b == NULL) return 0;
+    *kind = (int)(b - brackets) / 2;
+    return ((b - brackets) & 1) ? -1 : 1;
+}
+
+/* Append len bytes of text to the summaries in d */
+static void scan_text(const char *s, int len, depth_sum d[KINDS]) {
+    for (int i = 0; i < len; i++) {
+        /* Most bytes are not brackets; skip them with one test */
+        unsigned char c = (unsigned char)s[i];
+        if (c != '(' && c != ')' && c != '[' && c != ']' && c != '{' && c != '}') continue;
+        int k = 0, v = bracket_step((char)c, &k);
+        depth_sum *t = &d[k];
+        t->net += v;
+        if (t->net < t->low) t->low = t->net;
+        t->high = t->high + v > 0 ? t->high + v : 0;
+    }
+}
+
+static void combine(bracket_node *out, const bracket_node *a, const bracket_node *b) {
+    out->rows = a->rows + b->rows;
+    for (int k = 0; k < KINDS; k++) {
+        const depth_sum *x = &a->d[k], *y = &b->d[k];
+        int low = x->net + y->low, high = y->net + x->high;
+        out->d[k].net = x->net + y->net;
+        out->d[k].low = x->low < low ? x->low : low;
+        out->d[k].high = y->high > high ? y->high : high;
+    }
+}
+
+static void block_scan(int i, int start) {
+    bracket_node *b = &X.blocks[i];
+    memset(b->d, 0, sizeof(b->d));
+    for (int y = start; y < start + b->rows; y++) {
+        scan_text(E.row[y].chars, E.row[y].size, b->d);
+    }
+    b->stale = 0;
+}
+
+static void tree_update(int i) {
+    int n = X.leaves + i;
+    X.tree[n] = X.blocks[i];
+    for (n /= 2; n > 0; n /= 2) combine(&X.tree[n], &X.tree[2 * n], &X.tree[2 * n + 1]);
+}
+
+/* Rebuild the tree after blocks were added or removed; the block sums
+ * are kept, stale or not */
+static int tree_rebuild(void) {
+    int leaves = 1;
+    while (leaves < X.nblocks) leaves *= 2;
+    if (leaves != X.leaves) {
+        bracket_node *t = editor_realloc(MEM_INDEX, X.tree, sizeof(bracket_node) * 2 * leaves);
+        if (t == NULL) return -1;
+        X.tree = t;
+        X.leaves = leaves;
+    }
+    memset(X.tree, 0, sizeof(bracket_node) * 2 * leaves);
+    memcpy(&X.tree[leaves], X.blocks, sizeof(bracket_node) * X.nblocks);
+    for (int n = leaves - 1; n > 0; n--) combine(&X.tree[n], &X.tree[2 * n], &X.tree[2 * n + 1]);
+    return 0;
+}
+
+static int mark_stale(int i) {
+    if (X.blocks[i].stale) return 0;
+    if (X.nstale == X.stale_cap) {
+        int cap = X.stale_cap ? X.stale_cap * 2 : 16;
+        int *s = editor_realloc(MEM_INDEX, X.stale, sizeof(int) * cap);
+        if (s == NULL) return -1;
+        X.stale = s;
+        X.stale_cap = cap;
+    }
+    X.blocks[i].stale = 1;
+    X.stale[X.nstale++] = i;
+    return 0;
+}
+
+/* Block holding row y and its first row; a y past the end is in the
+ * last block */
+static int block_at(int y, int *start) {
+    if (y >= X.tree[1].rows) {
+        int i = X.nblocks - 1;
+        *start = X.tree[1].rows - X.blocks[i].rows;
+        return i;
+    }
+    int n = 1, lo = 0;
+    while (n < X.leaves) {
+        if (y < lo + X.tree[2 * n].rows) {
+            n = 2 * n;
+        } else {
+            lo += X.tree[2 * n].rows;
+            n = 2 * n + 1;
+        }
+    }
+    *start = lo;
+    return n - X.leaves;
+}
+
+static int block_start(int i) {
+    int start = 0;
+    for (int n = X.leaves + i; n > 1; n /= 2) {
+        if (n & 1) start += X.tree[n - 1].rows;
+    }
+    return start;
+}
+
+void brackets_free(void) {
+    editor_free(MEM_INDEX, X.blocks);
+    editor_free(MEM_INDEX, X.tree);
+    editor_free(MEM_INDEX, X.stale);
+    memset(&X, 0, sizeof(X));
+}
+
+static int build(void) {
+    int n = (E.numrows + BRACKET_BLOCK - 1) / BRACKET_BLOCK;
+    X.blocks = editor_malloc(MEM_INDEX, sizeof(bracket_node) * (n > 0 ? n : 1));
+    if (X.blocks == NULL) return -1;
+    X.nblocks = n;
+    for (int i = 0; i < n; i++) {
+        int start = i * BRACKET_BLOCK;
+        X.blocks[i].rows = E.numrows - start < BRACKET_BLOCK ? E.numrows - start : BRACKET_BLOCK;
+        block_scan(i, start);
+    }
+    if (tree_rebuild() == -1) {
+        brackets_free();
+        return -1;
+    }
+    X.built = 1;
+    return 0;
+}
+
+/* Build the index or bring stale blocks up to date */
+static int brackets_ready(void) {
+    if (!X.built) return build();
+    for (int j = 0; j < X.nstale; j++) {
+        int i = X.stale[j];
+        block_scan(i, block_start(i));
+        tree_update(i);
+    }
+    X.nstale = 0;
+    return 0;
+}
+
+void brackets_row_changed(int y) {
+    if (!X.built) return;
+    int start;
+    if (mark_stale(block_at(y, &start)) == -1) brackets_free();
+}
+
+/* Drop emptied blocks in [first, last] and split an oversized first
+ * block, then rebuild the tree */
+static int reshape(int first, int last) {
+    int rows = X.blocks[first].rows;
+    int pieces = rows > 2 * BRACKET_BLOCK ? rows / BRACKET_BLOCK : 1;
+    bracket_node *b = editor_malloc(MEM_INDEX, sizeof(bracket_node) * (X.nblocks + pieces));
+    if (b == NULL) return -1;
+
+    memcpy(b, X.blocks, sizeof(bracket_node) * first);
+    int n = first;
+    for (int p = 0; p < pieces; p++) {
+        b[n] = X.blocks[first];
+        b[n].rows = p < pieces - 1 ? BRACKET_BLOCK : rows - (pieces - 1) * BRACKET_BLOCK;
+        b[n].stale = 1;
+        if (b[n].rows > 0) n++;
+    }
+    for (int i = first + 1; i <= last; i++) {
+        if (X.blocks[i].rows > 0) b[n++] = X.blocks[i];
+    }
+    memcpy(&b[n], &X.blocks[last + 1], sizeof(bracket_node) * (X.nblocks - last - 1));
+    n += X.nblocks - last - 1;
+
+    editor_free(MEM_INDEX, X.blocks);
+    X.blocks = b;
+    X.nblocks = n;
+    if (n == 0) return -1;
+
+    /* Block numbers moved: list the stale ones again */
+    X.nstale = 0;
+    for (int i = 0; i < n; i++) {
+        if (X.blocks[i].stale) {
+            X.blocks[i].stale = 0;
+            if (mark_stale(i) == -1) return -1;
+        }
+    }
+    return tree_rebuild();
+}
+
+void brackets_rows_replaced(int at, int count, int n) {
+    if (!X.built) return;
+    if (X.nblocks == 0) {
+        brackets_free();
+        return;
+    }
+    int start, i = block_at(at, &start);
+    int first = i, off = at - start, left = count;
+
+    /* Take the old rows out of the blocks that held them, and put the
+     * new ones in the first */
+    for (;;) {
+        int take = X.blocks[i].rows - off < left ? X.blocks[i].rows - off : left;
+        X.blocks[i].rows -= take;
+        left -= take;
+        off = 0;
+        if (left == 0 || i == X.nblocks - 1) break;
+        i++;
+    }
+    X.blocks[first].rows += n;
+
+    int reshaping = X.blocks[first].rows > 2 * BRACKET_BLOCK;
+    for (int j = first; j <= i; j++) {
+        if (X.blocks[j].rows == 0) reshaping = 1;
+        if (mark_stale(j) == -1) {
+            brackets_free();
+            return;
+        }
+    }
+    if (reshaping) {
+        if (reshape(first, i) == -1) brackets_free();
+        return;
+    }
+    for (int j = first; j <= i; j++) tree_update(j);
+}
+
+/* Walk row y from x in direction dir with depth brackets of kind k
+ * still unmatched; returns the column where the depth reaches 0, or -1
+ * with *depth updated for the rest of the row */
+static int scan_row(int k, int dir, int *depth, int y, int x) {
+    const erow *r = &E.row[y];
+    if (dir < 0 && x >= r->size) x = r->size - 1;
+    for (; x >= 0 && x < r->size; x += dir) {
+        int kind, v = bracket_step(r->chars[x], &kind);
+        if (v == 0 || kind != k) continue;
+        *depth += v * dir;
+        if (*depth == 0) return x;
+    }
+    return -1;
+}
+
+/* First block in [from, ...) (dir 1) or last in (..., from] (dir -1)
+ * where depth can return to 0, adding the blocks walked over to *depth */
+static int tree_find(int n, int lo, int hi, int from, int k, int dir, int *depth) {
+    if (dir > 0 ? hi <= from : lo > from) return -1;
+    const depth_sum *d = &X.tree[n].d[k];
+    if (dir > 0 ? lo >= from : hi - 1 <= from) {
+        if (dir > 0 ? *depth + d->low > 0 : d->high < *depth) {
+            *depth += dir * d->net;
+            return -1;
+        }
+        if (hi - lo == 1) return lo;
+    }
+    int mid = (lo + hi) / 2;
+    int first = dir > 0 ? 2 * n : 2 * n + 1, second = dir > 0 ? 2 * n + 1 : 2 * n;
+    int r = tree_find(first, dir > 0 ? lo : mid, dir > 0 ? mid : hi, from, k, dir, depth);
+    if (r >= 0) return r;
+    return tree_find(second, dir > 0 ? mid : lo, dir > 0 ? hi : mid, from, k, dir, depth);
+}
+
+/* The bracket of kind k where depth unmatched brackets, counted from
+ * (y, x) on in direction dir, are all matched */
+static int bracket_find(int k, int dir, int depth, int y, int x, int *py, int *px) {
+    if (brackets_ready() == -1) return -1;
+    int start, i = block_at(y, &start);
+    int end = start + X.blocks[i].rows;
+
+    /* The rest of the starting block */
+    for (;;) {
+        int mx = scan_row(k, dir, &depth, y, x);
+        if (mx >= 0) {
+            *py = y;
+            *px = mx;
+            return 0;
+        }
+        y += dir;
+        if (y < start || y >= end) break;
+        x = dir > 0 ? 0 : E.row[y].size - 1;
+    }
+
+    /* The block where it ends, then its rows */
+    i = tree_find(1, 0, X.leaves, i + dir, k, dir, &depth);
+    if (i < 0) return -1;
+    start = block_start(i);
+    end = start + X.blocks[i].rows;
+    for (y = dir > 0 ? start : end - 1; y >= start && y < end; y += dir) {
+        int mx = scan_row(k, dir, &depth, y, dir > 0 ? 0 : E.row[y].size - 1);
+        if (mx >= 0) {
+            *py = y;
+            *px = mx;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int bracket_match(int y, int x, int *my, int *mx) {
+    if (y < 0 || y >= E.numrows || x < 0 || x >= E.row[y].size) return -1;
+    int k, v = bracket_step(E.row[y].chars[x], &k);
+    if (v == 0) return -1;
+    /* An open bracket's match is forwards, a close bracket's backwards */
+    return bracket_find(k, v, 1, y, x + v, my, mx);
+}
+
+int bracket_enclosing(char open, int y, int x, int *oy, int *ox) {
+    int k;
+    if (bracket_step(open, &k) != 1 || y >= E.numrows) return -1;
+    const erow *r = &E.row[y];
+    if (x >= r->size) x = r->size - 1;
+
+    /* A bracket under the cursor belongs to the pair it opens or closes */
+    if (x >= 0 && r->chars[x] == open) {
+        *oy = y;
+        *ox = x;
+        return 0;
+    }
+    /* Walking back, the first open bracket left unmatched */
+    return bracket_find(k, -1, 1, y, x - 1, oy, ox);
+}
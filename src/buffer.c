@@ -0,0 +1,1038 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Row storage, character editing, selection, yank and put.
+ */
+
+#include "abczed.h"
+#include "clipboard.h"
+#include "stats.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef HAVE_STRDUP
+char *strdup(const char *s) {
+    size_t len = strlen(s) + 1;
+    char *new = malloc(len);
+    if (new == NULL) return NULL;
+    return (char *)memcpy(new, s, len);
+}
+#endif
+
+/* Row text lives in reference-counted blocks so registers can hold on to
+ * pieces of it without copying. A block is only written while its count
+ * is 1; row_text_reserve() copies a shared block first. */
+typedef struct row_block {
+    unsigned refs;
+    char chars[];
+} row_block;
+
+static row_block *block_of(char *chars) {
+    return (row_block *)(chars - offsetof(row_block, chars));
+}
+
+/* New unshared block for len bytes, terminated but otherwise unset */
+char *row_text_alloc(size_t len) {
+    row_block *b = editor_malloc(MEM_ROW_TEXT, sizeof(row_block) + len + 1);
+    if (b == NULL) return NULL;
+    b->refs = 1;
+    b->chars[len] = '\0';
+    return b->chars;
+}
+
+/* New unshared block holding s[0..len) plus a terminator */
+char *row_text_new(const char *s, size_t len) {
+    char *chars = row_text_alloc(len);
+    if (chars == NULL) return NULL;
+    memcpy(chars, s, len);
+    return chars;
+}
+
+char *row_text_ref(char *chars) {
+    block_of(chars)->refs++;
+    return chars;
+}
+
+void row_text_unref(char *chars) {
+    if (chars == NULL) return;
+    row_block *b = block_of(chars);
+    if (--b->refs == 0) editor_free(MEM_ROW_TEXT, b);
+}
+
+/* Make the row's text writable and at least size bytes long (terminator
+ * included); returns -1 on allocation failure */
+int row_text_reserve(erow *row, size_t size) {
+    row_block *b = block_of(row->chars);
+    if (row >= E.row && row < E.row + E.numrows) editor_row_changed((int)(row - E.row));
+    if (b->refs > 1) {
+        /* Copy on write: the old block stays with its other owners */
+        size_t keep = (size_t)row->size + 1 < size ? (size_t)row->size + 1 : size;
+        row_block *copy = editor_malloc(MEM_ROW_TEXT, sizeof(row_block) + size);
+        if (copy == NULL) return -1;
+        copy->refs = 1;
+        memcpy(copy->chars, row->chars, keep);
+        b->refs--;
+        row->chars = copy->chars;
+        return 0;
+    }
+    b = editor_realloc(MEM_ROW_TEXT, b, sizeof(row_block) + size);
+    if (b == NULL) return -1;
+    row->chars = b->chars;
+    return 0;
+}
+
+/* Row y's text is about to change or just changed in place: drop what
+ * the indexes over it know about the line */
+void editor_row_changed(int y) {
+    brackets_row_changed(y);
+    csv_row_changed(y);
+    diff_row_changed(y);
+}
+
+/* Anchor of the selection's fixed end, -1 when none */
+static int sel_anchor = -1;
+
+static void selection_track(void) {
+    if (sel_anchor >= 0 && anchor_set(sel_anchor, E.sel_start_y, E.sel_start_x) == 0) return;
+    sel_anchor = anchor_new(E.sel_start_y, E.sel_start_x);
+}
+
+/* Rows [at, at+count) became n rows: update the indexes and positions
+ * that hang off row numbers */
+static void rows_replaced(int at, int count, int n) {
+    brackets_rows_replaced(at, count, n);
+    folds_rows_replaced(at, count, n);
+    anchors_rows_replaced(at, count, n);
+    csv_rows_replaced(at, count, n);
+    diff_rows_replaced(at, count, n);
+    cursors_rows_replaced(at, count, n);
+    if (E.selecting && count != n) anchor_get(sel_anchor, &E.sel_start_y, &E.sel_start_x);
+}
+
+/* Insert a row at the specified position */
+void editor_insert_row(int at, char *s, size_t len) {
+    if (at < 0 || at > E.numrows) return;
+    
+    /* Allocate memory for new row */
+    erow *new_rows = editor_realloc(MEM_ROW_ARRAY, E.row, sizeof(erow) * (E.numrows + 1));
+    if (new_rows == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    E.row = new_rows;
+    
+    /* Move existing rows */
+    if (at < E.numrows) {
+        stats_row_move(&E.row[at + 1], &E.row[at], sizeof(erow) * (E.numrows - at));
+    }
+    
+    /* Allocate and initialize new row */
+    E.row[at].chars = row_text_new(s, len);
+    if (E.row[at].chars == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    E.row[at].size = len;
+    E.numrows++;
+    E.dirty++;
+    rows_replaced(at, 0, 1);
+    
+    /* Update status message */
+    editor_set_status("Line inserted at position %d", at + 1);
+    
+    /* Add to undo stack */
+    push_operation(&E.undo_stack, OP_INSERT_LINE, 0, at, 0, s, len);
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+/* Append a row while loading a file, with no undo record, status or
+ * index update; *cap is the length allocated for E.row, which doubles
+ * as it fills. Returns -1 on allocation failure. */
+int editor_load_row(const char *s, size_t len, int *cap) {
+    if (E.numrows == *cap) {
+        int n = *cap > 0 ? *cap * 2 : 1024;
+        erow *rows = editor_realloc(MEM_ROW_ARRAY, E.row, sizeof(erow) * n);
+        if (rows == NULL) return -1;
+        E.row = rows;
+        *cap = n;
+    }
+    char *chars = row_text_new(s, len);
+    if (chars == NULL) return -1;
+    E.row[E.numrows].chars = chars;
+    E.row[E.numrows].size = len;
+    E.numrows++;
+    return 0;
+}
+
+/* Rows [at, E.numrows) were loaded: trim E.row to size and update the
+ * indexes once for all of them */
+void editor_rows_loaded(int at) {
+    if (E.numrows > 0) {
+        erow *rows = editor_realloc(MEM_ROW_ARRAY, E.row, sizeof(erow) * E.numrows);
+        if (rows != NULL) E.row = rows;
+    }
+    if (E.numrows > at) rows_replaced(at, 0, E.numrows - at);
+}
+
+/* Free row memory */
+void editor_free_row(erow *row) {
+    row_text_unref(row->chars);
+}
+
+/* Delete a row */
+void editor_del_row(int at) {
+    if (at < 0 || at >= E.numrows) return;
+    
+    /* Add to undo stack before deleting */
+    push_operation(&E.undo_stack, OP_DELETE_LINE, 0, at, 0, E.row[at].chars, E.row[at].size);
+    
+    editor_free_row(&E.row[at]);
+    stats_row_move(&E.row[at], &E.row[at + 1], sizeof(erow) * (E.numrows - at - 1));
+    E.numrows--;
+    E.dirty++;
+    rows_replaced(at, 1, 0);
+    
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+/* Replace rows [at, at+count) with the *nrows rows in *rows, handing the
+ * replaced rows back in *rows and *nrows. The row arrays are MEM_UNDO;
+ * no text is copied. */
+int editor_swap_rows(int at, int count, erow **rows, int *nrows) {
+    int n = *nrows;
+    if (at < 0 || count < 0 || at + count > E.numrows) return -1;
+    
+    erow *out = editor_malloc(MEM_UNDO, sizeof(erow) * (count > 0 ? count : 1));
+    if (out == NULL) return -1;
+    if (n > count) {
+        erow *new_rows = editor_realloc(MEM_ROW_ARRAY, E.row, sizeof(erow) * (E.numrows + n - count));
+        if (new_rows == NULL) {
+            editor_free(MEM_UNDO, out);
+            return -1;
+        }
+        E.row = new_rows;
+    }
+    
+    memcpy(out, &E.row[at], sizeof(erow) * count);
+    if (n != count) {
+        stats_row_move(&E.row[at + n], &E.row[at + count], sizeof(erow) * (E.numrows - at - count));
+    }
+    memcpy(&E.row[at], *rows, sizeof(erow) * n);
+    E.numrows += n - count;
+    E.dirty++;
+    rows_replaced(at, count, n);
+    
+    editor_free(MEM_UNDO, *rows);
+    *rows = out;
+    *nrows = count;
+    return 0;
+}
+
+/* Convert row and column to file position */
+int editor_row_cx_to_rx(erow *row, int cx) {
+    int rx = 0;
+    int j;
+    for (j = 0; j < cx; j++) {
+        if (row->chars[j] == '\t')
+            rx += (8 - 1) - (rx % 8);
+        rx++;
+    }
+    return rx;
+}
+
+/* Byte of the row whose cell covers display column rx, or the row's
+ * length past its end */
+int editor_row_rx_to_cx(erow *row, int rx) {
+    int cur = 0;
+    for (int cx = 0; cx < row->size; cx++) {
+        if (row->chars[cx] == '\t')
+            cur += (8 - 1) - (cur % 8);
+        cur++;
+        if (cur > rx) return cx;
+    }
+    return row->size;
+}
+
+/* Insert character at current position */
+void editor_insert_char(int c) {
+    if (E.cy == E.numrows) {
+        editor_insert_row(E.numrows, "", 0);
+    }
+    erow *row = &E.row[E.cy];
+    
+    /* Add to undo stack */
+    push_operation(&E.undo_stack, OP_INSERT_CHAR, E.cx, E.cy, c, NULL, 0);
+    
+    if (row_text_reserve(row, row->size + 2) == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    stats_char_move(&row->chars[E.cx + 1], &row->chars[E.cx], row->size - E.cx + 1);
+    row->size++;
+    row->chars[E.cx] = c;
+    E.cx++;
+    E.dirty++;
+    
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+/* Insert newline */
+void editor_insert_newline() {
+    /* Add to undo stack - we need to handle this before modifying anything */
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+    
+    /* Handle case where there are no rows yet */
+    if (E.numrows == 0) {
+        /* Create a new empty row */
+        editor_insert_row(0, "", 0);
+        /* Add to undo stack */
+        push_operation(&E.undo_stack, OP_NEWLINE, 0, 0, '\n', NULL, 0);
+        E.cy = 0;
+        E.cx = 0;
+        E.dirty++;
+        return;
+    }
+    
+    /* Save the current row content for undo */
+    char *line_copy = NULL;
+    int line_size = 0;
+    
+    if (E.cx < E.row[E.cy].size) {
+        line_size = E.row[E.cy].size - E.cx;
+        line_copy = editor_malloc(MEM_UNDO, line_size + 1);
+        if (line_copy) {
+            memcpy(line_copy, &E.row[E.cy].chars[E.cx], line_size);
+            line_copy[line_size] = '\0';
+        }
+    }
+    
+    /* Insert the new row */
+    if (E.cx == 0) {
+        editor_insert_row(E.cy, "", 0);
+    } else {
+        erow *row = &E.row[E.cy];
+        editor_insert_row(E.cy + 1, &row->chars[E.cx], row->size - E.cx);
+        row = &E.row[E.cy]; /* Re-get the pointer as it might have changed */
+        if (row_text_reserve(row, E.cx + 1) == 0) {
+            row->size = E.cx;
+            row->chars[row->size] = '\0';
+        }
+    }
+    
+    /* Add to undo stack */
+    push_operation(&E.undo_stack, OP_NEWLINE, E.cx, E.cy, '\n', line_copy, line_size);
+    
+    /* Update cursor position */
+    E.cy++;
+    E.cx = 0;
+    E.dirty++;
+    
+    /* Free the line copy if it was allocated */
+    if (line_copy) {
+        editor_free(MEM_UNDO, line_copy);
+    }
+}
+
+/* Delete character at cursor */
+void editor_del_char() {
+    if (E.cy == E.numrows) return;
+    if (E.cx == 0 && E.cy == 0) return;
+
+    erow *row = &E.row[E.cy];
+    if (E.cx > 0) {
+        if (row_text_reserve(row, row->size + 1) == -1) {
+            editor_set_status("Memory allocation failed");
+            return;
+        }
+        /* Add to undo stack */
+        push_operation(&E.undo_stack, OP_DELETE_CHAR, E.cx - 1, E.cy, row->chars[E.cx - 1], NULL, 0);
+        
+        stats_char_move(&row->chars[E.cx - 1], &row->chars[E.cx], row->size - E.cx + 1);
+        E.cx--;
+        row->size--;
+        E.dirty++;
+    } else {
+        /* Join with the previous line: append this row to it, then delete
+         * this row (editor_del_row() records the deleted text for undo) */
+        erow *prev = &E.row[E.cy - 1];
+        if (row_text_reserve(prev, prev->size + row->size + 1) == -1) {
+            editor_set_status("Memory allocation failed");
+            return;
+        }
+        memcpy(&prev->chars[prev->size], row->chars, row->size);
+        E.cx = prev->size;
+        prev->size += row->size;
+        prev->chars[prev->size] = '\0';
+        editor_del_row(E.cy);
+        E.cy--;
+    }
+    
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+/* Delete character under cursor (normal mode 'x') */
+void editor_del_char_forward() {
+    if (E.cy >= E.numrows) return;
+
+    erow *row = &E.row[E.cy];
+    if (E.cx >= row->size) return;
+    if (row_text_reserve(row, row->size + 1) == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+
+    /* Add to undo stack */
+    push_operation(&E.undo_stack, OP_DELETE_CHAR, E.cx, E.cy, row->chars[E.cx], NULL, 0);
+
+    stats_char_move(&row->chars[E.cx], &row->chars[E.cx + 1], row->size - E.cx);
+    row->size--;
+    E.dirty++;
+
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+/* Replace rows [at, at+count) with rows[0..n), freeing the old rows;
+ * the caller has saved them for undo. Takes over rows. */
+static int replace_rows(int at, int count, erow *rows, int n) {
+    if (editor_swap_rows(at, count, &rows, &n) == -1) return -1;
+    for (int i = 0; i < n; i++) editor_free_row(&rows[i]);
+    editor_free(MEM_UNDO, rows);
+    return 0;
+}
+
+/* Growable line for building rows */
+typedef struct line_buf {
+    char *b;
+    int len, cap;
+} line_buf;
+
+static int line_add(line_buf *l, const char *s, int len) {
+    if (len == 0) return 0;
+    if (l->len + len > l->cap) {
+        int cap = l->cap ? l->cap : 64;
+        while (cap < l->len + len) cap *= 2;
+        char *b = editor_realloc(MEM_MISC, l->b, cap);
+        if (b == NULL) return -1;
+        l->b = b;
+        l->cap = cap;
+    }
+    memcpy(l->b + l->len, s, len);
+    l->len += len;
+    return 0;
+}
+
+/* Build the rows for splice_text() when s holds line breaks: the text
+ * before the range, the copies, then the text after it, split at each
+ * line break. Returns 0 if out of memory; rows[0..*n) are built. */
+static int splice_lines(erow *rows, int *n, int y0, int x0, int y1, int x1, int count,
+                        const char *s, size_t len, long times, int *end_cx) {
+    line_buf line = { NULL, 0, 0 };
+    int ok = 1;
+    if (count) ok = line_add(&line, E.row[y0].chars, x0) == 0;
+    for (long t = 0; ok && t < times; t++) {
+        size_t start = 0;
+        for (size_t i = 0; ok && i <= len; i++) {
+            if (i < len && s[i] != '\n') continue;
+            ok = line_add(&line, s + start, (int)(i - start)) == 0;
+            if (ok && i < len) {
+                rows[*n].chars = row_text_new(line.b ? line.b : "", line.len);
+                rows[*n].size = line.len;
+                ok = rows[*n].chars != NULL;
+                *n += ok;
+                line.len = 0;
+            }
+            start = i + 1;
+        }
+    }
+    *end_cx = line.len;
+    if (ok && count) ok = line_add(&line, E.row[y1].chars + x1, E.row[y1].size - x1) == 0;
+    if (ok) {
+        rows[*n].chars = row_text_new(line.b ? line.b : "", line.len);
+        rows[*n].size = line.len;
+        ok = rows[*n].chars != NULL;
+        *n += ok;
+    }
+    editor_free(MEM_MISC, line.b);
+    return ok;
+}
+
+/* Replace (y0, x0) up to (y1, x1) with times copies of s (which may hold
+ * line breaks), as one undo step: the rows are rebuilt once and swapped
+ * in. The cursor ends after the new text. */
+static void splice_text(int y0, int x0, int y1, int x1, const char *s, size_t len, long times) {
+    int at = y0 < E.numrows ? y0 : E.numrows;
+    int count = y0 < E.numrows ? y1 - y0 + 1 : 0;
+    if (count) {
+        if (x0 > E.row[y0].size) x0 = E.row[y0].size;
+        if (x1 > E.row[y1].size) x1 = E.row[y1].size;
+    } else {
+        x0 = x1 = 0;
+    }
+    
+    int breaks = 0;
+    for (size_t i = 0; i < len; i++) breaks += s[i] == '\n';
+    long nrows = (long)breaks * times + 1;
+    if (nrows > INT_MAX / 2 || (long)len * times > INT_MAX) {
+        editor_set_status("Error: Too much text");
+        return;
+    }
+    
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow) * nrows);
+    if (rows == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    
+    int n = 0, ok = 1, end_cx;
+    if (breaks == 0) {
+        /* One row: build it straight into its text block */
+        int tail = count ? E.row[y1].size - x1 : 0;
+        end_cx = x0 + (int)(len * times);
+        char *text = row_text_alloc(end_cx + tail);
+        ok = text != NULL;
+        if (ok) {
+            if (count) memcpy(text, E.row[y0].chars, x0);
+            for (long t = 0; t < times; t++) memcpy(text + x0 + t * len, s, len);
+            if (count) memcpy(text + end_cx, E.row[y1].chars + x1, tail);
+            rows[0].chars = text;
+            rows[0].size = end_cx + tail;
+            n = 1;
+        }
+    } else {
+        ok = splice_lines(rows, &n, y0, x0, y1, x1, count, s, len, times, &end_cx);
+    }
+    
+    if (ok) {
+        E.cx = x0;
+        ok = undo_begin_rows(at, count) == 0;
+    }
+    if (!ok || replace_rows(at, count, rows, n) == -1) {
+        for (int i = 0; i < n; i++) editor_free_row(&rows[i]);
+        editor_free(MEM_UNDO, rows);
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    undo_end_rows(n);
+    
+    E.cy = at + n - 1;
+    E.cx = end_cx;
+}
+
+/* Insert s times times at the cursor, as one undo step */
+void editor_insert_text(const char *s, size_t len, long times) {
+    if (len == 0 || times < 1) return;
+    splice_text(E.cy, E.cx, E.cy, E.cx, s, len, times);
+}
+
+/* Replace (y0, x0) up to (y1, x1) with s, as one undo step */
+void editor_replace_range(int y0, int x0, int y1, int x1, const char *s, size_t len) {
+    if (y0 < 0 || y1 >= E.numrows || y1 < y0) return;
+    splice_text(y0, x0, y1, x1, s, len, 1);
+}
+
+/* Yank count whole lines from at, to be put back as lines */
+int editor_yank_lines(int at, int count) {
+    if (at < 0 || count < 1 || at + count > E.numrows) return -1;
+    return register_yank_lines(at, at + count - 1);
+}
+
+/* Delete n lines from the cursor's, yanking them, as one undo step */
+void editor_delete_lines(long n) {
+    if (E.cy >= E.numrows || n < 1) return;
+    int at = E.cy;
+    int count = n < E.numrows - at ? (int)n : E.numrows - at;
+    
+    if (editor_yank_lines(at, count) == -1 || undo_begin_rows(at, count) == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    
+    /* Deleting every line leaves one empty line */
+    int keep = (count == E.numrows) ? 1 : 0;
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow));
+    if (rows == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    if (keep) {
+        rows[0].chars = row_text_new("", 0);
+        rows[0].size = 0;
+        if (rows[0].chars == NULL) keep = 0;
+    }
+    if (replace_rows(at, count, rows, keep) == -1) {
+        if (keep) editor_free_row(&rows[0]);
+        editor_free(MEM_UNDO, rows);
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    undo_end_rows(keep);
+    
+    if (E.cy >= E.numrows) E.cy = E.numrows > 0 ? E.numrows - 1 : 0;
+    E.cx = 0;
+    editor_set_status("%d fewer lines", count);
+}
+
+/* Delete from (y0, x0) up to (y1, x1), joining the two rows, as one
+ * undo step; the cursor ends at the start */
+void editor_delete_range(int y0, int x0, int y1, int x1) {
+    if (y0 == y1 && x1 <= x0) return;
+    editor_replace_range(y0, x0, y1, x1, "", 0);
+}
+
+/* Start selection at current cursor position */
+void editor_selection_start() {
+    E.sel_start_x = E.cx;
+    E.sel_start_y = E.cy;
+    E.sel_end_x = E.cx;
+    E.sel_end_y = E.cy;
+    E.selecting = 1;
+    selection_track();
+}
+
+/* Update selection end point to current cursor position */
+void editor_selection_update() {
+    if (E.selecting) {
+        E.sel_end_x = E.cx;
+        E.sel_end_y = E.cy;
+    }
+}
+
+/* Clear selection */
+void editor_selection_clear() {
+    E.sel_start_x = -1;
+    E.sel_start_y = -1;
+    E.sel_end_x = -1;
+    E.sel_end_y = -1;
+    E.selecting = 0;
+    E.sel_block = 0;
+    anchor_free(sel_anchor);
+    sel_anchor = -1;
+}
+
+/* Normalize selection (ensure start comes before end) */
+void editor_selection_normalize() {
+    /* Swap if end is before start */
+    if (E.sel_end_y < E.sel_start_y || 
+        (E.sel_end_y == E.sel_start_y && E.sel_end_x < E.sel_start_x)) {
+        int temp_x = E.sel_start_x;
+        int temp_y = E.sel_start_y;
+        E.sel_start_x = E.sel_end_x;
+        E.sel_start_y = E.sel_end_y;
+        E.sel_end_x = temp_x;
+        E.sel_end_y = temp_y;
+        if (E.selecting) selection_track();
+    }
+}
+
+/* Display columns [*rx0, *rx1) of the cell at byte x of row y */
+static void cell_columns(int y, int x, int *rx0, int *rx1) {
+    if (y < 0 || y >= E.numrows) {
+        *rx0 = x;
+        *rx1 = x + 1;
+        return;
+    }
+    erow *row = &E.row[y];
+    int cx = x < row->size ? x : row->size;
+    *rx0 = editor_row_cx_to_rx(row, cx) + (x - cx);
+    *rx1 = x < row->size ? editor_row_cx_to_rx(row, x + 1) : *rx0 + 1;
+}
+
+/* Rows and display columns [x0, x1) covered by the block selection, so
+ * tabs do not shift it */
+static void block_bounds(int *y0, int *y1, int *x0, int *x1) {
+    int a0, a1, b0, b1;
+    cell_columns(E.sel_start_y, E.sel_start_x, &a0, &a1);
+    cell_columns(E.sel_end_y, E.sel_end_x, &b0, &b1);
+    *y0 = E.sel_start_y < E.sel_end_y ? E.sel_start_y : E.sel_end_y;
+    *y1 = E.sel_start_y < E.sel_end_y ? E.sel_end_y : E.sel_start_y;
+    *x0 = a0 < b0 ? a0 : b0;
+    *x1 = a1 > b1 ? a1 : b1;
+    if (*y1 >= E.numrows) *y1 = E.numrows - 1;
+}
+
+/* Bytes [*x0, *x1) of row y in display columns [rx0, rx1); a tab
+ * partly inside is taken whole */
+static void block_row_span(int y, int rx0, int rx1, int *x0, int *x1) {
+    erow *row = &E.row[y];
+    *x0 = editor_row_rx_to_cx(row, rx0);
+    *x1 = rx1 > rx0 ? editor_row_rx_to_cx(row, rx1 - 1) + 1 : *x0;
+    if (*x1 > row->size) *x1 = row->size;
+    if (*x1 < *x0) *x1 = *x0;
+}
+
+/* Replace display columns [from, to) of every block row with s, in one
+ * pass and one undo step. Rows shorter than from are skipped, or padded
+ * with spaces up to it when pad is set. */
+static void block_splice(int from, int to, const char *s, int len, int pad) {
+    int y0, y1, x0, x1;
+    block_bounds(&y0, &y1, &x0, &x1);
+    if (y1 < y0) return;
+    
+    E.cy = y0;
+    if (undo_begin_rows(y0, y1 - y0 + 1) == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    
+    int changed = 0;
+    for (int y = y0; y <= y1; y++) {
+        erow *row = &E.row[y];
+        int size = row->size;
+        int width = editor_row_cx_to_rx(row, size);
+        if (width < from && !pad) continue;
+        
+        int fill = width < from ? from - width : 0;
+        int at = size + fill, end = size;
+        if (!fill) block_row_span(y, from, to, &at, &end);
+        int cut = end - at;
+        if (fill == 0 && cut == 0 && len == 0) continue;
+        
+        /* Room for the old text too, which a shrinking edit still moves */
+        int new_size = size + fill - cut + len;
+        if (row_text_reserve(row, (new_size > size ? new_size : size) + 1) == -1) {
+            editor_set_status("Memory allocation failed");
+            break;
+        }
+        if (fill) {
+            memset(&row->chars[size], ' ', fill);
+        } else {
+            stats_char_move(&row->chars[at + len], &row->chars[end], size - end);
+        }
+        memcpy(&row->chars[at], s, len);
+        row->size = new_size;
+        row->chars[new_size] = '\0';
+        changed++;
+    }
+    undo_end_rows(y1 - y0 + 1);
+    
+    E.cx = editor_row_rx_to_cx(&E.row[E.cy], x0);
+    E.dirty++;
+    editor_set_status("Block: %d lines changed", changed);
+}
+
+/* Insert s before the block, or after it (padding short rows) */
+void editor_block_insert(const char *s, int len, int append) {
+    int y0, y1, x0, x1;
+    block_bounds(&y0, &y1, &x0, &x1);
+    if (append) {
+        block_splice(x1, x1, s, len, 1);
+    } else {
+        block_splice(x0, x0, s, len, 0);
+    }
+}
+
+/* Replace the block's text with s on every row, yanking it first */
+void editor_block_change(const char *s, int len) {
+    int y0, y1, x0, x1;
+    editor_copy_selection();
+    block_bounds(&y0, &y1, &x0, &x1);
+    block_splice(x0, x1, s, len, 0);
+}
+
+/* Overwrite every character in the block with c */
+void editor_block_replace(int c) {
+    int y0, y1, x0, x1;
+    block_bounds(&y0, &y1, &x0, &x1);
+    if (y1 < y0) return;
+    
+    E.cy = y0;
+    if (undo_begin_rows(y0, y1 - y0 + 1) == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    for (int y = y0; y <= y1; y++) {
+        erow *row = &E.row[y];
+        int start, end;
+        block_row_span(y, x0, x1, &start, &end);
+        if (end <= start) continue;
+        if (row_text_reserve(row, row->size + 1) == -1) {
+            editor_set_status("Memory allocation failed");
+            break;
+        }
+        memset(&row->chars[start], c, end - start);
+    }
+    undo_end_rows(y1 - y0 + 1);
+    
+    E.cx = editor_row_rx_to_cx(&E.row[E.cy], x0);
+    E.dirty++;
+}
+
+/* Yank the selection into the selected register (unnamed by default).
+ * The register shares the rows' text; nothing is copied. */
+void editor_copy_selection() {
+    /* Check if selection exists */
+    if (E.sel_start_x == -1 || E.sel_start_y == -1 || 
+        E.sel_end_x == -1 || E.sel_end_y == -1) {
+        editor_set_status("No selection to copy");
+        return;
+    }
+    
+    if (E.sel_block) {
+        int y0, y1, x0, x1;
+        block_bounds(&y0, &y1, &x0, &x1);
+        if (register_yank_block(y0, y1, x0, x1) == -1) {
+            editor_set_status("Error: Out of memory");
+            return;
+        }
+        editor_set_status("Copied %dx%d block", y1 - y0 + 1, x1 - x0);
+        clipboard_export(register_get('"'));
+        return;
+    }
+    
+    /* Normalize selection */
+    editor_selection_normalize();
+    
+    int end_y = E.sel_end_y < E.numrows ? E.sel_end_y : E.numrows - 1;
+    if (register_yank(E.sel_start_y, E.sel_start_x, end_y, E.sel_end_x) == -1) {
+        editor_set_status("Error: Out of memory");
+        return;
+    }
+    
+    editor_set_status("Copied %d lines", end_y - E.sel_start_y + 1);
+    clipboard_export(register_get('"'));
+}
+
+/* Put the selected register (unnamed by default) at the cursor */
+void editor_paste() {
+    editor_put(1, 0);
+}
+
+/* Put a block times times at the cursor's display column, one piece
+ * per row from the cursor's down, as one undo step. Short rows are
+ * padded out to the column, pieces to the block's width when text
+ * follows, and rows are added past the end. */
+static void put_block(const yank_text *t, long times) {
+    int at = E.cy < E.numrows ? E.cy : E.numrows;
+    int n = t->count;
+    int count = E.numrows - at < n ? E.numrows - at : n;
+    int col = at < E.numrows ? editor_row_cx_to_rx(&E.row[at], E.cx) : 0;
+    if ((long)(t->bytes + (size_t)n * t->width) * times > INT_MAX / 2) {
+        editor_set_status("Error: Too much text");
+        return;
+    }
+    
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow) * n);
+    if (rows == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    int built = 0;
+    for (; built < n; built++) {
+        const yank_piece *p = &t->pieces[built];
+        const char *old = built < count ? E.row[at + built].chars : "";
+        int size = built < count ? E.row[at + built].size : 0;
+        int width = built < count ? editor_row_cx_to_rx(&E.row[at + built], size) : 0;
+        int fill = width < col ? col - width : 0;
+        int x = fill || built >= count ? size : editor_row_rx_to_cx(&E.row[at + built], col);
+        int pad = t->width > p->len ? t->width - p->len : 0;
+        
+        /* Pad every copy but a last one with nothing after it */
+        long piece = p->len + pad;
+        long len = size + fill + piece * times - (x == size ? pad : 0);
+        char *text = row_text_alloc(len);
+        if (text == NULL) break;
+        memcpy(text, old, x);
+        memset(text + x, ' ', fill);
+        char *d = text + x + fill;
+        for (long k = 0; k < times; k++) {
+            memcpy(d, p->text + p->start, p->len);
+            d += p->len;
+            if (k < times - 1 || x < size) {
+                memset(d, ' ', pad);
+                d += pad;
+            }
+        }
+        memcpy(d, old + x, size - x);
+        rows[built].chars = text;
+        rows[built].size = (int)len;
+    }
+    
+    int cx = E.cx;
+    if (built < n || undo_begin_rows(at, count) == -1 || replace_rows(at, count, rows, n) == -1) {
+        for (int i = 0; i < built; i++) editor_free_row(&rows[i]);
+        editor_free(MEM_UNDO, rows);
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    undo_end_rows(n);
+    E.cy = at;
+    E.cx = cx < E.row[at].size ? cx : E.row[at].size;
+}
+
+/* Put the selected register times times, as one undo step. Text goes
+ * in at the cursor and a block column-wise from it; lines go in below
+ * the cursor's line, or above it when before is set. */
+void editor_put(long times, int before) {
+    const yank_text *t = register_take();
+    if (t == NULL || t->count == 0) {
+        editor_set_status("Nothing to paste");
+        return;
+    }
+    if (t->kind == YANK_BLOCK) {
+        if (times >= 1) put_block(t, times);
+        editor_set_status("Pasted %dx%d block", t->count, t->width);
+        return;
+    }
+    
+    char *text = editor_malloc(MEM_MISC, t->bytes ? t->bytes : 1);
+    if (text == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    /* Below a closed fold means below its last line. Lines after the
+     * last row start with their break instead. */
+    int fold_end = before ? -1 : fold_closed_end(E.cy);
+    int at = (fold_end >= 0 ? fold_end : E.cy) + (before ? 0 : 1);
+    int lead = t->kind == YANK_LINES && at >= E.numrows;
+    size_t len = 0;
+    for (int i = 0; i < t->count; i++) {
+        const yank_piece *p = &t->pieces[i];
+        if (lead && p->eol) text[len++] = '\n';
+        memcpy(text + len, p->text + p->start, p->len);
+        len += p->len;
+        if (!lead && p->eol) text[len++] = '\n';
+    }
+    
+    if (t->kind != YANK_LINES) {
+        editor_insert_text(text, len, times);
+    } else if (times >= 1 && len > 0) {
+        if (lead) {
+            at = E.numrows > 0 ? E.numrows : 1;
+            int last = E.numrows > 0 ? E.numrows - 1 : 0;
+            int end = E.numrows > 0 ? E.row[last].size : 0;
+            splice_text(last, end, last, end, text, len, times);
+        } else {
+            splice_text(at, 0, at, 0, text, len, times);
+        }
+        if (at < E.numrows) E.cy = at;
+        E.cx = 0;
+    }
+    editor_free(MEM_MISC, text);
+    
+    editor_set_status("Pasted %d lines", t->lines);
+}
+
+/* Delete selected text, leaving the cursor at the start of the selection */
+void editor_delete_selection() {
+    editor_copy_selection();  /* Copy first for undo capability */
+    
+    if (E.sel_block) {
+        int y0, y1, x0, x1;
+        block_bounds(&y0, &y1, &x0, &x1);
+        block_splice(x0, x1, "", 0, 0);
+        return;
+    }
+    
+    /* One splice from start to end, so it undoes as one step */
+    editor_selection_normalize();
+    if (E.sel_start_y >= E.numrows) return;
+    int end_y = E.sel_end_y < E.numrows ? E.sel_end_y : E.numrows - 1;
+    editor_delete_range(E.sel_start_y, E.sel_start_x, end_y, E.sel_end_x);
+    E.cy = E.sel_start_y;
+    E.cx = E.sel_start_x < E.row[E.cy].size ? E.sel_start_x : E.row[E.cy].size;
+}
+
+/* Select all text */
+void editor_select_all() {
+    if (E.numrows > 0) {
+        E.sel_start_x = 0;
+        E.sel_start_y = 0;
+        E.sel_end_y = E.numrows - 1;
+        E.sel_end_x = E.row[E.numrows - 1].size;
+        E.selecting = 1;
+        selection_track();
+        editor_set_status("Selected all text");
+    }
+}
+
+/* Scroll the editor if cursor moves out of the visible window */
+void editor_scroll() {
+    if (hex_state()) {
+        hex_scroll();
+        return;
+    }
+    if (csv_delim()) {
+        csv_scroll();
+        return;
+    }
+
+    /* The cursor and the top line never rest inside a closed fold */
+    int line = fold_line(E.cy);
+    if (line != E.cy) {
+        E.cy = line;
+        if (E.cx > E.row[E.cy].size) E.cx = E.row[E.cy].size;
+    }
+    E.rowoff = fold_line(E.rowoff);
+
+    /* Vertical scrolling, in screen rows */
+    int vy = folds_visible(E.cy), top = folds_visible(E.rowoff);
+    if (vy < top) {
+        E.rowoff = E.cy;
+    }
+    if (vy >= top + E.screenrows) {
+        E.rowoff = folds_row(vy - E.screenrows + 1);
+    }
+
+    /* Horizontal scrolling, in the columns right of the diff gutter */
+    int width = E.screencols - diff_gutter_width();
+    if (E.cx < E.coloff) {
+        E.coloff = E.cx;
+    }
+    if (E.cx >= E.coloff + width) {
+        E.coloff = E.cx - width + 1;
+    }
+    
+    /* Ensure offsets are never negative */
+    if (E.rowoff < 0) E.rowoff = 0;
+    if (E.coloff < 0) E.coloff = 0;
+}
+
+/* Bytes [*x0, *x1) of row y inside the selection; returns 0 when the
+ * row has none. Cheap, so the renderer asks once per line. */
+int editor_selection_span(int y, int *x0, int *x1) {
+    if (!E.selecting || E.sel_start_x == -1) return 0;
+    
+    if (E.sel_block) {
+        int y0, y1, rx0, rx1;
+        block_bounds(&y0, &y1, &rx0, &rx1);
+        if (y < y0 || y > y1 || y >= E.numrows) return 0;
+        block_row_span(y, rx0, rx1, x0, x1);
+        return 1;
+    }
+    
+    /* Normalize selection */
+    int start_x, start_y, end_x, end_y;
+    if (E.sel_end_y < E.sel_start_y || 
+        (E.sel_end_y == E.sel_start_y && E.sel_end_x < E.sel_start_x)) {
+        start_x = E.sel_end_x;
+        start_y = E.sel_end_y;
+        end_x = E.sel_start_x;
+        end_y = E.sel_start_y;
+    } else {
+        start_x = E.sel_start_x;
+        start_y = E.sel_start_y;
+        end_x = E.sel_end_x;
+        end_y = E.sel_end_y;
+    }
+    
+    if (y < start_y || y > end_y) return 0;
+    *x0 = (y == start_y) ? start_x : 0;
+    *x1 = (y == end_y) ? end_x : INT_MAX;
+    return *x0 < *x1;
+}
+
+/* Check if position is within selection */
+int is_position_selected(int x, int y) {
+    int x0, x1;
+    return editor_selection_span(y, &x0, &x1) && x >= x0 && x < x1;
+}
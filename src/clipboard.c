@@ -0,0 +1,343 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * System clipboard export over OSC 52 or a helper command pipe.
+ */
+
+#include "abczed.h"
+#include "clipboard.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define OUT_CHUNK   4096                /* Bytes per write */
+#define IN_CHUNK    (OUT_CHUNK / 4 * 3) /* Text bytes that encode to one chunk */
+#define STEP_CHUNKS 16                  /* Most chunks written per step */
+#define REAP_WAIT_MS 100                /* Longest wait on exit for running helpers */
+
+static int tty_fd = -1;
+static enum clipboard_mode mode = CLIPBOARD_OSC52;
+static size_t max_bytes = CLIPBOARD_DEFAULT_MAX;
+static char *helper = NULL;
+
+/* The export in progress; text is NULL when idle */
+static struct {
+    yank_text *text;                /* Held reference */
+    int fd;                         /* tty or helper pipe */
+    int osc;                        /* Writing an OSC 52 sequence */
+    pid_t pid;                      /* Helper process, or 0 */
+    int piece, offset;              /* Next text byte; offset == len is the line break */
+    unsigned char carry[3];         /* Text bytes left over from the last base64 group */
+    int ncarry;
+    int text_done;                  /* All text encoded, suffix queued */
+    char out[OUT_CHUNK + 16];
+    size_t out_len, out_pos;
+} job;
+
+/* Helpers whose input is written but that were still running; reaped
+ * on later steps as they exit so they don't stay zombies */
+static pid_t *running_helpers;
+static int nrunning, running_cap;
+
+static const char b64[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+void clipboard_set_tty(int fd) {
+    tty_fd = fd;
+}
+
+void clipboard_set_mode(enum clipboard_mode m) {
+    mode = m;
+}
+
+enum clipboard_mode clipboard_get_mode(void) {
+    return mode;
+}
+
+void clipboard_set_max(size_t bytes) {
+    max_bytes = bytes;
+}
+
+size_t clipboard_get_max(void) {
+    return max_bytes;
+}
+
+int clipboard_set_helper(const char *command) {
+    char *copy = NULL;
+    if (command && *command) {
+        copy = editor_strdup(MEM_MISC, command);
+        if (copy == NULL) return -1;
+    }
+    editor_free(MEM_MISC, helper);
+    helper = copy;
+    return 0;
+}
+
+const char *clipboard_get_helper(void) {
+    return helper;
+}
+
+/* tmux swallows OSC 52 unless it is wrapped in a passthrough sequence */
+static int in_tmux(void) {
+    const char *tmux = getenv("TMUX");
+    return tmux && *tmux;
+}
+
+static const char *osc_prefix(void) {
+    return in_tmux() ? "\033Ptmux;\033\033]52;c;" : "\033]52;c;";
+}
+
+static const char *osc_suffix(void) {
+    return in_tmux() ? "\a\033\\" : "\a";
+}
+
+/* Copy up to cap bytes of the text, line breaks included */
+static size_t gather(char *dst, size_t cap) {
+    const yank_text *t = job.text;
+    size_t n = 0;
+
+    while (n < cap && job.piece < t->count) {
+        const yank_piece *p = &t->pieces[job.piece];
+        if (job.offset < p->len) {
+            size_t k = (size_t)(p->len - job.offset);
+            if (k > cap - n) k = cap - n;
+            memcpy(dst + n, p->text + p->start + job.offset, k);
+            n += k;
+            job.offset += (int)k;
+        } else if (p->eol && job.offset == p->len) {
+            dst[n++] = '\n';
+            job.offset++;
+        } else {
+            job.piece++;
+            job.offset = 0;
+        }
+    }
+    return n;
+}
+
+/* Encode len bytes, padding a final partial group */
+static size_t base64_encode(const unsigned char *in, size_t len, char *out) {
+    size_t o = 0, i = 0;
+    for (; i + 3 <= len; i += 3) {
+        unsigned v = (unsigned)in[i] << 16 | (unsigned)in[i + 1] << 8 | in[i + 2];
+        out[o++] = b64[v >> 18];
+        out[o++] = b64[(v >> 12) & 63];
+        out[o++] = b64[(v >> 6) & 63];
+        out[o++] = b64[v & 63];
+    }
+    if (i < len) {
+        unsigned v = (unsigned)in[i] << 16 | (i + 1 < len ? (unsigned)in[i + 1] << 8 : 0);
+        out[o++] = b64[v >> 18];
+        out[o++] = b64[(v >> 12) & 63];
+        out[o++] = i + 1 < len ? b64[(v >> 6) & 63] : '=';
+        out[o++] = '=';
+    }
+    return o;
+}
+
+/* Fill job.out with the next chunk */
+static void refill(void) {
+    job.out_pos = 0;
+    if (!job.osc) {
+        job.out_len = gather(job.out, OUT_CHUNK);
+        if (job.out_len == 0) job.text_done = 1;
+        return;
+    }
+
+    unsigned char in[IN_CHUNK];
+    memcpy(in, job.carry, job.ncarry);
+    size_t n = job.ncarry + gather((char *)in + job.ncarry, IN_CHUNK - job.ncarry);
+    size_t whole = n / 3 * 3;
+    if (n < IN_CHUNK) {
+        /* Out of text: encode the tail with padding and close the sequence */
+        whole = n;
+        job.text_done = 1;
+    }
+    job.out_len = base64_encode(in, whole, job.out);
+    job.ncarry = (int)(n - whole);
+    memcpy(job.carry, in + whole, job.ncarry);
+    if (job.text_done) {
+        const char *suffix = osc_suffix();
+        memcpy(job.out + job.out_len, suffix, strlen(suffix));
+        job.out_len += strlen(suffix);
+    }
+}
+
+/* Reap the running helpers that have exited since */
+static void reap_helpers(void) {
+    int n = 0;
+    for (int i = 0; i < nrunning; i++) {
+        pid_t r = waitpid(running_helpers[i], NULL, WNOHANG);
+        if (r == 0 || (r == -1 && errno == EINTR)) running_helpers[n++] = running_helpers[i];
+    }
+    nrunning = n;
+}
+
+/* Keep a helper that is still running to reap later; without room it
+ * is waited for now */
+static void reap_later(pid_t pid) {
+    if (nrunning == running_cap) {
+        int cap = running_cap ? running_cap * 2 : 4;
+        pid_t *p = editor_realloc(MEM_MISC, running_helpers, sizeof(pid_t) * cap);
+        if (p == NULL) {
+            waitpid(pid, NULL, 0);
+            return;
+        }
+        running_helpers = p;
+        running_cap = cap;
+    }
+    running_helpers[nrunning++] = pid;
+}
+
+/* End the export; cancel aborts an unfinished one */
+static void finish(int cancel) {
+    if (job.osc) {
+        /* CAN aborts the control string, so the terminal drops it */
+        if (cancel) {
+            ssize_t ignored = write(job.fd, "\030", 1);
+            (void)ignored;
+        }
+    } else {
+        close(job.fd);
+        if (job.pid > 0) {
+            if (cancel) kill(job.pid, SIGTERM);
+            if (waitpid(job.pid, NULL, cancel ? 0 : WNOHANG) == 0) reap_later(job.pid);
+        }
+    }
+    yank_unref(job.text);
+    memset(&job, 0, sizeof(job));
+    job.fd = -1;
+}
+
+static int start_helper(void) {
+    int fds[2];
+    if (pipe(fds) == -1) return -1;
+
+    pid_t pid = fork();
+    if (pid == -1) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        /* Child: text on stdin, output kept off the editor's screen */
+        dup2(fds[0], STDIN_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) {
+            dup2(null, STDOUT_FILENO);
+            dup2(null, STDERR_FILENO);
+        }
+        execl("/bin/sh", "sh", "-c", helper, (char *)NULL);
+        _exit(127);
+    }
+
+    /* A helper that exits early must not kill the editor */
+    signal(SIGPIPE, SIG_IGN);
+    close(fds[0]);
+    fcntl(fds[1], F_SETFL, O_NONBLOCK);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    job.fd = fds[1];
+    job.pid = pid;
+    return 0;
+}
+
+int clipboard_export(const yank_text *t) {
+    if (mode == CLIPBOARD_OFF || t == NULL) return 0;
+    if (job.text) finish(1);
+
+    int osc = mode == CLIPBOARD_OSC52 && tty_fd >= 0 && t->bytes <= max_bytes;
+    if (!osc) {
+        if (helper == NULL) {
+            /* Without a terminal or helper (headless use) there is
+             * nothing to export to */
+            if (tty_fd < 0 || mode == CLIPBOARD_HELPER) return 0;
+            editor_set_status("Clipboard: %zu bytes is over the OSC 52 limit of %zu",
+                              t->bytes, max_bytes);
+            return -1;
+        }
+        if (start_helper() == -1) {
+            editor_set_status("Clipboard: can't run %s: %s", helper, strerror(errno));
+            return -1;
+        }
+    } else {
+        job.fd = tty_fd;
+        job.osc = 1;
+        const char *prefix = osc_prefix();
+        job.out_len = strlen(prefix);
+        memcpy(job.out, prefix, job.out_len);
+    }
+
+    job.text = yank_ref((yank_text *)t);
+    clipboard_export_step();
+    return 0;
+}
+
+int clipboard_export_step(void) {
+    if (nrunning > 0) reap_helpers();
+    if (job.text == NULL) return 0;
+
+    for (int i = 0; i < STEP_CHUNKS; i++) {
+        if (job.out_pos == job.out_len) {
+            if (job.text_done) {
+                finish(0);
+                return 0;
+            }
+            refill();
+            continue;
+        }
+
+        /* Only write what the terminal or pipe will take right now */
+        struct pollfd pfd = { job.fd, POLLOUT, 0 };
+        if (poll(&pfd, 1, 0) <= 0) return 1;
+        if (pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            finish(1);
+            editor_set_status("Clipboard: helper closed its input");
+            return 0;
+        }
+
+        ssize_t w = write(job.fd, job.out + job.out_pos, job.out_len - job.out_pos);
+        if (w < 0) {
+            if (errno == EAGAIN || errno == EINTR) return 1;
+            finish(1);
+            editor_set_status("Clipboard: write failed: %s", strerror(errno));
+            return 0;
+        }
+        job.out_pos += (size_t)w;
+    }
+    return 1;
+}
+
+int clipboard_export_pending(void) {
+    return job.text != NULL;
+}
+
+int clipboard_tty_busy(void) {
+    return job.text != NULL && job.osc;
+}
+
+void clipboard_free(void) {
+    if (job.text) finish(1);
+    
+    /* Give running helpers a moment to exit; any still running after
+     * that are left to finish on their own */
+    struct timespec tick = { 0, 1000000 };
+    for (int ms = 0; ms < REAP_WAIT_MS && nrunning > 0; ms++) {
+        reap_helpers();
+        if (nrunning > 0) nanosleep(&tick, NULL);
+    }
+    editor_free(MEM_MISC, running_helpers);
+    running_helpers = NULL;
+    nrunning = running_cap = 0;
+    editor_free(MEM_MISC, helper);
+    helper = NULL;
+}
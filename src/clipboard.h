@@ -0,0 +1,61 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * System clipboard export.
+ *
+ * Copied text is sent to the terminal's clipboard with the OSC 52
+ * escape sequence, or piped to a helper command such as wl-copy, xclip
+ * or pbcopy. The text is base64-encoded straight from the register's
+ * pieces in fixed-size chunks, and the front end calls
+ * clipboard_export_step() from its main loop, which writes only as much
+ * as the terminal or pipe takes without blocking. A large copy never
+ * holds up a keystroke or builds one giant string.
+ */
+
+#ifndef ABCZED_CLIPBOARD_H
+#define ABCZED_CLIPBOARD_H
+
+#include "abczed.h"
+
+#include <stddef.h>
+
+enum clipboard_mode {
+    CLIPBOARD_OFF,
+    CLIPBOARD_OSC52,        /* OSC 52; the helper takes over past the cap or without a tty */
+    CLIPBOARD_HELPER        /* Always pipe to the helper command */
+};
+
+/* Default OSC 52 cap on the copied text, before base64 */
+#define CLIPBOARD_DEFAULT_MAX (1024 * 1024)
+
+/* Terminal to write OSC 52 to; -1 (the default) disables OSC 52 */
+void clipboard_set_tty(int fd);
+
+void clipboard_set_mode(enum clipboard_mode mode);
+enum clipboard_mode clipboard_get_mode(void);
+void clipboard_set_max(size_t bytes);
+size_t clipboard_get_max(void);
+
+/* Shell command that reads the clipboard text on stdin; NULL clears it */
+int clipboard_set_helper(const char *command);
+const char *clipboard_get_helper(void);
+
+/* Start exporting t, cancelling an export still in progress; returns
+ * -1 if no transport can take it (the reason is in the status line) */
+int clipboard_export(const yank_text *t);
+
+/* Write the next chunks of the current export and reap helpers that
+ * have exited since; returns 1 while more remains */
+int clipboard_export_step(void);
+int clipboard_export_pending(void);
+
+/* An OSC 52 sequence is half written; screen output must wait or the
+ * terminal would take it as part of the sequence */
+int clipboard_tty_busy(void);
+
+/* Cancel any export, give running helpers a moment to exit and drop
+ * the helper command */
+void clipboard_free(void);
+
+#endif /* ABCZED_CLIPBOARD_H */
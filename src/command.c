@@ -0,0 +1,489 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Command-line (":") command engine.
+ */
+
+#include "abczed.h"
+#include "clipboard.h"
+#include "compress.h"
+#include "encoding.h"
+#include "mem.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* :diff [head]: the gutter against the file as opened or saved, or
+ * against git HEAD, and how much differs */
+static void editor_diff_command(int head) {
+    if (!diff_gutter_width() || diff_head() != head) {
+        if (!head && E.dirty) {
+            /* The buffer becomes the base, so it has to be the file */
+            editor_set_status("No write since last change; save before :diff");
+            return;
+        }
+        if (diff_enable(head) == -1) return;
+    }
+    int added, changed, deleted;
+    diff_summary(&added, &changed, &deleted);
+    editor_set_status("diff against %s: %d added, %d changed, %d deleted",
+                      head ? "HEAD" : "file", added, changed, deleted);
+}
+
+/* :csv [on|off|comma|tab|semicolon|pipe|header|noheader|sort [N] [desc]] */
+static void editor_csv_command(const char *arg) {
+    static const struct { const char *name; int delim; } delims[] = {
+        { "on", 0 }, { "comma", ',' }, { "tab", '\t' }, { "semicolon", ';' }, { "pipe", '|' }
+    };
+    if (strcmp(arg, "off") == 0) {
+        csv_disable();
+        editor_set_status("csv off");
+        return;
+    }
+    for (size_t i = 0; i < sizeof(delims) / sizeof(delims[0]); i++) {
+        if (*arg != '\0' && strcmp(arg, delims[i].name) != 0) continue;
+        if (csv_enable(delims[i].delim) == -1) {
+            editor_set_status("Error: Out of memory");
+            return;
+        }
+        int d = csv_delim();
+        editor_set_status("csv, delimiter %s", d == '\t' ? "tab" : d == ',' ? "comma" : d == ';' ? "semicolon" : "pipe");
+        return;
+    }
+    if (!csv_delim()) {
+        editor_set_status("Error: csv is off");
+    } else if (strcmp(arg, "header") == 0 || strcmp(arg, "noheader") == 0) {
+        csv_set_header(arg[0] == 'h');
+        editor_set_status("csv header %s", arg[0] == 'h' ? "on" : "off");
+    } else if (strcmp(arg, "sort") == 0 || strncmp(arg, "sort ", 5) == 0) {
+        /* By the cursor's column unless one is given, counted from 1 */
+        const char *p = arg + 4;
+        int col = E.cy < E.numrows ? csv_field_at(E.cy, E.cx) : 0, desc = 0;
+        char *end;
+        while (*p == ' ') p++;
+        if (*p >= '0' && *p <= '9') {
+            long n = strtol(p, &end, 10);
+            if (n < 1 || n > INT_MAX) {
+                editor_set_status("Error: bad column %s", p);
+                return;
+            }
+            col = (int)n - 1;
+            for (p = end; *p == ' '; p++);
+        }
+        if (strcmp(p, "desc") == 0) {
+            desc = 1;
+        } else if (*p != '\0') {
+            editor_set_status("Error: csv sort [column] [desc]");
+            return;
+        }
+        int n = csv_sort(col, desc);
+        if (n >= 0) editor_set_status("%d rows sorted by column %d%s", n, col + 1, desc ? ", descending" : "");
+    } else {
+        editor_set_status("Error: unknown csv option %s", arg);
+    }
+}
+
+/* Process command with optional double colon prefix.
+ * Normalizes the command to start with exactly one colon.
+ * Handles cases like ':', '::', '::cmd', 'cmd' etc.
+ */
+int process_command_prefix(char *cmd) {
+    if (!cmd || !*cmd) return 0;  /* NULL or empty command */
+    
+    size_t len = strlen(cmd);
+    if (len >= 256) return 0;  /* Command too long */
+    
+    /* Skip leading whitespace */
+    char *p = cmd;
+    while (*p == ' ' || *p == '\t') p++;
+    if (p > cmd) {
+        memmove(cmd, p, len - (p - cmd) + 1);
+        len = strlen(cmd);
+    }
+    
+    /* Find first non-colon character */
+    size_t first_non_colon = 0;
+    while (first_non_colon < len && cmd[first_non_colon] == ':') {
+        first_non_colon++;
+    }
+    
+    /* Handle empty command or just colons */
+    if (first_non_colon >= len) {
+        cmd[0] = ':';
+        cmd[1] = '\0';
+        return 0;  /* Don't process empty commands */
+    }
+    
+    /* If command doesn't start with a colon, add one */
+    if (first_non_colon == 0) {
+        if (len + 1 >= sizeof(E.commandbuf)) return 0;  /* Check buffer space */
+        memmove(cmd + 1, cmd, len + 1);  /* +1 for null terminator */
+        cmd[0] = ':';
+        len++;
+    }
+    /* If command starts with multiple colons, collapse them to one */
+    else if (first_non_colon > 1) {
+        memmove(cmd + 1, cmd + first_non_colon, len - first_non_colon + 1);
+        cmd[0] = ':';
+        len -= (first_non_colon - 1);
+    }
+    
+    /* Trim any whitespace after the colon */
+    p = cmd + 1;
+    while (*p == ' ' || *p == '\t') p++;
+    if (p > cmd + 1) {
+        memmove(cmd + 1, p, len - (p - cmd) + 1);
+    }
+    
+    /* Ensure the command is not just a colon */
+    return (strlen(cmd) > 1);
+}
+
+/* Process command */
+int editor_process_command() {
+    /* Ensure command is null-terminated */
+    size_t cmd_buf_size = sizeof(E.commandbuf);
+    if (E.commandlen >= 0 && (size_t)E.commandlen >= cmd_buf_size) {
+        E.commandbuf[cmd_buf_size - 1] = '\0';
+        E.commandlen = (int)(cmd_buf_size - 1);
+    } else {
+        E.commandbuf[E.commandlen] = '\0';
+    }
+    
+    /* Process command prefix (handle double colons and whitespace) */
+    if (!process_command_prefix(E.commandbuf)) {
+        /* Empty or invalid command */
+        return EDITOR_CMD_IGNORED;
+    }
+    E.commandlen = strlen(E.commandbuf);
+    
+    /* Command history feature */
+    static char cmd_history[10][256];  /* Store last 10 commands */
+    static int cmd_history_pos = 0;
+    static int cmd_history_len = 0;
+    
+    /* Save current cursor and scroll position to restore after command */
+    int saved_cx = E.cx;
+    int saved_cy = E.cy;
+    int saved_rowoff = E.rowoff;
+    int saved_coloff = E.coloff;
+    
+    /* Parse command */
+    int should_quit = 0;
+    int force_quit = 0;
+    int preserve_position = 1;  /* By default, preserve cursor position */
+    
+    /* Trim any trailing whitespace from command */
+    char *cmd = E.commandbuf;
+    while (*cmd == ' ' || *cmd == '\t') cmd++;  /* Skip leading whitespace */
+    char *end = cmd + strlen(cmd) - 1;
+    while (end > cmd && (*end == ' ' || *end == '\t' || *end == '\n' || *end == '\r')) {
+        *end-- = '\0';
+    }
+    
+    /* Check for vim-like commands */
+    if (strcmp(cmd, ":q") == 0 || strcmp(cmd, ":quit") == 0 ||
+        strcmp(cmd, "::q") == 0 || strcmp(cmd, "::quit") == 0) {
+        /* Quit if not dirty */
+        if (E.dirty) {
+            editor_set_status("No write since last change (add ! to override)");
+        } else {
+            should_quit = 1;
+        }
+    } else if (strcmp(cmd, ":q!") == 0 || strcmp(cmd, ":quit!") == 0 ||
+               strcmp(cmd, "::q!") == 0 || strcmp(cmd, "::quit!") == 0) {
+        /* Force quit without saving */
+        should_quit = 1;
+        force_quit = 1;
+    } else if (strcmp(cmd, ":w") == 0 || strcmp(cmd, "::w") == 0) {
+        /* Save file */
+        editor_save();
+    } else if (strcmp(cmd, ":wq") == 0 || strcmp(cmd, "::wq") == 0 ||
+               strcmp(cmd, ":sq") == 0 || strcmp(cmd, "::sq") == 0) {
+        /* Save and quit */
+        if (editor_save() == 0) {
+            should_quit = 1;
+        }
+    } else if (strncmp(cmd, ":e ", 3) == 0 || strncmp(cmd, "::e ", 4) == 0) {
+        /* Edit file - open a new file */
+        char *filename = cmd + (cmd[1] == ':' ? 4 : 3);
+        if (E.dirty) {
+            editor_set_status("No write since last change (add ! to override)");
+        } else {
+            /* Clear editor content */
+            for (int i = E.numrows - 1; i >= 0; i--) {
+                editor_del_row(i);
+            }
+            editor_open(filename);
+            editor_set_status("Opened %s", filename);
+            preserve_position = 0;  /* Don't preserve position when opening new file */
+        }
+    } else if (strncmp(cmd, ":e! ", 4) == 0 || strncmp(cmd, "::e! ", 5) == 0) {
+        /* Force edit file - open a new file without saving */
+        char *filename = cmd + (cmd[1] == ':' ? 5 : 4);
+        /* Clear editor content */
+        for (int i = E.numrows - 1; i >= 0; i--) {
+            editor_del_row(i);
+        }
+        editor_open(filename);
+        editor_set_status("Opened %s", filename);
+        preserve_position = 0;  /* Don't preserve position when opening new file */
+    } else if (strcmp(cmd, ":stats") == 0) {
+        /* Show performance counters */
+        char summary[sizeof(E.statusmsg)];
+        stats_summary(summary, sizeof(summary));
+        editor_set_status("%s", summary);
+    } else if (strncmp(cmd, ":stats ", 7) == 0) {
+        /* Write the full performance report to a file */
+        char *path = cmd + 7;
+        FILE *fp = fopen(path, "w");
+        if (!fp) {
+            editor_set_status("Error: can't write %s: %s", path, strerror(errno));
+        } else {
+            stats_write_report(fp);
+            fclose(fp);
+            editor_set_status("Stats written to %s", path);
+        }
+    } else if (strcmp(cmd, ":profile") == 0) {
+        /* Start a new measurement window */
+        stats_reset();
+        trace_reset();
+        editor_set_status("Profiling: counters reset");
+    } else if (strcmp(cmd, ":registers") == 0 || strcmp(cmd, ":reg") == 0) {
+        /* Non-empty registers and their line counts */
+        char list[sizeof(E.statusmsg)];
+        register_list(list, sizeof(list));
+        editor_set_status("%s", list);
+    } else if (strcmp(cmd, ":mem") == 0) {
+        /* Live memory per subsystem */
+        char summary[sizeof(E.statusmsg)];
+        mem_summary(summary, sizeof(summary));
+        editor_set_status("%s", summary);
+    } else if (strcmp(cmd, ":trace") == 0) {
+        /* Frame-time percentiles and slow-frame count */
+        char summary[sizeof(E.statusmsg)];
+        trace_summary(summary, sizeof(summary));
+        editor_set_status("%s", summary);
+    } else if (strcmp(cmd, ":trace dump") == 0 || strncmp(cmd, ":trace dump ", 12) == 0) {
+        /* Write histograms and slow frames to a file */
+        const char *path = cmd[11] ? cmd + 12 : "abczed-trace.txt";
+        FILE *fp = fopen(path, "w");
+        if (!fp) {
+            editor_set_status("Error: can't write %s: %s", path, strerror(errno));
+        } else {
+            trace_dump(fp);
+            fclose(fp);
+            editor_set_status("Trace written to %s", path);
+        }
+    } else if (strncmp(cmd, ":trace threshold ", 17) == 0) {
+        /* Slow-frame threshold in milliseconds */
+        double ms = atof(cmd + 17);
+        if (ms < 0) {
+            editor_set_status("Error: threshold must be >= 0");
+        } else {
+            trace_set_threshold((uint64_t)(ms * 1e6));
+            editor_set_status("Trace threshold %.3f ms", ms);
+        }
+    } else if (strcmp(cmd, ":trace reset") == 0) {
+        trace_reset();
+        editor_set_status("Trace reset");
+    } else if (strcmp(cmd, ":cursors") == 0) {
+        editor_set_status("%d cursors", cursors_count());
+    } else if (strncmp(cmd, ":cursors ", 9) == 0) {
+        /* A cursor at every match of the text */
+        int n = cursors_add_matches(cmd + 9, (int)strlen(cmd + 9));
+        if (n == 0) {
+            editor_set_status("No matches for %s", cmd + 9);
+        } else {
+            editor_set_status("%d cursors (cc to insert, ESC to drop)", n);
+        }
+        preserve_position = 0;
+    } else if (strcmp(cmd, ":fold") == 0) {
+        editor_set_status("%d folds", folds_count());
+    } else if (strcmp(cmd, ":fold clear") == 0) {
+        fold_command('E', E.cy);
+        editor_set_status("Folds cleared");
+    } else if (strncmp(cmd, ":fold indent", 12) == 0 || strncmp(cmd, ":fold brace", 11) == 0) {
+        /* Replace the folds with ones by indent or braces; folds nested
+         * level deep or more start closed */
+        int brace = cmd[6] == 'b';
+        const char *arg = cmd + (brace ? 11 : 12);
+        char *end;
+        long level = *arg == ' ' ? strtol(arg + 1, &end, 10) : 0;
+        if ((*arg != '\0' && (*arg != ' ' || *end != '\0' || end == arg + 1)) || level < 0) {
+            editor_set_status("Error: bad fold level %s", arg);
+        } else {
+            int n = folds_from(brace, level < E.numrows ? (int)level : E.numrows);
+            if (n >= 0) editor_set_status("%d folds", n);
+        }
+    } else if (strcmp(cmd, ":reindent") == 0) {
+        int n = editor_reindent(0, E.numrows - 1);
+        if (n >= 0) editor_set_status("%d lines reindented", n);
+    } else if (strcmp(cmd, ":autoindent") == 0) {
+        editor_set_status("autoindent %s", indent_auto() ? "on" : "off");
+    } else if (strcmp(cmd, ":autoindent on") == 0 || strcmp(cmd, ":autoindent off") == 0) {
+        indent_set_auto(cmd[13] == 'n');
+        editor_set_status("autoindent %s", indent_auto() ? "on" : "off");
+    } else if (strcmp(cmd, ":eol") == 0) {
+        static const char *eols[] = { "lf", "crlf", "cr" };
+        editor_set_status("eol %s%s", eols[E.eol], E.noeol ? ", no newline at end" : "");
+    } else if (strncmp(cmd, ":eol ", 5) == 0) {
+        /* Line ending used by the next save */
+        const char *arg = cmd + 5;
+        int eol = strcmp(arg, "lf") == 0 ? EOL_LF : strcmp(arg, "crlf") == 0 ? EOL_CRLF :
+                  strcmp(arg, "cr") == 0 ? EOL_CR : -1;
+        if (eol == -1) {
+            editor_set_status("Error: eol is lf, crlf or cr");
+        } else if ((int)E.eol != eol) {
+            E.eol = eol;
+            E.dirty++;
+            editor_set_status("eol %s", arg);
+        }
+    } else if (strcmp(cmd, ":encoding") == 0) {
+        editor_set_status("encoding %s%s", encoding_name(E.encoding), E.bom ? " with BOM" : "");
+    } else if (strncmp(cmd, ":encoding ", 10) == 0) {
+        /* Encoding used by the next save; "bom"/"nobom" after the name
+         * add or drop the byte order mark */
+        char name[32];
+        const char *arg = cmd + 10, *sp = strchr(arg, ' ');
+        size_t len = sp ? (size_t)(sp - arg) : strlen(arg);
+        int enc = -1, bom = E.bom;
+        if (len < sizeof(name)) {
+            memcpy(name, arg, len);
+            name[len] = '\0';
+            enc = encoding_from_name(name);
+        }
+        if (sp && strcmp(sp + 1, "bom") == 0) bom = 1;
+        else if (sp && strcmp(sp + 1, "nobom") == 0) bom = 0;
+        else if (sp) enc = -1;
+        if (enc == -1) {
+            editor_set_status("Error: unknown encoding %s", arg);
+        } else {
+            E.encoding = enc;
+            E.bom = enc == ENC_LATIN1 ? 0 : bom;
+            E.dirty++;
+            editor_set_status("encoding %s%s", encoding_name(E.encoding), E.bom ? " with BOM" : "");
+        }
+    } else if (strcmp(cmd, ":hex") == 0) {
+        /* Switch the current file between the text and hex views */
+        if (E.filename == NULL) {
+            editor_set_status("Error: No filename");
+        } else if (E.dirty) {
+            editor_set_status("No write since last change (add ! to override)");
+        } else if (hex_state()) {
+            editor_open(E.filename);
+            editor_set_status("Opened %s", E.filename);
+        } else {
+            hex_open(E.filename);
+        }
+        preserve_position = 0;
+    } else if (strcmp(cmd, ":compress") == 0) {
+        editor_set_status("compress %s", compress_name(E.compression));
+    } else if (strncmp(cmd, ":compress ", 10) == 0) {
+        /* Compression used by the next save */
+        int kind = compress_from_name(cmd + 10);
+        if (kind == -1) {
+            editor_set_status("Error: compress is none, gzip, zstd or xz");
+        } else if (!compress_available(kind)) {
+            editor_set_status("Error: %s support not built in", compress_name(kind));
+        } else if ((int)E.compression != kind) {
+            E.compression = kind;
+            E.dirty++;
+            editor_set_status("compress %s", compress_name(kind));
+        }
+    } else if (strcmp(cmd, ":diff") == 0 || strcmp(cmd, ":diff head") == 0) {
+        editor_diff_command(cmd[5] != '\0');
+    } else if (strcmp(cmd, ":diff off") == 0) {
+        diff_disable();
+        editor_set_status("diff off");
+    } else if (strcmp(cmd, ":csv") == 0 || strncmp(cmd, ":csv ", 5) == 0) {
+        editor_csv_command(cmd[4] ? cmd + 5 : "");
+        preserve_position = 0;
+    } else if (strcmp(cmd, ":clipboard") == 0) {
+        /* Current transport, cap and helper */
+        static const char *modes[] = { "off", "osc52", "helper" };
+        char max[16];
+        const char *helper = clipboard_get_helper();
+        stats_format_bytes(max, sizeof(max), clipboard_get_max());
+        editor_set_status("clipboard %s, osc52 max %s, helper %s%s",
+                          modes[clipboard_get_mode()], max,
+                          helper ? helper : "(none)",
+                          clipboard_export_pending() ? ", exporting" : "");
+    } else if (strcmp(cmd, ":clipboard off") == 0) {
+        clipboard_set_mode(CLIPBOARD_OFF);
+        editor_set_status("Clipboard export off");
+    } else if (strcmp(cmd, ":clipboard osc52") == 0) {
+        clipboard_set_mode(CLIPBOARD_OSC52);
+        editor_set_status("Clipboard export via OSC 52");
+    } else if (strcmp(cmd, ":clipboard helper") == 0) {
+        if (clipboard_get_helper() == NULL) {
+            editor_set_status("Error: set a helper first with :clipboard cmd <command>");
+        } else {
+            clipboard_set_mode(CLIPBOARD_HELPER);
+            editor_set_status("Clipboard export via %s", clipboard_get_helper());
+        }
+    } else if (strncmp(cmd, ":clipboard max ", 15) == 0) {
+        /* OSC 52 cap in bytes, with an optional K or M suffix */
+        char *unit;
+        double n = strtod(cmd + 15, &unit);
+        if (*unit == 'k' || *unit == 'K') n *= 1024;
+        else if (*unit == 'm' || *unit == 'M') n *= 1024 * 1024;
+        if (n < 0 || unit == cmd + 15) {
+            editor_set_status("Error: bad size %s", cmd + 15);
+        } else {
+            char max[16];
+            clipboard_set_max((size_t)n);
+            stats_format_bytes(max, sizeof(max), clipboard_get_max());
+            editor_set_status("OSC 52 max %s", max);
+        }
+    } else if (strcmp(cmd, ":clipboard cmd") == 0 || strncmp(cmd, ":clipboard cmd ", 15) == 0) {
+        /* Helper command; empty clears it */
+        const char *helper = cmd[14] ? cmd + 15 : "";
+        if (clipboard_set_helper(helper) == -1) {
+            editor_set_status("Error: Out of memory");
+        } else if (*helper) {
+            editor_set_status("Clipboard helper: %s", helper);
+        } else {
+            if (clipboard_get_mode() == CLIPBOARD_HELPER) clipboard_set_mode(CLIPBOARD_OSC52);
+            editor_set_status("Clipboard helper cleared");
+        }
+    } else {
+        /* Limit command display to avoid buffer overflow */
+        char cmd_display[60];
+        strncpy(cmd_display, cmd, sizeof(cmd_display) - 1);
+        cmd_display[sizeof(cmd_display) - 1] = '\0';
+        
+        editor_set_status("Unknown command: %s", cmd_display);
+    }
+    
+    /* Save command in history if not empty */
+    if (E.commandlen > 1) {
+        strncpy(cmd_history[cmd_history_pos], E.commandbuf, 255);
+        cmd_history[cmd_history_pos][255] = '\0';
+        cmd_history_pos = (cmd_history_pos + 1) % 10;
+        if (cmd_history_len < 10) cmd_history_len++;
+    }
+    
+    /* Restore cursor and scroll position if needed */
+    if (preserve_position && !should_quit) {
+        E.cx = saved_cx;
+        E.cy = saved_cy;
+        E.rowoff = saved_rowoff;
+        E.coloff = saved_coloff;
+    }
+    
+    /* Handle quit command - the front end owns the terminal, so let it exit */
+    if (should_quit) {
+        if (force_quit || !E.dirty) {
+            return EDITOR_CMD_QUIT;
+        }
+    }
+    
+    return EDITOR_CMD_OK;
+}
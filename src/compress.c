@@ -0,0 +1,413 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Streaming gzip, zstd and xz reading and writing.
+ */
+
+#include "abczed.h"
+#include "compress.h"
+
+#include <string.h>
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+#ifdef HAVE_LZMA
+#include <lzma.h>
+#endif
+
+/* Compressed bytes moved to or from the file at a time */
+#define COMPRESS_CHUNK (64 * 1024)
+
+struct compress_stream {
+    FILE *fp;
+    int kind;
+    int writing;
+    int error;
+    int done;               /* Reader has reached the end of the data */
+    int ended;              /* Reader is between two members or frames */
+    unsigned char *buf;     /* Compressed bytes */
+    size_t cap;
+    unsigned char *stage;   /* Writer input gathered into whole chunks */
+    size_t staged;
+#ifdef HAVE_ZLIB
+    z_stream z;
+#endif
+#ifdef HAVE_ZSTD
+    ZSTD_DStream *zd;
+    ZSTD_CStream *zc;
+    ZSTD_inBuffer zin;
+#endif
+#ifdef HAVE_LZMA
+    lzma_stream x;
+#endif
+};
+
+static const char *names[] = { "none", "gzip", "zstd", "xz" };
+
+const char *compress_name(int kind) {
+    return kind >= 0 && kind < (int)(sizeof(names) / sizeof(names[0])) ? names[kind] : "?";
+}
+
+int compress_from_name(const char *name) {
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) return i;
+    }
+    if (strcmp(name, "gz") == 0) return COMP_GZIP;
+    if (strcmp(name, "zst") == 0) return COMP_ZSTD;
+    return -1;
+}
+
+int compress_detect(const unsigned char *buf, size_t len) {
+    if (len >= 2 && buf[0] == 0x1f && buf[1] == 0x8b) return COMP_GZIP;
+    if (len >= 4 && memcmp(buf, "\x28\xb5\x2f\xfd", 4) == 0) return COMP_ZSTD;
+    if (len >= 6 && memcmp(buf, "\xfd" "7zXZ\0", 6) == 0) return COMP_XZ;
+    return COMP_NONE;
+}
+
+int compress_available(int kind) {
+    switch (kind) {
+        case COMP_NONE: return 1;
+#ifdef HAVE_ZLIB
+        case COMP_GZIP: return 1;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD: return 1;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:   return 1;
+#endif
+        default:        return 0;
+    }
+}
+
+int compress_from_filename(const char *filename) {
+    static const struct { const char *ext; int kind; } exts[] = {
+        { ".gz", COMP_GZIP }, { ".zst", COMP_ZSTD }, { ".xz", COMP_XZ }
+    };
+    size_t len = strlen(filename);
+    for (size_t i = 0; i < sizeof(exts) / sizeof(exts[0]); i++) {
+        size_t n = strlen(exts[i].ext);
+        if (len > n && strcmp(filename + len - n, exts[i].ext) == 0) return exts[i].kind;
+    }
+    return COMP_NONE;
+}
+
+static compress_stream *stream_new(FILE *fp, int kind, int writing, size_t cap) {
+    if (!compress_available(kind) || kind == COMP_NONE) return NULL;
+    compress_stream *s = editor_malloc(MEM_MISC, sizeof(*s));
+    if (s == NULL) return NULL;
+    memset(s, 0, sizeof(*s));
+    s->fp = fp;
+    s->kind = kind;
+    s->writing = writing;
+    s->cap = cap > COMPRESS_CHUNK ? cap : COMPRESS_CHUNK;
+    s->buf = editor_malloc(MEM_MISC, s->cap);
+    if (s->buf == NULL) {
+        editor_free(MEM_MISC, s);
+        return NULL;
+    }
+    return s;
+}
+
+static void stream_free(compress_stream *s) {
+    editor_free(MEM_MISC, s->stage);
+    editor_free(MEM_MISC, s->buf);
+    editor_free(MEM_MISC, s);
+}
+
+compress_stream *compress_reader(FILE *fp, int kind, const unsigned char *head, size_t head_len) {
+    compress_stream *s = stream_new(fp, kind, 0, head_len);
+    if (s == NULL) return NULL;
+    memcpy(s->buf, head, head_len);
+
+    int ok = 0;
+    switch (kind) {
+#ifdef HAVE_ZLIB
+        case COMP_GZIP:
+            s->z.next_in = s->buf;
+            s->z.avail_in = (uInt)head_len;
+            ok = inflateInit2(&s->z, 15 + 16) == Z_OK;
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD:
+            s->zin.src = s->buf;
+            s->zin.size = head_len;
+            s->zd = ZSTD_createDStream();
+            ok = s->zd != NULL && !ZSTD_isError(ZSTD_initDStream(s->zd));
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:
+            {
+                lzma_stream init = LZMA_STREAM_INIT;
+                s->x = init;
+                s->x.next_in = s->buf;
+                s->x.avail_in = head_len;
+                ok = lzma_stream_decoder(&s->x, UINT64_MAX, LZMA_CONCATENATED) == LZMA_OK;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    if (!ok) {
+        compress_close(s);
+        return NULL;
+    }
+    return s;
+}
+
+/* Next compressed bytes from the file; 0 at its end */
+static size_t refill(compress_stream *s) {
+    size_t n = fread(s->buf, 1, s->cap, s->fp);
+    if (n == 0 && ferror(s->fp)) s->error = 1;
+    return n;
+}
+
+size_t compress_read(compress_stream *s, unsigned char *out, size_t cap) {
+    if (s->done) return 0;
+    size_t got = 0;
+
+    switch (s->kind) {
+#ifdef HAVE_ZLIB
+        case COMP_GZIP:
+            s->z.next_out = out;
+            s->z.avail_out = (uInt)cap;
+            while (s->z.avail_out > 0 && !s->done) {
+                if (s->z.avail_in == 0) {
+                    size_t n = refill(s);
+                    if (n == 0) {
+                        if (!s->ended) s->error = 1;
+                        s->done = 1;
+                        break;
+                    }
+                    s->z.next_in = s->buf;
+                    s->z.avail_in = (uInt)n;
+                }
+                if (s->ended) {
+                    /* Members can be concatenated; anything else after
+                     * one (such as padding) ends the data */
+                    if (s->z.next_in[0] != 0x1f) {
+                        s->done = 1;
+                        break;
+                    }
+                    inflateReset(&s->z);
+                    s->ended = 0;
+                }
+                int rc = inflate(&s->z, Z_NO_FLUSH);
+                if (rc == Z_STREAM_END) {
+                    s->ended = 1;
+                } else if (rc != Z_OK && rc != Z_BUF_ERROR) {
+                    s->error = s->done = 1;
+                }
+            }
+            got = cap - s->z.avail_out;
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD:
+            {
+                ZSTD_outBuffer o = { out, cap, 0 };
+                while (o.pos < o.size && !s->done) {
+                    if (s->zin.pos == s->zin.size) {
+                        size_t n = refill(s);
+                        if (n == 0) {
+                            if (!s->ended) s->error = 1;
+                            s->done = 1;
+                            break;
+                        }
+                        s->zin.src = s->buf;
+                        s->zin.size = n;
+                        s->zin.pos = 0;
+                    }
+                    size_t rc = ZSTD_decompressStream(s->zd, &o, &s->zin);
+                    if (ZSTD_isError(rc)) s->error = s->done = 1;
+                    else s->ended = rc == 0;
+                }
+                got = o.pos;
+            }
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:
+            s->x.next_out = out;
+            s->x.avail_out = cap;
+            while (s->x.avail_out > 0 && !s->done) {
+                lzma_action action = LZMA_RUN;
+                if (s->x.avail_in == 0) {
+                    size_t n = refill(s);
+                    s->x.next_in = s->buf;
+                    s->x.avail_in = n;
+                    if (n == 0) action = LZMA_FINISH;
+                }
+                lzma_ret rc = lzma_code(&s->x, action);
+                if (rc == LZMA_STREAM_END) {
+                    s->done = 1;
+                } else if (rc != LZMA_OK) {
+                    s->error = s->done = 1;
+                }
+            }
+            got = cap - s->x.avail_out;
+            break;
+#endif
+        default:
+            s->error = s->done = 1;
+            break;
+    }
+    return got;
+}
+
+compress_stream *compress_writer(FILE *fp, int kind) {
+    compress_stream *s = stream_new(fp, kind, 1, 0);
+    if (s == NULL) return NULL;
+    s->stage = editor_malloc(MEM_MISC, COMPRESS_CHUNK);
+    if (s->stage == NULL) {
+        stream_free(s);
+        return NULL;
+    }
+
+    int ok = 0;
+    switch (kind) {
+#ifdef HAVE_ZLIB
+        case COMP_GZIP:
+            ok = deflateInit2(&s->z, 6, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD:
+            s->zc = ZSTD_createCStream();
+            ok = s->zc != NULL && !ZSTD_isError(ZSTD_initCStream(s->zc, 3));
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:
+            {
+                lzma_stream init = LZMA_STREAM_INIT;
+                s->x = init;
+                ok = lzma_easy_encoder(&s->x, 6, LZMA_CHECK_CRC64) == LZMA_OK;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+    if (!ok) {
+        s->writing = 0;
+        compress_close(s);
+        return NULL;
+    }
+    return s;
+}
+
+static int flush_out(compress_stream *s, size_t n) {
+    if (n > 0 && fwrite(s->buf, 1, n, s->fp) != n) s->error = 1;
+    return s->error ? -1 : 0;
+}
+
+/* Compress len bytes, or with finish the end of the data */
+static int encode(compress_stream *s, const void *buf, size_t len, int finish) {
+    switch (s->kind) {
+#ifdef HAVE_ZLIB
+        case COMP_GZIP:
+            {
+                s->z.next_in = (Bytef *)buf;
+                s->z.avail_in = (uInt)len;
+                int rc;
+                do {
+                    s->z.next_out = s->buf;
+                    s->z.avail_out = (uInt)s->cap;
+                    rc = deflate(&s->z, finish ? Z_FINISH : Z_NO_FLUSH);
+                    if (rc == Z_STREAM_ERROR || flush_out(s, s->cap - s->z.avail_out) == -1) return -1;
+                } while (finish ? rc != Z_STREAM_END : s->z.avail_out == 0 || s->z.avail_in > 0);
+            }
+            return 0;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD:
+            {
+                ZSTD_inBuffer in = { buf, len, 0 };
+                size_t left;
+                do {
+                    ZSTD_outBuffer o = { s->buf, s->cap, 0 };
+                    left = ZSTD_compressStream2(s->zc, &o, &in, finish ? ZSTD_e_end : ZSTD_e_continue);
+                    if (ZSTD_isError(left) || flush_out(s, o.pos) == -1) return -1;
+                } while (finish ? left != 0 : in.pos < in.size);
+            }
+            return 0;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:
+            {
+                s->x.next_in = buf;
+                s->x.avail_in = len;
+                lzma_ret rc;
+                do {
+                    s->x.next_out = s->buf;
+                    s->x.avail_out = s->cap;
+                    rc = lzma_code(&s->x, finish ? LZMA_FINISH : LZMA_RUN);
+                    if ((rc != LZMA_OK && rc != LZMA_STREAM_END) ||
+                        flush_out(s, s->cap - s->x.avail_out) == -1) return -1;
+                } while (finish ? rc != LZMA_STREAM_END : s->x.avail_in > 0);
+            }
+            return 0;
+#endif
+        default:
+            (void)buf;
+            (void)len;
+            (void)finish;
+            return -1;
+    }
+}
+
+/* Rows are short, so they are gathered into chunks before each call into
+ * the codec */
+int compress_write(compress_stream *s, const void *buf, size_t len) {
+    if (s->error) return -1;
+    if (s->staged + len > COMPRESS_CHUNK) {
+        if (encode(s, s->stage, s->staged, 0) == -1) s->error = 1;
+        s->staged = 0;
+    }
+    if (len >= COMPRESS_CHUNK) {
+        if (!s->error && encode(s, buf, len, 0) == -1) s->error = 1;
+    } else {
+        memcpy(s->stage + s->staged, buf, len);
+        s->staged += len;
+    }
+    return s->error ? -1 : 0;
+}
+
+int compress_close(compress_stream *s) {
+    if (s == NULL) return -1;
+    if (s->writing && !s->error && encode(s, s->stage, s->staged, 1) == -1) s->error = 1;
+
+    switch (s->kind) {
+#ifdef HAVE_ZLIB
+        case COMP_GZIP:
+            if (s->writing) deflateEnd(&s->z);
+            else inflateEnd(&s->z);
+            break;
+#endif
+#ifdef HAVE_ZSTD
+        case COMP_ZSTD:
+            ZSTD_freeDStream(s->zd);
+            ZSTD_freeCStream(s->zc);
+            break;
+#endif
+#ifdef HAVE_LZMA
+        case COMP_XZ:
+            lzma_end(&s->x);
+            break;
+#endif
+        default:
+            break;
+    }
+    int err = s->error;
+    stream_free(s);
+    return err ? -1 : 0;
+}
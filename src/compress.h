@@ -0,0 +1,50 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Compressed files.
+ *
+ * gzip, zstd and xz files are recognized by their magic bytes and
+ * decompressed as they are read, one chunk at a time, into the same line
+ * splitter as plain files; saving compresses the rows as they are
+ * written. Each codec is built in only when its library (zlib, libzstd,
+ * liblzma) is found at build time: the Makefile defines HAVE_ZLIB,
+ * HAVE_ZSTD and HAVE_LZMA.
+ */
+
+#ifndef ABCZED_COMPRESS_H
+#define ABCZED_COMPRESS_H
+
+#include <stddef.h>
+#include <stdio.h>
+
+typedef struct compress_stream compress_stream;
+
+/* The compression of a file starting with buf[0..len) */
+int compress_detect(const unsigned char *buf, size_t len);
+
+/* Whether this build can read and write kind */
+int compress_available(int kind);
+
+/* The compression a new file's name asks for, by extension */
+int compress_from_filename(const char *filename);
+
+const char *compress_name(int kind);
+int compress_from_name(const char *name);
+
+/* Decompress fp, whose first head_len bytes were already read into head;
+ * NULL if the codec is not built in or out of memory */
+compress_stream *compress_reader(FILE *fp, int kind, const unsigned char *head, size_t head_len);
+
+/* Up to cap decompressed bytes; 0 at the end or on error */
+size_t compress_read(compress_stream *s, unsigned char *out, size_t cap);
+
+/* Compress what is written into fp */
+compress_stream *compress_writer(FILE *fp, int kind);
+int compress_write(compress_stream *s, const void *buf, size_t len);
+
+/* Finish a writer and free either kind of stream; -1 if the data was
+ * corrupt, truncated or could not be written */
+int compress_close(compress_stream *s);
+
+#endif /* ABCZED_COMPRESS_H */
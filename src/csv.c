@@ -0,0 +1,442 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * CSV and TSV view.
+ *
+ * Rows stay the file's text; the view only changes how they are shown.
+ * A row's fields are found when it is first drawn or moved through and
+ * kept, as the offsets of the delimiters ending them, in a direct-mapped
+ * cache of CSV_CACHE lines that edits invalidate. Scrolling parses only
+ * the rows coming into view. Delimiters are found 16 bytes at a time
+ * with SSE2 where the compiler targets it; a field that starts with a
+ * quote runs to the closing quote ("" is a quote inside it), so quoted
+ * delimiters do not split it. A quoted field spanning several lines is
+ * shown one line at a time.
+ *
+ * Column widths are the widest field seen so far in each column, up to
+ * CSV_WIDTH_MAX, and only grow, so columns do not shift back and forth
+ * while scrolling.
+ */
+
+#include "abczed.h"
+#include "compress.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Lines whose fields are kept; a power of two */
+#define CSV_CACHE 4096
+
+/* Widest a column gets on screen */
+#define CSV_WIDTH_MAX 40
+
+/* Rows looked at for the first column widths */
+#define CSV_SAMPLE 1000
+
+/* Fields of one line: ends[i] is the offset of the delimiter after
+ * field i, or the row's size for the last one */
+typedef struct csv_line {
+    int y;                  /* -1 when empty */
+    int n, cap;
+    int *ends;
+} csv_line;
+
+static struct {
+    int delim;              /* 0 when the view is off */
+    int header;             /* Row 0 stays on screen */
+    int coloff;             /* First screen column shown */
+    int *widths;
+    int ncols, wcap;
+    csv_line *cache;
+    int last;               /* No line past this one is cached */
+} C;
+
+/* First delimiter in s[from, to), or to */
+static int scan_delim(const char *s, int from, int to, char delim) {
+    int i = from;
+#ifdef __SSE2__
+    __m128i d = _mm_set1_epi8(delim);
+    for (; i + 16 <= to; i += 16) {
+        int m = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(s + i)), d));
+        if (m != 0) return i + __builtin_ctz(m);
+    }
+#endif
+    while (i < to && s[i] != delim) i++;
+    return i;
+}
+
+/* Split r into *ends; returns the number of fields or -1 */
+static int parse(const erow *r, int **ends, int *cap) {
+    const char *s = r->chars;
+    int size = r->size, n = 0, i = 0;
+    for (;;) {
+        if (i < size && s[i] == '"') {
+            /* Quoted: runs to a quote that is not doubled */
+            i++;
+            for (;;) {
+                const char *q = memchr(s + i, '"', size - i);
+                if (q == NULL) {
+                    i = size;
+                    break;
+                }
+                i = (int)(q - s) + 1;
+                if (i < size && s[i] == '"') i++;
+                else break;
+            }
+        }
+        i = scan_delim(s, i, size, (char)C.delim);
+        if (n == *cap) {
+            int c = *cap ? *cap * 2 : 16;
+            int *e = editor_realloc(MEM_INDEX, *ends, sizeof(int) * c);
+            if (e == NULL) return -1;
+            *ends = e;
+            *cap = c;
+        }
+        (*ends)[n++] = i;
+        if (i >= size) return n;
+        i++;
+    }
+}
+
+int csv_fields(int y, const int **ends) {
+    csv_line *l = &C.cache[y & (CSV_CACHE - 1)];
+    if (l->y != y) {
+        l->y = -1;
+        l->n = parse(&E.row[y], &l->ends, &l->cap);
+        if (l->n == -1) {
+            /* Out of memory: the whole line as one field */
+            static int whole;
+            whole = E.row[y].size;
+            *ends = &whole;
+            return 1;
+        }
+        l->y = y;
+        if (y > C.last) C.last = y;
+    }
+    *ends = l->ends;
+    return l->n;
+}
+
+/* Text of a field without its enclosing quotes */
+static void field_text(const erow *r, const int *ends, int i, int *start, int *end) {
+    int s = i > 0 ? ends[i - 1] + 1 : 0, e = ends[i];
+    if (e - s >= 2 && r->chars[s] == '"' && r->chars[e - 1] == '"') {
+        s++;
+        e--;
+    }
+    *start = s;
+    *end = e;
+}
+
+void csv_field(int y, int i, int *start, int *end) {
+    const int *ends;
+    int n = csv_fields(y, &ends);
+    if (i >= n) {
+        *start = *end = E.row[y].size;
+        return;
+    }
+    field_text(&E.row[y], ends, i, start, end);
+}
+
+int csv_width(int i) {
+    return i < C.ncols ? C.widths[i] : 1;
+}
+
+/* Let the columns hold row y's fields */
+static void widen(int y) {
+    const int *ends;
+    int n = csv_fields(y, &ends);
+    if (n > C.wcap) {
+        int cap = C.wcap ? C.wcap : 16;
+        while (cap < n) cap *= 2;
+        int *w = editor_realloc(MEM_INDEX, C.widths, sizeof(int) * cap);
+        if (w == NULL) return;
+        C.widths = w;
+        C.wcap = cap;
+    }
+    for (; C.ncols < n; C.ncols++) C.widths[C.ncols] = 1;
+    for (int i = 0; i < n; i++) {
+        int s, e;
+        field_text(&E.row[y], ends, i, &s, &e);
+        int w = e - s < CSV_WIDTH_MAX ? e - s : CSV_WIDTH_MAX;
+        if (w > C.widths[i]) C.widths[i] = w;
+    }
+}
+
+/* Delimiter used most on the first line outside quotes */
+static int detect_delim(void) {
+    static const char cands[] = ",\t;|";
+    int best = ',', most = 0;
+    if (E.numrows == 0) return best;
+    const erow *r = &E.row[0];
+    for (const char *c = cands; *c; c++) {
+        int count = 0, quoted = 0;
+        for (int i = 0; i < r->size; i++) {
+            if (r->chars[i] == '"') quoted = !quoted;
+            else if (!quoted && r->chars[i] == *c) count++;
+        }
+        if (count > most) {
+            most = count;
+            best = *c;
+        }
+    }
+    return best;
+}
+
+/* Forget every line from row from on */
+static void cache_clear(int from) {
+    if (from > C.last) return;
+    for (int i = 0; i < CSV_CACHE; i++) {
+        if (C.cache[i].y >= from) C.cache[i].y = -1;
+    }
+    C.last = from - 1;
+}
+
+int csv_enable(int delim) {
+    if (C.cache == NULL) {
+        C.cache = editor_malloc(MEM_INDEX, sizeof(csv_line) * CSV_CACHE);
+        if (C.cache == NULL) return -1;
+        for (int i = 0; i < CSV_CACHE; i++) {
+            C.cache[i].y = -1;
+            C.cache[i].n = C.cache[i].cap = 0;
+            C.cache[i].ends = NULL;
+        }
+        C.header = 1;
+    }
+    C.delim = delim ? delim : detect_delim();
+    C.ncols = 0;
+    C.coloff = 0;
+    C.last = INT_MAX;
+    cache_clear(0);
+    for (int y = 0; y < E.numrows && y < CSV_SAMPLE; y++) widen(y);
+    return 0;
+}
+
+void csv_disable(void) {
+    if (C.cache) {
+        for (int i = 0; i < CSV_CACHE; i++) editor_free(MEM_INDEX, C.cache[i].ends);
+        editor_free(MEM_INDEX, C.cache);
+    }
+    editor_free(MEM_INDEX, C.widths);
+    memset(&C, 0, sizeof(C));
+}
+
+int csv_from_filename(const char *name) {
+    size_t len = strlen(name);
+    if (compress_from_filename(name) != COMP_NONE) {
+        /* foo.csv.gz: the extension before the compressor's */
+        while (len > 0 && name[len - 1] != '.') len--;
+        if (len > 0) len--;
+    }
+    if (len > 4 && strncmp(name + len - 4, ".csv", 4) == 0) return ',';
+    if (len > 4 && strncmp(name + len - 4, ".tsv", 4) == 0) return '\t';
+    return 0;
+}
+
+int csv_delim(void) {
+    return C.delim;
+}
+
+void csv_set_header(int on) {
+    C.header = on;
+}
+
+int csv_header_rows(void) {
+    return C.delim && C.header && E.numrows > 0 ? 1 : 0;
+}
+
+int csv_coloff(void) {
+    return C.coloff;
+}
+
+void csv_row_changed(int y) {
+    if (!C.delim) return;
+    csv_line *l = &C.cache[y & (CSV_CACHE - 1)];
+    if (l->y == y) l->y = -1;
+}
+
+void csv_rows_replaced(int at, int count, int n) {
+    if (!C.delim) return;
+    if (count != n || count >= CSV_CACHE) {
+        /* Rows from at on have new numbers */
+        cache_clear(at);
+        return;
+    }
+    for (int y = at; y < at + count; y++) csv_row_changed(y);
+}
+
+int csv_column_x(int i) {
+    int x = 0;
+    for (int j = 0; j < i; j++) x += csv_width(j) + CSV_SEP;
+    return x;
+}
+
+int csv_field_at(int y, int x) {
+    const int *ends;
+    int n = csv_fields(y, &ends), i = 0;
+    while (i < n - 1 && x > ends[i]) i++;
+    return i;
+}
+
+int csv_same_column(int from, int x, int to) {
+    int i = csv_field_at(from, x), s, e, ts, te;
+    csv_field(from, i, &s, &e);
+    csv_field(to, i, &ts, &te);
+    int off = x > s ? x - s : 0;
+    return off < te - ts ? ts + off : te;
+}
+
+int csv_display_x(int y, int x) {
+    const int *ends;
+    int n = csv_fields(y, &ends);
+    int i = csv_field_at(y, x);
+    int col = csv_column_x(i), s, e, w = csv_width(i);
+    /* The delimiter itself shows as the column separator */
+    if (x == ends[i] && i < n - 1) return col + w + 1;
+    field_text(&E.row[y], ends, i, &s, &e);
+    int off = x - s;
+    if (off < 0) off = 0;
+    return col + (off < w ? off : w);
+}
+
+int csv_screen_row(int line) {
+    int head = csv_header_rows();
+    return line < head ? line : E.rowoff + line - head;
+}
+
+void csv_scroll(void) {
+    int head = csv_header_rows();
+    int body = E.screenrows - head > 0 ? E.screenrows - head : 1;
+    if (E.rowoff < head) E.rowoff = head;
+    if (E.cy >= head) {
+        if (E.cy < E.rowoff) E.rowoff = E.cy;
+        if (E.cy >= E.rowoff + body) E.rowoff = E.cy - body + 1;
+    }
+    /* Only the rows on screen are parsed */
+    if (head) widen(0);
+    for (int y = E.rowoff; y < E.rowoff + body && y < E.numrows; y++) widen(y);
+    if (E.cy >= E.numrows) return;
+
+    int dx = csv_display_x(E.cy, E.cx);
+    if (dx < C.coloff) C.coloff = dx;
+    if (dx >= C.coloff + E.screencols) C.coloff = dx - E.screencols + 1;
+}
+
+int csv_next_field(int y, int x, long count) {
+    const int *ends;
+    int n = csv_fields(y, &ends);
+    long i = csv_field_at(y, x);
+    int start = i > 0 ? ends[i - 1] + 1 : 0;
+    /* Back from inside a field goes to its own start first */
+    if (count < 0 && x > start) count++;
+    i += count;
+    if (i < 0) i = 0;
+    if (i > n - 1) i = n - 1;
+    return i > 0 ? ends[i - 1] + 1 : 0;
+}
+
+/* Sort key of one row */
+typedef struct sort_key {
+    const char *s;
+    int len;
+    int row;
+    int is_num;
+    double num;
+} sort_key;
+
+static int sort_desc;
+
+/* Numbers first, by value, then text, by bytes; ties keep their order */
+static int key_cmp(const void *a, const void *b) {
+    const sort_key *p = a, *q = b;
+    int c;
+    if (p->is_num != q->is_num) {
+        c = q->is_num - p->is_num;
+    } else if (p->is_num) {
+        c = (p->num > q->num) - (p->num < q->num);
+    } else {
+        int len = p->len < q->len ? p->len : q->len;
+        c = memcmp(p->s, q->s, len);
+        if (c == 0) c = (p->len > q->len) - (p->len < q->len);
+    }
+    if (sort_desc) c = -c;
+    return c != 0 ? c : p->row - q->row;
+}
+
+/* Whether s[0, len) is a whole number such as -12, 3.5 or 1e6 */
+static int parse_number(const char *s, int len, double *v) {
+    char buf[64];
+    if (len == 0 || len >= (int)sizeof(buf)) return 0;
+    if (!((s[0] >= '0' && s[0] <= '9') || s[0] == '-' || s[0] == '+' || s[0] == '.')) return 0;
+    memcpy(buf, s, len);
+    buf[len] = '\0';
+    char *end;
+    *v = strtod(buf, &end);
+    return end == buf + len;
+}
+
+int csv_sort(int col, int desc) {
+    int first = csv_header_rows(), count = E.numrows - first;
+    if (count < 2) return 0;
+    sort_key *keys = editor_malloc(MEM_MISC, sizeof(sort_key) * count);
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow) * count);
+    int *ends = NULL, cap = 0;
+    if (keys == NULL || rows == NULL) goto fail;
+
+    /* Keys are parsed straight from the rows, not through the cache */
+    for (int i = 0; i < count; i++) {
+        const erow *r = &E.row[first + i];
+        int n = parse(r, &ends, &cap), s, e;
+        if (n == -1) goto fail;
+        if (col < n) field_text(r, ends, col, &s, &e);
+        else s = e = r->size;
+        keys[i].s = r->chars + s;
+        keys[i].len = e - s;
+        keys[i].row = first + i;
+        keys[i].is_num = parse_number(keys[i].s, keys[i].len, &keys[i].num);
+    }
+    sort_desc = desc;
+    qsort(keys, count, sizeof(sort_key), key_cmp);
+
+    int moved = 0;
+    for (int i = 0; i < count; i++) moved |= keys[i].row != first + i;
+    if (!moved) {
+        editor_free(MEM_MISC, keys);
+        editor_free(MEM_UNDO, rows);
+        editor_free(MEM_INDEX, ends);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        rows[i].size = E.row[keys[i].row].size;
+        rows[i].chars = row_text_ref(E.row[keys[i].row].chars);
+    }
+    editor_free(MEM_MISC, keys);
+    editor_free(MEM_INDEX, ends);
+    keys = NULL;
+    ends = NULL;
+
+    /* One undo step; no row text is copied either way */
+    int n = count;
+    if (undo_begin_rows(first, count) == -1 || editor_swap_rows(first, count, &rows, &n) == -1) {
+        for (int i = 0; i < count; i++) row_text_unref(rows[i].chars);
+        goto fail;
+    }
+    for (int i = 0; i < n; i++) row_text_unref(rows[i].chars);
+    editor_free(MEM_UNDO, rows);
+    undo_end_rows(count);
+    E.dirty++;
+    return count;
+
+fail:
+    editor_free(MEM_MISC, keys);
+    editor_free(MEM_UNDO, rows);
+    editor_free(MEM_INDEX, ends);
+    editor_set_status("Memory allocation failed");
+    return -1;
+}
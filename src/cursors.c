@@ -0,0 +1,267 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Multiple cursors.
+ *
+ * The cursors are one array sorted by row and column. An edit walks it
+ * once: the cursors on a row are applied together, building the row's
+ * new text in a single left-to-right copy, so the cost is the size of
+ * the rows touched plus the text inserted, however many cursors share a
+ * row. The rows with cursors, and only those, are saved for undo by
+ * reference, making the whole edit one undo step.
+ */
+
+#include "abczed.h"
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+static cursor_pos *cur = NULL;
+static int ncur = 0;
+static int capcur = 0;
+
+static int cursor_push(int y, int x) {
+    if (ncur == capcur) {
+        int cap = capcur ? capcur * 2 : 64;
+        cursor_pos *p = editor_realloc(MEM_MISC, cur, sizeof(cursor_pos) * cap);
+        if (p == NULL) return -1;
+        cur = p;
+        capcur = cap;
+    }
+    cur[ncur].y = y;
+    cur[ncur].x = x;
+    ncur++;
+    return 0;
+}
+
+/* Drop cursors that edits have moved onto the same position */
+static void cursors_dedupe(void) {
+    int n = 0;
+    for (int i = 0; i < ncur; i++) {
+        if (n > 0 && cur[n - 1].y == cur[i].y && cur[n - 1].x == cur[i].x) continue;
+        cur[n++] = cur[i];
+    }
+    ncur = n;
+}
+
+/* Primary cursor follows the first one */
+static void cursors_sync(void) {
+    if (ncur == 0) return;
+    E.cy = cur[0].y;
+    E.cx = cur[0].x;
+}
+
+void cursors_clear(void) {
+    editor_free(MEM_MISC, cur);
+    cur = NULL;
+    ncur = capcur = 0;
+}
+
+int cursors_add_matches(const char *s, int len) {
+    cursors_clear();
+    if (len <= 0) return 0;
+
+    for (int y = 0; y < E.numrows; y++) {
+        const char *chars = E.row[y].chars;
+        int size = E.row[y].size;
+        for (int x = 0; x + len <= size; ) {
+            const char *hit = memchr(chars + x, s[0], size - len - x + 1);
+            if (hit == NULL) break;
+            x = (int)(hit - chars);
+            if (memcmp(hit, s, len) == 0) {
+                if (cursor_push(y, x) == -1) return ncur;
+                x += len;
+            } else {
+                x++;
+            }
+        }
+    }
+    cursors_sync();
+    return ncur;
+}
+
+int cursors_add_lines(int y0, int y1, int x) {
+    cursors_clear();
+    if (y1 >= E.numrows) y1 = E.numrows - 1;
+    for (int y = y0; y <= y1; y++) {
+        if (cursor_push(y, x < E.row[y].size ? x : E.row[y].size) == -1) break;
+    }
+    cursors_sync();
+    return ncur;
+}
+
+/* Keep cursors inside the buffer, after an undo or redo or before an edit */
+void cursors_clamp(void) {
+    int n = 0;
+    for (int i = 0; i < ncur; i++) {
+        if (cur[i].y >= E.numrows) break;
+        if (cur[i].x > E.row[cur[i].y].size) cur[i].x = E.row[cur[i].y].size;
+        cur[n++] = cur[i];
+    }
+    ncur = n;
+    cursors_dedupe();
+    cursors_sync();
+}
+
+/* Rows [at, at+count) became n rows: cursors below them move with their
+ * lines, and cursors on rows that went away are dropped */
+void cursors_rows_replaced(int at, int count, int n) {
+    int k = cursors_row_start(at), out = k;
+    for (int i = k; i < ncur; i++) {
+        int y = cur[i].y;
+        if (y >= at + count) {
+            y += n - count;
+        } else if (y - at >= n) {
+            continue;
+        } else if (cur[i].x > E.row[y].size) {
+            cur[i].x = E.row[y].size;
+        }
+        cur[out].y = y;
+        cur[out].x = cur[i].x;
+        out++;
+    }
+    ncur = out;
+}
+
+static int cursor_cmp(const void *a, const void *b) {
+    const cursor_pos *p = a, *q = b;
+    if (p->y != q->y) return p->y < q->y ? -1 : 1;
+    return (p->x > q->x) - (p->x < q->x);
+}
+
+/* Move cursor i; cursors_settle() restores the order afterwards */
+void cursors_set(int i, int y, int x) {
+    if (i < 0 || i >= ncur) return;
+    cur[i].y = y;
+    cur[i].x = x;
+}
+
+void cursors_settle(void) {
+    qsort(cur, ncur, sizeof(cursor_pos), cursor_cmp);
+    cursors_clamp();
+}
+
+int cursors_count(void) {
+    return ncur;
+}
+
+const cursor_pos *cursors_list(void) {
+    return cur;
+}
+
+/* Index of the first cursor on row y or after it */
+int cursors_row_start(int y) {
+    int lo = 0, hi = ncur;
+    while (lo < hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (cur[mid].y < y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Apply one edit at cursors [i, j), which all sit on row: replace
+ * [x - back, x + fwd) at each with s */
+static int apply_row(erow *row, int i, int j, const char *s, int len, int back, int fwd) {
+    int size = row->size;
+    int removed = 0, end = 0;
+    for (int k = i; k < j; k++) {
+        int a = cur[k].x - back, b = cur[k].x + fwd;
+        if (a < end) a = end;
+        if (b > size) b = size;
+        if (b < a) b = a;
+        removed += b - a;
+        end = b;
+    }
+    if (removed == 0 && len == 0) return 0;
+
+    int new_size = size - removed + (j - i) * len;
+    char *text = row_text_alloc(new_size);
+    if (text == NULL) return -1;
+
+    /* One pass: copy the text between cursors, dropping the deleted
+     * ranges and adding s at each */
+    int src = 0, dst = 0;
+    end = 0;
+    for (int k = i; k < j; k++) {
+        int a = cur[k].x - back, b = cur[k].x + fwd;
+        if (a < end) a = end;
+        if (b > size) b = size;
+        if (b < a) b = a;
+        stats_char_move(text + dst, row->chars + src, a - src);
+        dst += a - src;
+        memcpy(text + dst, s, len);
+        dst += len;
+        cur[k].x = dst;
+        src = end = b;
+    }
+    stats_char_move(text + dst, row->chars + src, size - src);
+
+    row_text_unref(row->chars);
+    row->chars = text;
+    row->size = new_size;
+    return 1;
+}
+
+/* Replace [x - back, x + fwd) with s at every cursor, as one undo step */
+static void cursors_apply(const char *s, int len, int back, int fwd) {
+    cursors_clamp();
+    if (ncur == 0) return;
+    /* Only the rows with cursors are saved, not the ones between */
+    int *ys = editor_malloc(MEM_MISC, sizeof(int) * ncur), nys = 0;
+    if (ys == NULL) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    for (int i = 0; i < ncur; i++) {
+        if (nys == 0 || ys[nys - 1] != cur[i].y) ys[nys++] = cur[i].y;
+    }
+
+    cursors_sync();
+    int saved = undo_begin_row_set(ys, nys);
+    editor_free(MEM_MISC, ys);
+    if (saved == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+
+    int changed = 0;
+    for (int i = 0; i < ncur; ) {
+        int j = i;
+        while (j < ncur && cur[j].y == cur[i].y) j++;
+        int r = apply_row(&E.row[cur[i].y], i, j, s, len, back, fwd);
+        if (r == -1) {
+            editor_set_status("Memory allocation failed");
+            break;
+        }
+        if (r > 0) editor_row_changed(cur[i].y);
+        changed += r;
+        i = j;
+    }
+
+    cursors_dedupe();
+    cursors_sync();
+    if (changed) E.dirty++;
+}
+
+void cursors_insert(const char *s, int len) {
+    cursors_apply(s, len, 0, 0);
+}
+
+void cursors_delete(int before, int after) {
+    cursors_apply("", 0, before, after);
+}
+
+void cursors_move(int dx) {
+    cursors_clamp();
+    for (int i = 0; i < ncur; i++) {
+        int x = cur[i].x + dx;
+        if (x < 0) x = 0;
+        if (x > E.row[cur[i].y].size) x = E.row[cur[i].y].size;
+        cur[i].x = x;
+    }
+    cursors_dedupe();
+    cursors_sync();
+}
@@ -0,0 +1,427 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Gutter of lines added, changed and deleted since a base version.
+ *
+ * The base is the file as it was last read or written, held as
+ * references to the row text (so it costs no copy until a line is
+ * edited), or the file's blob at git HEAD read from `git cat-file`.
+ * The difference is kept as hunks, each a base range replaced by a
+ * range of rows; the lines between hunks are equal. An edit does not
+ * re-diff the buffer: the rows it touches and the hunks touching them
+ * become one dirty hunk, the hunks after it shift, and the next redraw
+ * diffs only the dirty hunks. Lines a dirty hunk still shares with the
+ * base are trimmed from both ends, and the rest goes through Myers'
+ * O(ND) algorithm. One that differs by more than DIFF_MAX_D lines is
+ * marked changed as a whole.
+ */
+
+#include "abczed.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+/* Most differing lines one window is diffed line by line for */
+#define DIFF_MAX_D 1000
+
+/* Base lines [b0, b1) became rows [c0, c1); a dirty hunk has not
+ * been diffed line by line yet */
+typedef struct diff_hunk {
+    int b0, b1, c0, c1;
+    int dirty;
+} diff_hunk;
+
+static struct {
+    int on;
+    int head;               /* Base is git HEAD, not the file */
+    erow *base;             /* Shared or owned row text */
+    int nbase;
+    diff_hunk *hunks;
+    int nhunks, cap;
+    int dirty;              /* Some hunk is dirty */
+} D;
+
+static void base_free(void) {
+    for (int i = 0; i < D.nbase; i++) row_text_unref(D.base[i].chars);
+    editor_free(MEM_INDEX, D.base);
+    D.base = NULL;
+    D.nbase = 0;
+}
+
+void diff_disable(void) {
+    base_free();
+    editor_free(MEM_INDEX, D.hunks);
+    memset(&D, 0, sizeof(D));
+}
+
+int diff_gutter_width(void) {
+    return D.on;
+}
+
+/* First hunk whose rows end at or after row y */
+static int hunk_after(int y) {
+    int lo = 0, hi = D.nhunks;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (D.hunks[mid].c1 < y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static int add_hunk(int at, int b0, int b1, int c0, int c1, int dirty) {
+    if (D.nhunks == D.cap) {
+        int cap = D.cap ? D.cap * 2 : 64;
+        diff_hunk *h = editor_realloc(MEM_INDEX, D.hunks, sizeof(diff_hunk) * cap);
+        if (h == NULL) return -1;
+        D.hunks = h;
+        D.cap = cap;
+    }
+    memmove(&D.hunks[at + 1], &D.hunks[at], sizeof(diff_hunk) * (D.nhunks - at));
+    D.hunks[at] = (diff_hunk){ b0, b1, c0, c1, dirty };
+    D.nhunks++;
+    return 0;
+}
+
+/* Rows [at, at+count) became n rows, or were edited in place when
+ * count == n: they and the hunks touching them become one dirty hunk */
+static void mark_dirty(int at, int count, int n) {
+    int lo = at, hi = at + count, delta = n - count;
+    int i = hunk_after(lo), j = i;
+    if (i < D.nhunks && D.hunks[i].c0 < lo) lo = D.hunks[i].c0;
+    for (; j < D.nhunks && D.hunks[j].c0 <= hi; j++) {
+        if (D.hunks[j].c1 > hi) hi = D.hunks[j].c1;
+    }
+    /* Rows outside hunks are base lines at the offset the hunk before
+     * them leaves */
+    int blo = lo + (i > 0 ? D.hunks[i - 1].b1 - D.hunks[i - 1].c1 : 0);
+    int bhi = hi + (j > 0 ? D.hunks[j - 1].b1 - D.hunks[j - 1].c1 : 0);
+    for (int k = j; k < D.nhunks; k++) {
+        D.hunks[k].c0 += delta;
+        D.hunks[k].c1 += delta;
+    }
+    if (j > i) {
+        memmove(&D.hunks[i + 1], &D.hunks[j], sizeof(diff_hunk) * (D.nhunks - j));
+        D.nhunks -= j - i - 1;
+        D.hunks[i] = (diff_hunk){ blo, bhi, lo, hi + delta, 1 };
+    } else if (add_hunk(i, blo, bhi, lo, hi + delta, 1) == -1) {
+        /* Nothing can track the edit any more */
+        diff_disable();
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    D.dirty = 1;
+}
+
+void diff_row_changed(int y) {
+    if (D.on) mark_dirty(y, 1, 1);
+}
+
+void diff_rows_replaced(int at, int count, int n) {
+    if (D.on) mark_dirty(at, count, n);
+}
+
+static int line_eq(const erow *a, const erow *b) {
+    return a->chars == b->chars || (a->size == b->size && memcmp(a->chars, b->chars, a->size) == 0);
+}
+
+static uint32_t line_hash(const erow *r) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < r->size; i++) h = (h ^ (unsigned char)r->chars[i]) * 16777619u;
+    return h;
+}
+
+/* Edits of the shortest script turning base [b0, b0+n) into rows
+ * [c0, c0+m), as hunks inserted at index at; returns how many, or -1
+ * when the lines differ too much or memory runs out */
+static int myers(int at, int b0, int n, int c0, int m) {
+    int max = n + m < DIFF_MAX_D ? n + m : DIFF_MAX_D;
+    uint32_t *ha = editor_malloc(MEM_MISC, sizeof(uint32_t) * (n + m));
+    int *v = editor_malloc(MEM_MISC, sizeof(int) * (2 * max + 3));
+    int *trace = editor_malloc(MEM_MISC, sizeof(int) * (size_t)(max + 1) * (max + 1));
+    int found = -1, added = 0;
+    if (ha == NULL || v == NULL || trace == NULL) goto done;
+    uint32_t *hb = ha + n;
+    for (int i = 0; i < n; i++) ha[i] = line_hash(&D.base[b0 + i]);
+    for (int i = 0; i < m; i++) hb[i] = line_hash(&E.row[c0 + i]);
+
+    /* v[k + off] is the furthest x reached on diagonal k = x - y */
+    int off = max + 1;
+    v[off + 1] = 0;
+    for (int d = 0; d <= max && found == -1; d++) {
+        for (int k = -d; k <= d; k += 2) {
+            int x = (k == -d || (k != d && v[off + k - 1] < v[off + k + 1])) ? v[off + k + 1] : v[off + k - 1] + 1;
+            int y = x - k;
+            while (x < n && y < m && ha[x] == hb[y] && line_eq(&D.base[b0 + x], &E.row[c0 + y])) {
+                x++;
+                y++;
+            }
+            v[off + k] = x;
+            if (x >= n && y >= m) found = d;
+        }
+        memcpy(&trace[(size_t)d * d], &v[off - d], sizeof(int) * (2 * d + 1));
+    }
+    if (found == -1) goto done;
+
+    /* Back from the end, one edit per step; hunks come out last first */
+    int x = n, y = m;
+    for (int d = found; d > 0; d--) {
+        const int *pv = &trace[(size_t)(d - 1) * (d - 1)] + (d - 1);
+        int k = x - y;
+        int pk = (k == -d || (k != d && pv[k - 1] < pv[k + 1])) ? k + 1 : k - 1;
+        int px = pv[pk], py = px - pk;
+        /* The edit goes from (px, py) to one past it in x or y */
+        int ex = pk == k + 1 ? px : px + 1, ey = pk == k + 1 ? py + 1 : py;
+        diff_hunk *h = added ? &D.hunks[at] : NULL;
+        if (h && h->b0 == b0 + ex && h->c0 == c0 + ey) {
+            h->b0 = b0 + px;
+            h->c0 = c0 + py;
+        } else if (add_hunk(at, b0 + px, b0 + ex, c0 + py, c0 + ey, 0) == -1) {
+            found = -1;
+            break;
+        } else {
+            added++;
+        }
+        x = px;
+        y = py;
+    }
+
+done:
+    editor_free(MEM_MISC, ha);
+    editor_free(MEM_MISC, v);
+    editor_free(MEM_MISC, trace);
+    if (found == -1) {
+        /* Hunks already added are dropped again */
+        memmove(&D.hunks[at], &D.hunks[at + added], sizeof(diff_hunk) * (D.nhunks - at - added));
+        D.nhunks -= added;
+        return -1;
+    }
+    return added;
+}
+
+/* Diff the dirty hunk at i line by line; returns the index after the
+ * hunks it became */
+static int diff_hunk_at(int i) {
+    diff_hunk h = D.hunks[i];
+    memmove(&D.hunks[i], &D.hunks[i + 1], sizeof(diff_hunk) * (D.nhunks - i - 1));
+    D.nhunks--;
+
+    /* Lines still shared with the base at either end */
+    while (h.c0 < h.c1 && h.b0 < h.b1 && line_eq(&D.base[h.b0], &E.row[h.c0])) {
+        h.b0++;
+        h.c0++;
+    }
+    while (h.c0 < h.c1 && h.b0 < h.b1 && line_eq(&D.base[h.b1 - 1], &E.row[h.c1 - 1])) {
+        h.b1--;
+        h.c1--;
+    }
+    if (h.c0 == h.c1 && h.b0 == h.b1) return i;
+    if (h.c0 < h.c1 && h.b0 < h.b1) {
+        int n = myers(i, h.b0, h.b1 - h.b0, h.c0, h.c1 - h.c0);
+        if (n >= 0) return i + n;
+    }
+    /* Only added or only deleted lines, too different or out of
+     * memory: changed as a whole */
+    return add_hunk(i, h.b0, h.b1, h.c0, h.c1, 0) == 0 ? i + 1 : i;
+}
+
+static void diff_update(void) {
+    if (!D.dirty) return;
+    D.dirty = 0;
+    for (int i = 0; i < D.nhunks; ) {
+        if (D.hunks[i].dirty) i = diff_hunk_at(i);
+        else i++;
+    }
+}
+
+int diff_mark(int y) {
+    if (!D.on) return ' ';
+    diff_update();
+    for (int i = hunk_after(y); i < D.nhunks && D.hunks[i].c0 <= y + 1; i++) {
+        const diff_hunk *h = &D.hunks[i];
+        if (y >= h->c0 && y < h->c1) return y - h->c0 < h->b1 - h->b0 ? '~' : '+';
+        /* Deleted lines show on the row above, or the first row */
+        if (h->c0 == h->c1 && (h->c0 == y + 1 || (h->c0 == 0 && y == 0))) return '_';
+    }
+    return ' ';
+}
+
+void diff_summary(int *added, int *changed, int *deleted) {
+    *added = *changed = *deleted = 0;
+    if (!D.on) return;
+    diff_update();
+    for (int i = 0; i < D.nhunks; i++) {
+        int nb = D.hunks[i].b1 - D.hunks[i].b0, nc = D.hunks[i].c1 - D.hunks[i].c0;
+        *changed += nb < nc ? nb : nc;
+        if (nc > nb) *added += nc - nb;
+        else *deleted += nb - nc;
+    }
+}
+
+/* Start over against the base lines in D.base: the whole buffer is
+ * one dirty hunk, which the trim mostly does away with */
+static void diff_start(int head) {
+    D.on = 1;
+    D.head = head;
+    D.nhunks = 0;
+    D.dirty = 0;
+    if (D.nbase == 0 && E.numrows == 0) return;
+    if (add_hunk(0, 0, D.nbase, 0, E.numrows, 1) == -1) {
+        diff_disable();
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    D.dirty = 1;
+}
+
+/* Base from the rows as they are, sharing their text */
+static int base_from_rows(void) {
+    base_free();
+    if (E.numrows == 0) return 0;
+    D.base = editor_malloc(MEM_INDEX, sizeof(erow) * E.numrows);
+    if (D.base == NULL) return -1;
+    for (int i = 0; i < E.numrows; i++) {
+        D.base[i].size = E.row[i].size;
+        D.base[i].chars = row_text_ref(E.row[i].chars);
+    }
+    D.nbase = E.numrows;
+    return 0;
+}
+
+/* Base from the lines of text, which is not kept */
+static int base_from_text(const char *text, size_t len) {
+    base_free();
+    int cap = 0;
+    size_t start = 0;
+    while (start < len) {
+        const char *nl = memchr(text + start, '\n', len - start);
+        size_t end = nl ? (size_t)(nl - text) : len;
+        size_t line = end - start;
+        if (line > 0 && text[end - 1] == '\r' && E.eol == EOL_CRLF) line--;
+        if (D.nbase == cap) {
+            cap = cap ? cap * 2 : 1024;
+            erow *b = editor_realloc(MEM_INDEX, D.base, sizeof(erow) * cap);
+            if (b == NULL) return -1;
+            D.base = b;
+        }
+        D.base[D.nbase].chars = row_text_new(text + start, line);
+        if (D.base[D.nbase].chars == NULL) return -1;
+        D.base[D.nbase++].size = (int)line;
+        start = end + 1;
+    }
+    return 0;
+}
+
+/* The file's blob at HEAD, from `git -C dir cat-file -p HEAD:./name`;
+ * returns its length or -1 and sets *text */
+static long read_head(char **text) {
+    const char *slash = strrchr(E.filename, '/');
+    char *dir = editor_strdup(MEM_MISC, slash ? E.filename : ".");
+    const char *name = slash ? slash + 1 : E.filename;
+    char *spec = editor_malloc(MEM_MISC, strlen(name) + 8);
+    int fds[2] = { -1, -1 };
+    long len = -1;
+    *text = NULL;
+    if (dir == NULL || spec == NULL || pipe(fds) == -1) goto done;
+    if (slash) dir[slash - E.filename + (slash == E.filename)] = '\0';
+    strcpy(spec, "HEAD:./");
+    strcat(spec, name);
+
+    pid_t pid = fork();
+    if (pid == -1) goto done;
+    if (pid == 0) {
+        /* Child: blob on the pipe, errors kept off the editor's screen */
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        int null = open("/dev/null", O_WRONLY);
+        if (null >= 0) dup2(null, STDERR_FILENO);
+        execlp("git", "git", "-C", dir, "cat-file", "-p", spec, (char *)NULL);
+        _exit(127);
+    }
+    close(fds[1]);
+    fds[1] = -1;
+    size_t cap = 0, used = 0;
+    int failed = 0;
+    for (;;) {
+        if (used == cap) {
+            cap = cap ? cap * 2 : 65536;
+            char *t = editor_realloc(MEM_MISC, *text, cap);
+            if (t == NULL) {
+                failed = 1;
+                break;
+            }
+            *text = t;
+        }
+        ssize_t n = read(fds[0], *text + used, cap - used);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        used += n;
+    }
+    close(fds[0]);
+    fds[0] = -1;
+    int status;
+    while (waitpid(pid, &status, 0) == -1 && errno == EINTR);
+    if (!failed && WIFEXITED(status) && WEXITSTATUS(status) == 0) len = (long)used;
+
+done:
+    if (fds[0] >= 0) close(fds[0]);
+    if (fds[1] >= 0) close(fds[1]);
+    editor_free(MEM_MISC, dir);
+    editor_free(MEM_MISC, spec);
+    if (len == -1) {
+        editor_free(MEM_MISC, *text);
+        *text = NULL;
+    }
+    return len;
+}
+
+int diff_enable(int head) {
+    if (!head) {
+        /* The caller makes sure the rows are the file */
+        if (base_from_rows() == -1) goto oom;
+        diff_start(0);
+        return 0;
+    }
+    if (E.filename == NULL) {
+        editor_set_status("Error: No filename");
+        return -1;
+    }
+    char *text;
+    long len = read_head(&text);
+    if (len == -1) {
+        editor_set_status("Error: %s is not in git HEAD", E.filename);
+        return -1;
+    }
+    int r = base_from_text(text, (size_t)len);
+    editor_free(MEM_MISC, text);
+    if (r == -1) goto oom;
+    diff_start(1);
+    return 0;
+
+oom:
+    diff_disable();
+    editor_set_status("Memory allocation failed");
+    return -1;
+}
+
+int diff_head(void) {
+    return D.on && D.head;
+}
+
+void diff_saved(void) {
+    /* The rows are the file on disk now */
+    if (!D.on || D.head) return;
+    if (base_from_rows() == -1) {
+        diff_disable();
+        return;
+    }
+    diff_start(0);
+}
@@ -0,0 +1,129 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Global editor state.
+ */
+
+#include "abczed.h"
+#include "clipboard.h"
+#include "input.h"
+#include "stats.h"
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+editor_config E;
+
+/* Initialize the editor state (the front end sets the screen size) */
+void init_editor() {
+    /* Clear all memory first */
+    memset(&E, 0, sizeof(E));
+    
+    /* Initialize cursor and screen positions */
+    E.cx = 0;
+    E.cy = 0;
+    E.rowoff = 0;
+    E.coloff = 0;
+    E.mode = MODE_NORMAL;
+    
+    /* Initialize rows */
+    E.numrows = 0;
+    E.row = NULL;
+    E.filename = NULL;
+    E.eol = EOL_LF;
+    E.encoding = ENC_UTF8;
+    E.bom = 0;
+    E.noeol = 0;
+    E.compression = COMP_NONE;
+    E.statusmsg[0] = '\0';
+    E.dirty = 0;
+    
+    /* Initialize command buffer */
+    E.commandbuf[0] = '\0';
+    E.commandlen = 0;
+    
+    /* Initialize selection */
+    E.sel_start_x = E.sel_start_y = -1;
+    E.sel_end_x = E.sel_end_y = -1;
+    E.selecting = 0;
+    
+    /* Initialize display options */
+    E.show_line_numbers = 0;  /* Line numbers off by default */
+    
+    
+    /* Initialize font size (3 = normal) */
+    E.font_size = 3;
+    
+    /* Minimum screen dimensions until the front end reports its size */
+    E.screenrows = 3;
+    E.screencols = 20;
+}
+
+/* Free all memory owned by the editor state */
+void editor_free_state() {
+    /* Free all memory */
+    if (E.row) {
+        for (int i = 0; i < E.numrows; i++) {
+            row_text_unref(E.row[i].chars);
+            E.row[i].chars = NULL;  /* Prevent double-free issues */
+        }
+        editor_free(MEM_ROW_ARRAY, E.row);
+        E.row = NULL; /* Prevent double-free issues */
+    }
+    E.numrows = 0;
+    hex_close();
+    csv_disable();
+    diff_disable();
+    brackets_free();
+    folds_free();
+    editor_selection_clear();
+    marks_free();
+    anchors_free();
+    
+    /* Drop extra cursors and macros */
+    cursors_clear();
+    macros_free();
+    editor_input_free();
+    
+    /* Free registers, after any clipboard export still holding one */
+    clipboard_free();
+    registers_free();
+    
+    /* Free undo/redo stacks */
+    free_operations_stack(E.undo_stack);
+    E.undo_stack = NULL;
+    
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+    
+    /* Free filename */
+    if (E.filename) {
+        editor_free(MEM_MISC, E.filename);
+        E.filename = NULL;
+    }
+}
+
+/* Set the status message shown on the command line */
+void editor_set_status(const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(E.statusmsg, sizeof(E.statusmsg), fmt, ap);
+    va_end(ap);
+    E.statusmsg_time = time(NULL);
+}
+
+/* Change font size */
+void editor_change_font_size(int delta) {
+    E.font_size += delta;
+    if (E.font_size < 1) E.font_size = 1;
+    if (E.font_size > 5) E.font_size = 5;
+    
+    editor_set_status("Font size: %d", E.font_size);
+    
+    /* Note: ncurses doesn't actually support font size change,
+       this is more of a placeholder for graphical terminals */
+}
+
@@ -0,0 +1,219 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Detecting, decoding and encoding file encodings.
+ */
+
+#include "abczed.h"
+#include "encoding.h"
+
+#include <string.h>
+
+/* Bytes looked at to guess an encoding without a byte order mark */
+#define DETECT_SAMPLE 4096
+
+static const char *names[] = { "utf-8", "utf-16le", "utf-16be", "latin1" };
+
+const char *encoding_name(int enc) {
+    return enc >= 0 && enc < (int)(sizeof(names) / sizeof(names[0])) ? names[enc] : "?";
+}
+
+int encoding_from_name(const char *name) {
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) return i;
+    }
+    if (strcmp(name, "utf8") == 0) return ENC_UTF8;
+    if (strcmp(name, "latin-1") == 0 || strcmp(name, "iso-8859-1") == 0) return ENC_LATIN1;
+    return -1;
+}
+
+/* Length of the valid UTF-8 sequence at s[0..len), 0 if it is invalid,
+ * or -1 if it is cut off by the end */
+static int utf8_seq(const unsigned char *s, size_t len) {
+    unsigned char c = s[0];
+    int n;
+    if (c < 0x80) return 1;
+    else if (c >= 0xc2 && c <= 0xdf) n = 2;
+    else if (c >= 0xe0 && c <= 0xef) n = 3;
+    else if (c >= 0xf0 && c <= 0xf4) n = 4;
+    else return 0;
+    for (int i = 1; i < n; i++) {
+        if ((size_t)i >= len) return -1;
+        if ((s[i] & 0xc0) != 0x80) return 0;
+    }
+    /* Overlong forms, surrogates and code points past U+10FFFF */
+    if (n == 3 && ((c == 0xe0 && s[1] < 0xa0) || (c == 0xed && s[1] >= 0xa0))) return 0;
+    if (n == 4 && ((c == 0xf0 && s[1] < 0x90) || (c == 0xf4 && s[1] >= 0x90))) return 0;
+    return n;
+}
+
+int encoding_detect(const unsigned char *buf, size_t len, int *bom_len) {
+    *bom_len = 0;
+    if (len >= 3 && buf[0] == 0xef && buf[1] == 0xbb && buf[2] == 0xbf) {
+        *bom_len = 3;
+        return ENC_UTF8;
+    }
+    if (len >= 2 && buf[0] == 0xff && buf[1] == 0xfe) {
+        *bom_len = 2;
+        return ENC_UTF16LE;
+    }
+    if (len >= 2 && buf[0] == 0xfe && buf[1] == 0xff) {
+        *bom_len = 2;
+        return ENC_UTF16BE;
+    }
+
+    size_t n = len < DETECT_SAMPLE ? len : DETECT_SAMPLE;
+
+    /* Mostly-ASCII UTF-16 has a zero in every other byte */
+    size_t zero_even = 0, zero_odd = 0;
+    for (size_t i = 0; i + 1 < n; i += 2) {
+        zero_even += buf[i] == 0;
+        zero_odd += buf[i + 1] == 0;
+    }
+    size_t pairs = n / 2;
+    if (pairs > 0 && zero_odd > pairs / 2 && zero_even == 0) return ENC_UTF16LE;
+    if (pairs > 0 && zero_even > pairs / 2 && zero_odd == 0) return ENC_UTF16BE;
+
+    for (size_t i = 0; i < n; ) {
+        int k = utf8_seq(buf + i, n - i);
+        if (k == 0) return ENC_LATIN1;
+        if (k < 0) break;
+        i += k;
+    }
+    return ENC_UTF8;
+}
+
+size_t encoding_bom(int enc, unsigned char *out) {
+    switch (enc) {
+        case ENC_UTF8:    memcpy(out, "\xef\xbb\xbf", 3); return 3;
+        case ENC_UTF16LE: memcpy(out, "\xff\xfe", 2); return 2;
+        case ENC_UTF16BE: memcpy(out, "\xfe\xff", 2); return 2;
+        default:          return 0;
+    }
+}
+
+static size_t put_utf8(char *out, unsigned int cp) {
+    if (cp < 0x80) {
+        out[0] = (char)cp;
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = (char)(0xc0 | cp >> 6);
+        out[1] = (char)(0x80 | (cp & 0x3f));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = (char)(0xe0 | cp >> 12);
+        out[1] = (char)(0x80 | (cp >> 6 & 0x3f));
+        out[2] = (char)(0x80 | (cp & 0x3f));
+        return 3;
+    }
+    out[0] = (char)(0xf0 | cp >> 18);
+    out[1] = (char)(0x80 | (cp >> 12 & 0x3f));
+    out[2] = (char)(0x80 | (cp >> 6 & 0x3f));
+    out[3] = (char)(0x80 | (cp & 0x3f));
+    return 4;
+}
+
+void decoder_init(text_decoder *d, int enc) {
+    memset(d, 0, sizeof(*d));
+    d->encoding = enc;
+}
+
+/* One UTF-16 code unit */
+static size_t decode_unit(text_decoder *d, unsigned int u, char *out) {
+    size_t n = 0;
+    if (d->high) {
+        if (u >= 0xdc00 && u <= 0xdfff) {
+            unsigned int cp = 0x10000 + ((d->high - 0xd800) << 10) + (u - 0xdc00);
+            d->high = 0;
+            return put_utf8(out, cp);
+        }
+        /* A high surrogate with no pair */
+        n = put_utf8(out, 0xfffd);
+        d->high = 0;
+    }
+    if (u >= 0xd800 && u <= 0xdbff) {
+        d->high = u;
+        return n;
+    }
+    if (u >= 0xdc00 && u <= 0xdfff) u = 0xfffd;
+    return n + put_utf8(out + n, u);
+}
+
+size_t decoder_run(text_decoder *d, const unsigned char *in, size_t len, char *out) {
+    size_t o = 0;
+    if (d->encoding == ENC_LATIN1) {
+        for (size_t i = 0; i < len; i++) o += put_utf8(out + o, in[i]);
+        return o;
+    }
+    if (d->encoding != ENC_UTF16LE && d->encoding != ENC_UTF16BE) {
+        memcpy(out, in, len);
+        return len;
+    }
+
+    int le = d->encoding == ENC_UTF16LE;
+    size_t i = 0;
+    if (d->npending == 1 && len > 0) {
+        unsigned char a = d->pending[0], b = in[i++];
+        o += decode_unit(d, le ? (unsigned)(a | b << 8) : (unsigned)(a << 8 | b), out + o);
+        d->npending = 0;
+    }
+    for (; i + 1 < len; i += 2) {
+        unsigned int u = le ? (unsigned)(in[i] | in[i + 1] << 8) : (unsigned)(in[i] << 8 | in[i + 1]);
+        o += decode_unit(d, u, out + o);
+    }
+    if (i < len) {
+        d->pending[0] = in[i];
+        d->npending = 1;
+    }
+    return o;
+}
+
+size_t encoder_run(int enc, const char *in, size_t len, unsigned char *out, long *lossy) {
+    const unsigned char *s = (const unsigned char *)in;
+    size_t o = 0;
+    if (enc != ENC_LATIN1 && enc != ENC_UTF16LE && enc != ENC_UTF16BE) {
+        memcpy(out, in, len);
+        return len;
+    }
+
+    int le = enc == ENC_UTF16LE;
+    for (size_t i = 0; i < len; ) {
+        int k = utf8_seq(s + i, len - i);
+        unsigned int cp;
+        if (k <= 0) {
+            cp = '?';
+            (*lossy)++;
+            k = 1;
+        } else if (k == 1) {
+            cp = s[i];
+        } else {
+            cp = s[i] & (0x7f >> k);
+            for (int j = 1; j < k; j++) cp = cp << 6 | (s[i + j] & 0x3f);
+        }
+        i += k;
+
+        if (enc == ENC_LATIN1) {
+            if (cp > 0xff) {
+                cp = '?';
+                (*lossy)++;
+            }
+            out[o++] = (unsigned char)cp;
+            continue;
+        }
+        unsigned int units[2] = { cp, 0 };
+        int nunits = 1;
+        if (cp >= 0x10000) {
+            units[0] = 0xd800 + ((cp - 0x10000) >> 10);
+            units[1] = 0xdc00 + ((cp - 0x10000) & 0x3ff);
+            nunits = 2;
+        }
+        for (int u = 0; u < nunits; u++) {
+            out[o++] = (unsigned char)(le ? units[u] & 0xff : units[u] >> 8);
+            out[o++] = (unsigned char)(le ? units[u] >> 8 : units[u] & 0xff);
+        }
+    }
+    return o;
+}
@@ -0,0 +1,51 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Text encodings of files on disk.
+ *
+ * Rows always hold UTF-8. A file's encoding is guessed from its first
+ * bytes when it is opened: a byte order mark, the zero bytes of UTF-16
+ * text without one, or bytes that are not valid UTF-8 (taken as
+ * Latin-1). Files are decoded chunk by chunk as they are read and rows
+ * encoded one at a time as they are written, so neither side holds a
+ * second copy of the file. UTF-8 files skip both steps.
+ */
+
+#ifndef ABCZED_ENCODING_H
+#define ABCZED_ENCODING_H
+
+#include <stddef.h>
+
+/* Incremental decoder to UTF-8; bytes of a character split between two
+ * chunks are carried over to the next call */
+typedef struct text_decoder {
+    int encoding;
+    unsigned char pending[2];
+    int npending;
+    unsigned int high;          /* UTF-16 high surrogate waiting for its pair */
+} text_decoder;
+
+/* The encoding of a file starting with buf[0..len), and the length of
+ * its byte order mark (0 if none) */
+int encoding_detect(const unsigned char *buf, size_t len, int *bom_len);
+
+/* Bytes of the byte order mark for enc */
+size_t encoding_bom(int enc, unsigned char *out);
+
+/* Decode in[0..len) into out, which must hold ENCODING_DECODE_MAX(len)
+ * bytes; returns the number of bytes written */
+#define ENCODING_DECODE_MAX(len) (2 * (len) + 8)
+void decoder_init(text_decoder *d, int enc);
+size_t decoder_run(text_decoder *d, const unsigned char *in, size_t len, char *out);
+
+/* Encode UTF-8 in[0..len) into out, which must hold
+ * ENCODING_ENCODE_MAX(len) bytes; characters enc cannot hold become '?'
+ * and are counted in *lossy */
+#define ENCODING_ENCODE_MAX(len) (2 * (len) + 4)
+size_t encoder_run(int enc, const char *in, size_t len, unsigned char *out, long *lossy);
+
+const char *encoding_name(int enc);
+int encoding_from_name(const char *name);
+
+#endif /* ABCZED_ENCODING_H */
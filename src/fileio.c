@@ -0,0 +1,338 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Loading and saving files.
+ *
+ * Files are read in chunks and split into rows as they arrive; lines
+ * that fit in a chunk go straight from the read buffer into row text.
+ * The line ending is taken from the first line (LF, CRLF or a lone CR)
+ * and the encoding from the first bytes, and both are kept so the file
+ * is saved the way it was read. Files in other encodings than UTF-8 are
+ * decoded chunk by chunk on the way in and encoded row by row on the way
+ * out. In an LF file a CR before a line break stays in the text, so
+ * files with mixed line endings are written back unchanged.
+ *
+ * Compressed files are decompressed between the read and the decoding,
+ * chunk by chunk, and saved compressed the same way (compress.c).
+ */
+
+#include "abczed.h"
+#include "compress.h"
+#include "encoding.h"
+#include "stats.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+/* Bytes read from the file at a time */
+#define READ_CHUNK (64 * 1024)
+
+/* Lines being split out of the decoded text */
+typedef struct line_splitter {
+    char *carry;            /* Start of a line cut off by the chunk's end */
+    size_t len, cap;
+    int eol_known;
+    long bare_lf;           /* Lines of a CRLF file ending in LF alone */
+    int row_cap;            /* Rows allocated in E.row */
+} line_splitter;
+
+static int add_row(line_splitter *ls, const char *s, size_t len) {
+    if (E.eol == EOL_CRLF) {
+        if (len > 0 && s[len - 1] == '\r') len--;
+        else ls->bare_lf++;
+    }
+    return editor_load_row(s, len, &ls->row_cap);
+}
+
+static int carry_add(line_splitter *ls, const char *s, size_t len) {
+    if (ls->len + len > ls->cap) {
+        size_t cap = ls->cap ? ls->cap : 256;
+        while (cap < ls->len + len) cap *= 2;
+        char *b = editor_realloc(MEM_MISC, ls->carry, cap);
+        if (b == NULL) return -1;
+        ls->carry = b;
+        ls->cap = cap;
+    }
+    memcpy(ls->carry + ls->len, s, len);
+    ls->len += len;
+    return 0;
+}
+
+/* Take the line ending from the first line break; a CR that ends the
+ * text seen so far waits for the next chunk, or the end of the file */
+static void detect_eol(line_splitter *ls, const char *s, size_t len, int last) {
+    if (ls->len > 0 && ls->carry[ls->len - 1] == '\r') {
+        if (len == 0 && !last) return;
+        E.eol = (len > 0 && s[0] == '\n') ? EOL_CRLF : EOL_CR;
+        ls->eol_known = 1;
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (s[i] == '\n') {
+            E.eol = EOL_LF;
+            ls->eol_known = 1;
+            return;
+        }
+        if (s[i] == '\r') {
+            if (i + 1 == len && !last) return;
+            E.eol = (i + 1 < len && s[i + 1] == '\n') ? EOL_CRLF : EOL_CR;
+            ls->eol_known = 1;
+            return;
+        }
+    }
+    if (last) ls->eol_known = 1;
+}
+
+/* Split text into rows; the unfinished last line is carried over */
+static int split_lines(line_splitter *ls, const char *s, size_t len) {
+    char brk = E.eol == EOL_CR ? '\r' : '\n';
+    const char *p = s, *end = s + len;
+    while (p < end) {
+        const char *nl = memchr(p, brk, end - p);
+        if (nl == NULL) return carry_add(ls, p, end - p);
+        if (ls->len > 0) {
+            if (carry_add(ls, p, nl - p) == -1 || add_row(ls, ls->carry, ls->len) == -1) return -1;
+            ls->len = 0;
+        } else if (add_row(ls, p, nl - p) == -1) {
+            return -1;
+        }
+        p = nl + 1;
+    }
+    return 0;
+}
+
+/* Returns 0 on success (including a new, not yet existing file) and -1 on
+ * allocation failure; the core never exits the process on its own. */
+int editor_open(char *filename) {
+    /* filename may be E.filename itself */
+    char *name = editor_strdup(MEM_MISC, filename);
+    if (!name) {
+        editor_set_status("Error: Out of memory");
+        return -1;
+    }
+    hex_close();
+    csv_disable();
+    diff_disable();
+    editor_free(MEM_MISC, E.filename);
+    E.filename = name;
+    E.eol = EOL_LF;
+    E.encoding = ENC_UTF8;
+    E.bom = 0;
+    E.noeol = 0;
+    E.compression = COMP_NONE;
+
+    FILE *fp = fopen(E.filename, "r");
+    if (!fp) {
+        /* New file; foo.gz is saved compressed */
+        int kind = compress_from_filename(E.filename);
+        if (compress_available(kind)) E.compression = kind;
+        if (csv_from_filename(E.filename)) csv_enable(csv_from_filename(E.filename));
+        return 0;
+    }
+    uint64_t start = stats_now();
+    /* Rebuilt once on the next lookup rather than row by row */
+    brackets_free();
+
+    unsigned char *in = editor_malloc(MEM_MISC, READ_CHUNK);
+    char *text = NULL;
+    line_splitter ls = { NULL, 0, 0, 0, 0, E.numrows };
+    int first_row = E.numrows;
+    text_decoder dec;
+    compress_stream *cs = NULL;
+    int failed = in == NULL;
+    int first = 1, ended_with_break = 0, unsupported = COMP_NONE, corrupt = 0;
+    size_t n = failed ? 0 : fread(in, 1, READ_CHUNK, fp);
+
+    /* A compressed file is read through its decompressor from here on;
+     * one this build cannot read is loaded as it is */
+    int kind = compress_detect(in, n);
+    if (kind != COMP_NONE && !compress_available(kind)) {
+        unsupported = kind;
+    } else if (kind != COMP_NONE) {
+        cs = compress_reader(fp, kind, in, n);
+        failed = cs == NULL;
+        E.compression = kind;
+        n = failed ? 0 : compress_read(cs, in, READ_CHUNK);
+    }
+
+    for (; !failed && n > 0; n = cs ? compress_read(cs, in, READ_CHUNK) : fread(in, 1, READ_CHUNK, fp)) {
+        S.open_bytes += n;
+        size_t skip = 0;
+        if (first) {
+            int bom;
+            E.encoding = encoding_detect(in, n, &bom);
+            E.bom = bom > 0;
+            skip = bom;
+            decoder_init(&dec, E.encoding);
+            if (E.encoding != ENC_UTF8) {
+                text = editor_malloc(MEM_MISC, ENCODING_DECODE_MAX(READ_CHUNK));
+                if (text == NULL) {
+                    failed = 1;
+                    break;
+                }
+            }
+            first = 0;
+        }
+
+        /* UTF-8 is split in place; others are decoded first */
+        const char *p = (const char *)in + skip;
+        size_t len = n - skip;
+        if (text != NULL) {
+            len = decoder_run(&dec, in + skip, len, text);
+            p = text;
+        }
+        if (len == 0) continue;
+
+        /* Lines before the first break wait until it is known */
+        if (!ls.eol_known) detect_eol(&ls, p, len, 0);
+        if (!ls.eol_known) {
+            failed = carry_add(&ls, p, len) == -1;
+            continue;
+        }
+        failed = split_lines(&ls, p, len) == -1;
+        ended_with_break = p[len - 1] == (E.eol == EOL_CR ? '\r' : '\n');
+    }
+
+    if (!failed && !ls.eol_known) {
+        /* The file has at most a CR at its end for a break */
+        detect_eol(&ls, "", 0, 1);
+        if (E.eol == EOL_CR) {
+            ls.len--;
+            failed = add_row(&ls, ls.carry, ls.len) == -1;
+            ls.len = 0;
+            ended_with_break = 1;
+        }
+    }
+    /* A last line with no break of its own */
+    if (!failed && ls.len > 0) {
+        failed = add_row(&ls, ls.carry, ls.len) == -1;
+        if (E.eol == EOL_CRLF && !failed && ls.carry[ls.len - 1] != '\r') ls.bare_lf--;
+    }
+    E.noeol = E.numrows > 0 && !ended_with_break;
+    editor_rows_loaded(first_row);
+
+    if (cs != NULL) corrupt = compress_close(cs) == -1;
+    editor_free(MEM_MISC, ls.carry);
+    editor_free(MEM_MISC, text);
+    editor_free(MEM_MISC, in);
+    fclose(fp);
+    stats_timer_add(&S.open, start);
+    E.dirty = 0;
+
+    /* Clear undo/redo stacks when opening a file */
+    free_operations_stack(E.undo_stack);
+    E.undo_stack = NULL;
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+    if (failed) {
+        editor_set_status("Error: Out of memory");
+        return -1;
+    }
+    if (ls.bare_lf > 0) {
+        editor_set_status("%ld lines end in LF alone; they will be saved with CRLF", ls.bare_lf);
+    }
+    if (unsupported != COMP_NONE) {
+        editor_set_status("Warning: %s support not built in; opened the compressed bytes as they are",
+                          compress_name(unsupported));
+    } else if (corrupt) {
+        editor_set_status("Warning: compressed data is corrupt or cut off; %d lines read", E.numrows);
+    }
+    if (csv_from_filename(E.filename)) csv_enable(csv_from_filename(E.filename));
+    return 0;
+}
+
+static const char *eol_text(enum file_eol eol) {
+    return eol == EOL_CRLF ? "\r\n" : eol == EOL_CR ? "\r" : "\n";
+}
+
+/* Write to the file, or through its compressor when it has one */
+static int write_out(FILE *fp, compress_stream *cs, const void *s, size_t len) {
+    S.save_bytes += len;
+    if (cs != NULL) return compress_write(cs, s, len);
+    return fwrite(s, 1, len, fp) == len ? 0 : -1;
+}
+
+/* Write s in the file's encoding through the scratch buffer *buf */
+static int write_encoded(FILE *fp, compress_stream *cs, const char *s, size_t len,
+                         unsigned char **buf, size_t *cap, long *lossy) {
+    if (E.encoding == ENC_UTF8) return write_out(fp, cs, s, len);
+    size_t need = ENCODING_ENCODE_MAX(len);
+    if (need > *cap) {
+        unsigned char *b = editor_realloc(MEM_MISC, *buf, need);
+        if (b == NULL) return -1;
+        *buf = b;
+        *cap = need;
+    }
+    size_t n = encoder_run(E.encoding, s, len, *buf, lossy);
+    return write_out(fp, cs, *buf, n);
+}
+
+/* Save the current file */
+int editor_save() {
+    if (E.filename == NULL) {
+        editor_set_status("Error: No filename");
+        return -1;
+    }
+    if (hex_state()) return hex_save();
+    if (!compress_available(E.compression)) {
+        editor_set_status("Can't save! %s support not built in", compress_name(E.compression));
+        return -1;
+    }
+
+    FILE *fp = fopen(E.filename, "w");
+    if (!fp) {
+        editor_set_status("Can't save! I/O error: %s", strerror(errno));
+        return -1;
+    }
+
+    uint64_t start = stats_now();
+    unsigned char *buf = NULL;
+    size_t cap = 0;
+    long lossy = 0;
+    int err = 0;
+    const char *eol = eol_text(E.eol);
+    size_t eol_len = strlen(eol);
+    compress_stream *cs = NULL;
+
+    if (E.compression != COMP_NONE) {
+        cs = compress_writer(fp, E.compression);
+        if (cs == NULL) {
+            fclose(fp);
+            editor_set_status("Can't save! Out of memory");
+            return -1;
+        }
+    }
+    if (E.bom) {
+        unsigned char bom[4];
+        size_t n = encoding_bom(E.encoding, bom);
+        err = write_out(fp, cs, bom, n) == -1;
+    }
+    for (int i = 0; i < E.numrows && !err; i++) {
+        err = write_encoded(fp, cs, E.row[i].chars, E.row[i].size, &buf, &cap, &lossy) == -1;
+        if (!err && !(E.noeol && i == E.numrows - 1)) {
+            err = write_encoded(fp, cs, eol, eol_len, &buf, &cap, &lossy) == -1;
+        }
+    }
+    editor_free(MEM_MISC, buf);
+    if (cs != NULL && compress_close(cs) == -1) err = 1;
+
+    if (fclose(fp) != 0) err = 1;
+    stats_timer_add(&S.save, start);
+    if (err) {
+        editor_set_status("Can't save! I/O error: %s", strerror(errno));
+        return -1;
+    }
+    E.dirty = 0;
+    diff_saved();
+    if (lossy > 0) {
+        editor_set_status("%d lines written to %s; %ld characters not in %s written as ?",
+                          E.numrows, E.filename, lossy, encoding_name(E.encoding));
+    } else {
+        editor_set_status("%d lines written to %s", E.numrows, E.filename);
+    }
+    return 0;
+}
@@ -0,0 +1,419 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Folds.
+ *
+ * Folds are line ranges kept sorted by first line, outer folds before
+ * the ones nested in them, with an implicit interval tree over that
+ * order: each node holds the largest last line below it, so the folds
+ * around a line are found in O(log n) without visiting the others. Folds
+ * nest but never partly overlap.
+ *
+ * The rows hidden by closed folds are kept as a sorted list of runs, each
+ * with the number of rows hidden before it. That prefix count maps a
+ * buffer row to its screen row and back by binary search, which is what
+ * drawing, scrolling and j/k use. Tree and runs are rebuilt only after
+ * the folds change, so moving through thousands of folds costs O(log n)
+ * per line.
+ */
+
+#include "abczed.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct fold {
+    int start, end;     /* First and last line */
+    int closed;
+} fold;
+
+/* Rows first..last hidden by the closed fold shown on line first - 1 */
+typedef struct hidden_run {
+    int first, last;
+    int before;         /* Rows hidden by the runs before this one */
+    int fold;           /* Index of that fold */
+} hidden_run;
+
+static struct {
+    fold *folds;
+    int nfolds, cap;
+    int stale;          /* Folds changed since the tree and runs were built */
+    int *max_end;       /* Interval tree; max_end[1] is the root */
+    int leaves;
+    hidden_run *runs;
+    int nruns;
+    int hidden;         /* Rows hidden in all */
+} F;
+
+void folds_free(void) {
+    editor_free(MEM_INDEX, F.folds);
+    editor_free(MEM_INDEX, F.max_end);
+    editor_free(MEM_INDEX, F.runs);
+    memset(&F, 0, sizeof(F));
+}
+
+static int fold_cmp(const void *a, const void *b) {
+    const fold *x = a, *y = b;
+    if (x->start != y->start) return x->start < y->start ? -1 : 1;
+    return x->end > y->end ? -1 : x->end < y->end;
+}
+
+/* Shorten folds that partly overlap a later one, which edits joining
+ * lines can leave behind, then drop empty and repeated folds */
+static int folds_tidy(void) {
+    int *stack = editor_malloc(MEM_INDEX, sizeof(int) * (F.nfolds > 0 ? F.nfolds : 1));
+    if (stack == NULL) return -1;
+    int depth = 0;
+    for (int i = 0; i < F.nfolds; i++) {
+        fold *f = &F.folds[i];
+        if (f->end <= f->start) continue;
+        while (depth > 0) {
+            fold *top = &F.folds[stack[depth - 1]];
+            if (top->end >= f->end) break;
+            if (top->end >= f->start) top->end = f->start - 1;
+            depth--;
+        }
+        stack[depth++] = i;
+    }
+    editor_free(MEM_INDEX, stack);
+
+    int n = 0;
+    for (int i = 0; i < F.nfolds; i++) {
+        fold *f = &F.folds[i];
+        if (f->end <= f->start) continue;
+        if (n > 0 && F.folds[n - 1].start == f->start && F.folds[n - 1].end == f->end) continue;
+        F.folds[n++] = *f;
+    }
+    F.nfolds = n;
+    return 0;
+}
+
+static int folds_build(void) {
+    if (folds_tidy() == -1) return -1;
+
+    int leaves = 1;
+    while (leaves < F.nfolds) leaves *= 2;
+    int *t = editor_realloc(MEM_INDEX, F.max_end, sizeof(int) * 2 * leaves);
+    if (t == NULL) return -1;
+    F.max_end = t;
+    F.leaves = leaves;
+    for (int i = 0; i < leaves; i++) t[leaves + i] = i < F.nfolds ? F.folds[i].end : -1;
+    for (int n = leaves - 1; n > 0; n--) t[n] = t[2 * n] > t[2 * n + 1] ? t[2 * n] : t[2 * n + 1];
+
+    /* Outermost closed folds; the ones inside them are hidden anyway */
+    int closed = 0;
+    for (int i = 0; i < F.nfolds; i++) closed += F.folds[i].closed;
+    hidden_run *r = editor_realloc(MEM_INDEX, F.runs, sizeof(hidden_run) * (closed > 0 ? closed : 1));
+    if (r == NULL) return -1;
+    F.runs = r;
+    F.nruns = 0;
+    F.hidden = 0;
+    int cover = -1;
+    for (int i = 0; i < F.nfolds; i++) {
+        const fold *f = &F.folds[i];
+        if (!f->closed || f->start <= cover) continue;
+        r[F.nruns].first = f->start + 1;
+        r[F.nruns].last = f->end;
+        r[F.nruns].before = F.hidden;
+        r[F.nruns].fold = i;
+        F.nruns++;
+        F.hidden += f->end - f->start;
+        cover = f->end;
+    }
+    return 0;
+}
+
+/* Bring the tree and runs up to date; without memory for them, drop
+ * the folds and show every line */
+static void folds_ready(void) {
+    if (!F.stale) return;
+    F.stale = 0;
+    if (folds_build() == -1) {
+        folds_free();
+        editor_set_status("Memory allocation failed, folds dropped");
+    }
+}
+
+/* Number of folds starting at or before line y */
+static int folds_upto(int y) {
+    int lo = 0, hi = F.nfolds;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (F.folds[mid].start <= y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+/* Last fold before index k that reaches line y, or -1 */
+static int last_reaching(int n, int lo, int hi, int k, int y) {
+    if (lo >= k || F.max_end[n] < y) return -1;
+    if (hi - lo == 1) return lo;
+    int mid = (lo + hi) / 2;
+    int r = last_reaching(2 * n + 1, mid, hi, k, y);
+    return r >= 0 ? r : last_reaching(2 * n, lo, mid, k, y);
+}
+
+/* Innermost fold containing line y, or -1 */
+static int fold_innermost(int y) {
+    if (F.nfolds == 0) return -1;
+    return last_reaching(1, 0, F.leaves, folds_upto(y), y);
+}
+
+/* The fold around fold i, or -1 */
+static int fold_parent(int i) {
+    return last_reaching(1, 0, F.leaves, i, F.folds[i].end);
+}
+
+/* Run hiding y, or shown on line y, or -1 */
+static int run_at(int y) {
+    int lo = 0, hi = F.nruns;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (F.runs[mid].first - 1 <= y) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo > 0 && y <= F.runs[lo - 1].last ? lo - 1 : -1;
+}
+
+int fold_line(int y) {
+    folds_ready();
+    int r = run_at(y);
+    return r >= 0 ? F.runs[r].first - 1 : y;
+}
+
+int fold_closed_end(int y) {
+    folds_ready();
+    int r = run_at(y);
+    return r >= 0 && F.runs[r].first - 1 == y ? F.runs[r].last : -1;
+}
+
+int folds_visible(int y) {
+    folds_ready();
+    int lo = 0, hi = F.nruns;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (F.runs[mid].first <= y) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return y;
+    const hidden_run *r = &F.runs[lo - 1];
+    if (y <= r->last) return r->first - 1 - r->before;
+    return y - r->before - (r->last - r->first + 1);
+}
+
+int folds_row(int v) {
+    folds_ready();
+    /* The runs before row v's are those whose fold line is above it */
+    int lo = 0, hi = F.nruns;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (F.runs[mid].first - F.runs[mid].before <= v) lo = mid + 1;
+        else hi = mid;
+    }
+    if (lo == 0) return v;
+    const hidden_run *r = &F.runs[lo - 1];
+    return v + r->before + (r->last - r->first + 1);
+}
+
+int folds_visible_count(void) {
+    folds_ready();
+    return E.numrows - F.hidden;
+}
+
+void folds_rows_replaced(int at, int count, int n) {
+    if (F.nfolds == 0 || count == n) return;
+    for (int i = 0; i < F.nfolds; i++) {
+        fold *f = &F.folds[i];
+        if (f->end < at) continue;
+        f->start = row_map(f->start, at, count, n, 0);
+        f->end = row_map(f->end, at, count, n, 1);
+    }
+    F.stale = 1;
+}
+
+int fold_create(int y0, int y1) {
+    if (y1 <= y0) {
+        editor_set_status("A fold needs two lines or more");
+        return -1;
+    }
+    folds_ready();
+    for (int i = 0; i < F.nfolds; i++) {
+        const fold *f = &F.folds[i];
+        if ((f->start < y0 && f->end >= y0 && f->end < y1) ||
+            (f->start > y0 && f->start <= y1 && f->end > y1)) {
+            editor_set_status("Folds cannot partly overlap");
+            return -1;
+        }
+    }
+
+    fold nf = { y0, y1, 1 };
+    int at = 0;
+    while (at < F.nfolds && fold_cmp(&F.folds[at], &nf) < 0) at++;
+    if (at < F.nfolds && fold_cmp(&F.folds[at], &nf) == 0) {
+        F.folds[at].closed = 1;
+    } else {
+        if (F.nfolds == F.cap) {
+            int cap = F.cap ? F.cap * 2 : 16;
+            fold *f = editor_realloc(MEM_INDEX, F.folds, sizeof(fold) * cap);
+            if (f == NULL) {
+                editor_set_status("Memory allocation failed");
+                return -1;
+            }
+            F.folds = f;
+            F.cap = cap;
+        }
+        memmove(&F.folds[at + 1], &F.folds[at], sizeof(fold) * (F.nfolds - at));
+        F.folds[at] = nf;
+        F.nfolds++;
+    }
+    F.stale = 1;
+    return 0;
+}
+
+/* zo, zc, za, zd, zE, zR and zM on line y; -1 if the key is none of
+ * them or there is no fold to act on */
+int fold_command(int key, int y) {
+    folds_ready();
+    int r = run_at(y);
+    int shown = r >= 0 ? F.runs[r].fold : -1;   /* Closed fold shown at y */
+    int i = shown >= 0 ? shown : fold_innermost(y);
+
+    switch (key) {
+        case 'R':
+        case 'M':
+            for (int j = 0; j < F.nfolds; j++) F.folds[j].closed = key == 'M';
+            break;
+        case 'E':
+            F.nfolds = 0;
+            break;
+        case 'o':
+        case 'c':
+        case 'a':
+        case 'd':
+            /* zc on a closed fold closes the one around it */
+            if (key == 'c' && shown >= 0) i = fold_parent(shown);
+            if (i < 0) {
+                editor_set_status("No fold found");
+                return -1;
+            }
+            if (key == 'd') {
+                memmove(&F.folds[i], &F.folds[i + 1], sizeof(fold) * (F.nfolds - i - 1));
+                F.nfolds--;
+            } else {
+                F.folds[i].closed = key == 'c' || (key == 'a' && shown < 0);
+            }
+            break;
+        default:
+            return -1;
+    }
+    F.stale = 1;
+    return 0;
+}
+
+/* Nesting depth d folds are closed when d >= level (0 closes all) */
+static int folds_push(int start, int end, int depth, int level) {
+    if (F.nfolds == F.cap) {
+        int cap = F.cap ? F.cap * 2 : 16;
+        fold *f = editor_realloc(MEM_INDEX, F.folds, sizeof(fold) * cap);
+        if (f == NULL) return -1;
+        F.folds = f;
+        F.cap = cap;
+    }
+    F.folds[F.nfolds].start = start;
+    F.folds[F.nfolds].end = end;
+    F.folds[F.nfolds].closed = depth >= level;
+    F.nfolds++;
+    return 0;
+}
+
+/* Indent width of row y, or -1 if it is blank */
+static int row_indent(int y) {
+    const erow *r = &E.row[y];
+    int w = 0;
+    for (int i = 0; i < r->size; i++) {
+        if (r->chars[i] == ' ') w++;
+        else if (r->chars[i] == '\t') w += 8 - w % 8;
+        else return w;
+    }
+    return -1;
+}
+
+/* Lines whose fold is still open while building, innermost last */
+typedef struct open_lines {
+    struct { int line, indent; } *v;
+    int n, cap;
+} open_lines;
+
+static int open_push(open_lines *s, int line, int indent) {
+    if (s->n == s->cap) {
+        int cap = s->cap ? s->cap * 2 : 64;
+        void *v = editor_realloc(MEM_INDEX, s->v, sizeof(*s->v) * cap);
+        if (v == NULL) return -1;
+        s->v = v;
+        s->cap = cap;
+    }
+    s->v[s->n].line = line;
+    s->v[s->n].indent = indent;
+    s->n++;
+    return 0;
+}
+
+/* A fold from each line to the last line after it indented deeper;
+ * blank lines go with the lines around them */
+static int folds_by_indent(int level, open_lines *s) {
+    int last = -1;
+    for (int y = 0; y <= E.numrows; y++) {
+        int w = y < E.numrows ? row_indent(y) : 0;
+        if (w < 0) continue;
+        while (s->n > 0 && (y == E.numrows || s->v[s->n - 1].indent >= w)) {
+            int start = s->v[--s->n].line;
+            if (last > start && folds_push(start, last, s->n, level) == -1) return -1;
+        }
+        if (y < E.numrows) {
+            if (open_push(s, y, w) == -1) return -1;
+            last = y;
+        }
+    }
+    return 0;
+}
+
+/* A fold from each line with a '{' to the line with its '}' */
+static int folds_by_brace(int level, open_lines *s) {
+    for (int y = 0; y < E.numrows; y++) {
+        const erow *r = &E.row[y];
+        for (int x = 0; x < r->size; x++) {
+            if (r->chars[x] == '{') {
+                if (open_push(s, y, 0) == -1) return -1;
+            } else if (r->chars[x] == '}' && s->n > 0) {
+                int start = s->v[--s->n].line;
+                if (start < y && folds_push(start, y, s->n, level) == -1) return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int folds_from(int brace, int level) {
+    open_lines s = { NULL, 0, 0 };
+    F.nfolds = 0;
+    int ret = brace ? folds_by_brace(level, &s) : folds_by_indent(level, &s);
+    editor_free(MEM_INDEX, s.v);
+
+    /* Lines with a '}' and a '{' end one fold and start the next; the
+     * tidy pass keeps them in the second */
+    if (F.nfolds > 1) qsort(F.folds, F.nfolds, sizeof(fold), fold_cmp);
+    F.stale = 1;
+    if (ret == -1) {
+        F.nfolds = 0;
+        editor_set_status("Memory allocation failed");
+        return -1;
+    }
+    return F.nfolds;
+}
+
+int folds_count(void) {
+    folds_ready();
+    return F.nfolds;
+}
@@ -0,0 +1,396 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Hex view of a file.
+ *
+ * The file is mapped instead of read into rows, so it opens at once and
+ * in the same memory whatever its size; only the lines on screen are
+ * ever touched. Typed bytes go into a sparse overlay, sorted by offset,
+ * that reads consult over the mapping. Saving writes each run of
+ * patched bytes in place with pwrite() and leaves the rest of the file
+ * alone. Bytes are overwritten, never inserted or deleted, so the file
+ * keeps its length.
+ */
+
+#include "abczed.h"
+#include "input.h"
+#include "stats.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+/* Screen layout: offset, two spaces, 16 "xx " groups with an extra space
+ * after the eighth, a space, then the bytes as text */
+#define HEX_GAP 2
+#define HEX_TEXT_GAP 2
+
+/* Patched byte */
+typedef struct hex_patch {
+    long long off;
+    unsigned char byte;
+} hex_patch;
+
+/* One byte edit, for undo and redo */
+typedef struct hex_edit {
+    long long off;
+    unsigned char before, after;
+} hex_edit;
+
+static struct {
+    int on;
+    int fd;
+    int readonly;               /* File could only be opened for reading */
+    const unsigned char *map;   /* NULL for an empty file */
+    hex_view v;
+    hex_patch *patches;         /* Sorted by offset */
+    size_t npatches, pcap;
+    hex_edit *log;              /* Edits [0, logpos) can be undone, the rest redone */
+    size_t nlog, logpos, logcap;
+    long count;                 /* Count typed before a command */
+} H;
+
+const hex_view *hex_state(void) {
+    return H.on ? &H.v : NULL;
+}
+
+int hex_column(int i, int text) {
+    if (text) return H.v.width + HEX_GAP + 3 * HEX_LINE_BYTES + HEX_TEXT_GAP + i;
+    return H.v.width + HEX_GAP + 3 * i + (i >= HEX_LINE_BYTES / 2);
+}
+
+/* First patch at or after off */
+static size_t patch_find(long long off) {
+    size_t lo = 0, hi = H.npatches;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (H.patches[mid].off < off) lo = mid + 1;
+        else hi = mid;
+    }
+    return lo;
+}
+
+static unsigned char byte_at(long long off) {
+    size_t i = patch_find(off);
+    if (i < H.npatches && H.patches[i].off == off) return H.patches[i].byte;
+    return H.map[off];
+}
+
+/* Make off read as b; a byte put back to what the file holds is no
+ * longer a patch */
+static int patch_set(long long off, unsigned char b) {
+    size_t i = patch_find(off);
+    int found = i < H.npatches && H.patches[i].off == off;
+    if (b == H.map[off]) {
+        if (found) {
+            memmove(&H.patches[i], &H.patches[i + 1], sizeof(hex_patch) * (H.npatches - i - 1));
+            H.npatches--;
+        }
+        return 0;
+    }
+    if (found) {
+        H.patches[i].byte = b;
+        return 0;
+    }
+    if (H.npatches == H.pcap) {
+        size_t cap = H.pcap ? H.pcap * 2 : 64;
+        hex_patch *p = editor_realloc(MEM_MISC, H.patches, sizeof(hex_patch) * cap);
+        if (p == NULL) return -1;
+        H.patches = p;
+        H.pcap = cap;
+    }
+    memmove(&H.patches[i + 1], &H.patches[i], sizeof(hex_patch) * (H.npatches - i));
+    H.patches[i].off = off;
+    H.patches[i].byte = b;
+    H.npatches++;
+    return 0;
+}
+
+size_t hex_read(long long off, unsigned char *buf, unsigned char *patched, size_t n) {
+    if (!H.on || off < 0 || off >= H.v.size) return 0;
+    if ((long long)n > H.v.size - off) n = (size_t)(H.v.size - off);
+    memcpy(buf, H.map + off, n);
+    if (patched) memset(patched, 0, n);
+    for (size_t i = patch_find(off); i < H.npatches && H.patches[i].off < off + (long long)n; i++) {
+        buf[H.patches[i].off - off] = H.patches[i].byte;
+        if (patched) patched[H.patches[i].off - off] = 1;
+    }
+    return n;
+}
+
+/* Overwrite the byte at off, recording the edit */
+static void edit(long long off, unsigned char b) {
+    unsigned char before = byte_at(off);
+    if (before == b) return;
+    if (H.logpos == H.logcap) {
+        size_t cap = H.logcap ? H.logcap * 2 : 64;
+        hex_edit *l = editor_realloc(MEM_UNDO, H.log, sizeof(hex_edit) * cap);
+        if (l == NULL) {
+            editor_set_status("Error: Out of memory");
+            return;
+        }
+        H.log = l;
+        H.logcap = cap;
+    }
+    if (patch_set(off, b) == -1) {
+        editor_set_status("Error: Out of memory");
+        return;
+    }
+    H.log[H.logpos].off = off;
+    H.log[H.logpos].before = before;
+    H.log[H.logpos].after = b;
+    H.nlog = ++H.logpos;
+    E.dirty++;
+}
+
+/* Undo (steps < 0) or redo edits */
+static void undo(long steps) {
+    long done = 0;
+    for (; steps < 0 && H.logpos > 0; steps++, done++) {
+        hex_edit *e = &H.log[--H.logpos];
+        patch_set(e->off, e->before);
+        H.v.cursor = e->off;
+    }
+    for (; steps > 0 && H.logpos < H.nlog; steps--, done++) {
+        hex_edit *e = &H.log[H.logpos++];
+        patch_set(e->off, e->after);
+        H.v.cursor = e->off;
+    }
+    if (done == 0) {
+        editor_set_status(steps < 0 ? "Nothing to undo" : "Nothing to redo");
+        return;
+    }
+    H.v.nibble = 0;
+    E.dirty++;
+}
+
+static void move(long long delta) {
+    long long last = H.v.size > 0 ? H.v.size - 1 : 0;
+    long long to = H.v.cursor + delta;
+    H.v.cursor = to < 0 ? 0 : to > last ? last : to;
+    H.v.nibble = 0;
+}
+
+/* Free the rows of the text view; the hex view keeps none */
+static void drop_rows(void) {
+    for (int i = 0; i < E.numrows; i++) row_text_unref(E.row[i].chars);
+    editor_free(MEM_ROW_ARRAY, E.row);
+    E.row = NULL;
+    E.numrows = 0;
+    E.cx = E.cy = E.rowoff = E.coloff = 0;
+    brackets_free();
+    folds_free();
+    csv_disable();
+    diff_disable();
+    cursors_clear();
+    editor_selection_clear();
+    marks_free();
+    anchors_free();
+    free_operations_stack(E.undo_stack);
+    E.undo_stack = NULL;
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+}
+
+int hex_open(const char *filename) {
+    char *name = editor_strdup(MEM_MISC, filename);
+    if (name == NULL) {
+        editor_set_status("Error: Out of memory");
+        return -1;
+    }
+    uint64_t start = stats_now();
+    int readonly = 0;
+    int fd = open(filename, O_RDWR);
+    if (fd == -1 && (errno == EACCES || errno == EROFS)) {
+        fd = open(filename, O_RDONLY);
+        readonly = 1;
+    }
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) == -1) {
+        editor_set_status("Can't open %s: %s", filename, strerror(errno));
+        if (fd != -1) close(fd);
+        editor_free(MEM_MISC, name);
+        return -1;
+    }
+    /* Shared, so bytes written by a save show through the mapping */
+    const unsigned char *map = NULL;
+    if (st.st_size > 0) {
+        map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED) {
+            editor_set_status("Can't map %s: %s", filename, strerror(errno));
+            close(fd);
+            editor_free(MEM_MISC, name);
+            return -1;
+        }
+    }
+
+    hex_close();
+    drop_rows();
+    editor_free(MEM_MISC, E.filename);
+    E.filename = name;
+    H.on = 1;
+    H.fd = fd;
+    H.readonly = readonly;
+    H.map = map;
+    H.v.size = st.st_size;
+    H.v.width = 8;
+    while (H.v.width < 16 && H.v.size > 0 && (H.v.size - 1) >> (4 * H.v.width) > 0) H.v.width++;
+    E.mode = MODE_NORMAL;
+    E.dirty = 0;
+    stats_timer_add(&S.open, start);
+    editor_set_status("%s: %lld bytes%s", E.filename, H.v.size, readonly ? " [read-only]" : "");
+    return 0;
+}
+
+void hex_close(void) {
+    if (!H.on) return;
+    if (H.map) munmap((void *)H.map, (size_t)H.v.size);
+    close(H.fd);
+    editor_free(MEM_MISC, H.patches);
+    editor_free(MEM_UNDO, H.log);
+    memset(&H, 0, sizeof(H));
+}
+
+void hex_scroll(void) {
+    long long line = H.v.cursor / HEX_LINE_BYTES;
+    if (line < H.v.top) H.v.top = line;
+    if (line >= H.v.top + E.screenrows) H.v.top = line - E.screenrows + 1;
+}
+
+/* Write all of buf at off */
+static int write_at(const unsigned char *buf, size_t len, long long off) {
+    while (len > 0) {
+        ssize_t n = pwrite(H.fd, buf, len, (off_t)off);
+        if (n == -1 && errno == EINTR) continue;
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+        off += n;
+    }
+    return 0;
+}
+
+int hex_save(void) {
+    if (H.readonly) {
+        editor_set_status("Can't save! %s is read-only", E.filename);
+        return -1;
+    }
+    uint64_t start = stats_now();
+    unsigned char run[4096];
+    long ranges = 0;
+    size_t i = 0;
+    while (i < H.npatches) {
+        /* Consecutive patched bytes go out in one write */
+        long long off = H.patches[i].off;
+        size_t len = 0;
+        while (i < H.npatches && H.patches[i].off == off + (long long)len && len < sizeof(run)) {
+            run[len++] = H.patches[i++].byte;
+        }
+        if (write_at(run, len, off) == -1) {
+            editor_set_status("Can't save! I/O error: %s", strerror(errno));
+            return -1;
+        }
+        S.save_bytes += len;
+        ranges++;
+    }
+    /* The mapping now holds what the patches did */
+    H.npatches = 0;
+    E.dirty = 0;
+    stats_timer_add(&S.save, start);
+    editor_set_status("%ld ranges written to %s", ranges, E.filename);
+    return 0;
+}
+
+static int hex_digit(int c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/* Keys while overwriting bytes */
+static void replace_key(int c) {
+    int d;
+    switch (c) {
+        case 27:
+            E.mode = MODE_NORMAL;
+            H.v.nibble = 0;
+            editor_set_status("-- NORMAL --");
+            editor_flush_keys();
+            return;
+        case EKEY_LEFT: case EKEY_BACKSPACE: case 127: move(-1); return;
+        case EKEY_RIGHT: move(1); return;
+        case EKEY_UP: move(-HEX_LINE_BYTES); return;
+        case EKEY_DOWN: move(HEX_LINE_BYTES); return;
+        case '\t':
+            H.v.text = !H.v.text;
+            H.v.nibble = 0;
+            return;
+    }
+    if (H.v.size == 0) return;
+    if (H.v.text) {
+        if (c < 32 || c > 126) return;
+        edit(H.v.cursor, (unsigned char)c);
+        move(1);
+    } else if ((d = hex_digit(c)) >= 0) {
+        unsigned char b = byte_at(H.v.cursor);
+        b = H.v.nibble ? (unsigned char)((b & 0xf0) | d) : (unsigned char)(d << 4 | (b & 0x0f));
+        edit(H.v.cursor, b);
+        if (H.v.nibble) move(1);
+        else H.v.nibble = 1;
+    }
+}
+
+int hex_key(int c) {
+    if (c == EKEY_NONE) return 0;
+    if (E.mode == MODE_INSERT) {
+        replace_key(c);
+        return 0;
+    }
+    if ((c >= '1' && c <= '9') || (c == '0' && H.count > 0)) {
+        if (H.count < 100000000) H.count = H.count * 10 + (c - '0');
+        return 0;
+    }
+    long n = H.count > 0 ? H.count : 1;
+    long long page = (long long)E.screenrows * HEX_LINE_BYTES;
+    H.count = 0;
+
+    switch (c) {
+        case 'h': case EKEY_LEFT: case EKEY_BACKSPACE: move(-n); break;
+        case 'l': case EKEY_RIGHT: case ' ': move(n); break;
+        case 'k': case EKEY_UP: move(-n * HEX_LINE_BYTES); break;
+        case 'j': case EKEY_DOWN: move(n * HEX_LINE_BYTES); break;
+        case '0': case EKEY_HOME: move(-(H.v.cursor % HEX_LINE_BYTES)); break;
+        case '$': case EKEY_END: move(HEX_LINE_BYTES - 1 - H.v.cursor % HEX_LINE_BYTES); break;
+        case EKEY_PPAGE: case CTRL_KEY('b'): move(-n * page); break;
+        case EKEY_NPAGE: case CTRL_KEY('f'): move(n * page); break;
+        case 'g': move(-H.v.cursor); break;
+        case 'G': move(H.v.size); break;
+        case '\t':
+            H.v.text = !H.v.text;
+            H.v.nibble = 0;
+            break;
+        case 'i': case 'R':
+            E.mode = MODE_INSERT;
+            editor_set_status("-- REPLACE --");
+            break;
+        case 'u': case CTRL_KEY('z'): undo(-n); break;
+        case CTRL_KEY('r'): case CTRL_KEY('y'): undo(n); break;
+        case ':':
+            E.mode = MODE_COMMAND;
+            E.commandbuf[0] = ':';
+            E.commandlen = 1;
+            E.commandbuf[E.commandlen] = '\0';
+            editor_set_status(":");
+            break;
+        case 27:
+            editor_flush_keys();
+            break;
+    }
+    return 0;
+}
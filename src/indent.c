@@ -0,0 +1,355 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Auto-indent and reindenting.
+ *
+ * A line inside open brackets is indented one unit deeper than the line
+ * that opened the innermost of them, and a line that starts by closing
+ * a bracket lines up with the line that opened it. Brackets inside
+ * strings and comments do not count. The unit is a tab if the buffer
+ * indents with tabs, otherwise the smallest run of leading spaces it
+ * uses.
+ *
+ * Enter and a typed closing bracket look the opening bracket up in the
+ * bracket index, so they cost O(log n) wherever it is.
+ *
+ * Reindenting works out every line's new indentation first, then saves
+ * the range for undo once and rewrites only the lines that change, so a
+ * whole file is one pass over its text and one undo step.
+ */
+
+#include "abczed.h"
+
+#include <string.h>
+
+#define TAB_COLS 8
+
+/* Lines looked at to guess the indent unit */
+#define UNIT_SAMPLE 1000
+
+static int auto_indent = 1;
+
+/* Indent unit: tabs, or this many spaces */
+static int unit_tabs;
+static int unit_cols;
+
+void indent_set_auto(int on) {
+    auto_indent = on;
+}
+
+int indent_auto(void) {
+    return auto_indent;
+}
+
+/* Columns of the leading blanks of r; *len gets their length in bytes */
+static int indent_cols(const erow *r, int *len) {
+    int cols = 0, i = 0;
+    for (; i < r->size; i++) {
+        if (r->chars[i] == ' ') cols++;
+        else if (r->chars[i] == '\t') cols += TAB_COLS - cols % TAB_COLS;
+        else break;
+    }
+    *len = i;
+    return cols;
+}
+
+static void detect_unit(void) {
+    int rows = E.numrows < UNIT_SAMPLE ? E.numrows : UNIT_SAMPLE;
+    int smallest = 0;
+    unit_tabs = 0;
+    for (int y = 0; y < rows; y++) {
+        const erow *r = &E.row[y];
+        if (r->size > 0 && r->chars[0] == '\t') {
+            unit_tabs = 1;
+            break;
+        }
+        int spaces = 0;
+        while (spaces < r->size && r->chars[spaces] == ' ') spaces++;
+        if (spaces < r->size && spaces > 0 && (smallest == 0 || spaces < smallest)) smallest = spaces;
+    }
+    if (unit_tabs) unit_cols = TAB_COLS;
+    else unit_cols = smallest > 0 && smallest <= 8 ? smallest : 4;
+}
+
+/* What a line does to bracket depth, outside strings and comments */
+typedef struct line_shape {
+    int closers;        /* Brackets closed before anything else on it */
+    int open;           /* Brackets opened on it and still open at its end */
+    int unmatched;      /* Last later bracket closing one opened on an
+                           earlier line, or -1 */
+} line_shape;
+
+/* Open brackets while reindenting: the indentation of the line that
+ * opened each, and the indentation outside all of them */
+typedef struct bracket_stack {
+    int *cols;
+    int n, cap;
+    int base;
+} bracket_stack;
+
+static int stack_push(bracket_stack *st, int cols) {
+    if (st->n == st->cap) {
+        int cap = st->cap ? st->cap * 2 : 64;
+        int *v = editor_realloc(MEM_MISC, st->cols, sizeof(int) * cap);
+        if (v == NULL) return -1;
+        st->cols = v;
+        st->cap = cap;
+    }
+    st->cols[st->n++] = cols;
+    return 0;
+}
+
+/* Scan r from the end of its leading blanks at start; with st, brackets opened are pushed at cols and the ones
+ * closed popped. *comment carries an open block comment from one line
+ * to the next. */
+static void scan_line(const erow *r, int start, int *comment, line_shape *s, bracket_stack *st, int cols) {
+    int i = start, lead = 1;
+    char quote = 0;
+    s->closers = s->open = 0;
+    s->unmatched = -1;
+    for (; i < r->size; i++) {
+        char c = r->chars[i];
+        char next = i + 1 < r->size ? r->chars[i + 1] : 0;
+        if (*comment) {
+            if (c == '*' && next == '/') {
+                *comment = 0;
+                i++;
+            }
+            continue;
+        }
+        if (quote) {
+            if (c == '\\') i++;
+            else if (c == quote) quote = 0;
+            continue;
+        }
+        if (c == '/' && next == '/') break;
+        if (c == '/' && next == '*') {
+            *comment = 1;
+            i++;
+            continue;
+        }
+        if (c == '"' || c == '\'') {
+            quote = c;
+        } else if (c == '(' || c == '[' || c == '{') {
+            s->open++;
+            if (st && stack_push(st, cols) == -1) st = NULL;
+        } else if (c == ')' || c == ']' || c == '}') {
+            if (s->open > 0) {
+                s->open--;
+            } else if (lead) {
+                s->closers++;
+            } else {
+                s->unmatched = i;
+            }
+            if (st) {
+                if (st->n > 0) st->n--;
+                else st->base = st->base > unit_cols ? st->base - unit_cols : 0;
+            }
+            if (lead) continue;
+        }
+        lead = 0;
+    }
+}
+
+/* Brackets closed at the start of r, after its len leading blanks */
+static int lead_closers(const erow *r, int len) {
+    int n = 0;
+    for (int i = len; i < r->size; i++) {
+        char c = r->chars[i];
+        if (c != ')' && c != ']' && c != '}') break;
+        n++;
+    }
+    return n;
+}
+
+/* Indentation of the line that opened the bracket at (y, x), or -1 */
+static int opener_cols(int y, int x) {
+    int oy, ox, len;
+    if (bracket_match(y, x, &oy, &ox) == -1 || oy >= y) return -1;
+    return indent_cols(&E.row[oy], &len);
+}
+
+/* Indentation for a line after row y: y's own, or that of the line
+ * holding the bracket y closes, one unit deeper if y leaves one open */
+static int cols_after(int y) {
+    int len, comment = 0;
+    line_shape s;
+    int cols = indent_cols(&E.row[y], &len);
+    scan_line(&E.row[y], len, &comment, &s, NULL, 0);
+    if (s.unmatched >= 0) {
+        int c = opener_cols(y, s.unmatched);
+        if (c >= 0) cols = c;
+    }
+    return cols + (s.open > 0 ? unit_cols : 0);
+}
+
+/* Indentation of a line starting with closers brackets closed */
+static int stack_cols(const bracket_stack *st, int closers) {
+    if (closers > st->n) {
+        int c = st->base - (closers - st->n) * unit_cols;
+        return c > 0 ? c : 0;
+    }
+    if (closers > 0) return st->cols[st->n - closers];
+    return st->n > 0 ? st->cols[st->n - 1] + unit_cols : st->base;
+}
+
+/* Whether the len leading blanks of r are already cols columns written
+ * in the unit's style */
+static int indent_matches(const erow *r, int len, int cols) {
+    int tabs = unit_tabs ? cols / TAB_COLS : 0;
+    if (len != tabs + cols - tabs * TAB_COLS) return 0;
+    for (int i = 0; i < len; i++) {
+        if (r->chars[i] != (i < tabs ? '\t' : ' ')) return 0;
+    }
+    return 1;
+}
+
+/* Blanks for cols columns in the unit's style; returns their length */
+static int indent_text(int cols, char *buf, int cap) {
+    int n = 0;
+    if (unit_tabs) {
+        for (; cols >= TAB_COLS && n < cap; cols -= TAB_COLS) buf[n++] = '\t';
+    }
+    for (; cols > 0 && n < cap; cols--) buf[n++] = ' ';
+    return n;
+}
+
+int indent_newline(char *buf, int cap) {
+    int y = E.cy;
+    if (!auto_indent || y < 1 || y >= E.numrows) return 0;
+    detect_unit();
+
+    const erow *prev = &E.row[y - 1];
+    int len;
+    int cols = indent_cols(prev, &len);
+    int target = cols_after(y - 1);
+
+    /* Text carried onto the new line that starts by closing a bracket
+     * lines up with the line that opened it */
+    int lead;
+    indent_cols(&E.row[y], &lead);
+    if (lead_closers(&E.row[y], lead) > 0) {
+        int c = opener_cols(y, lead);
+        target = c >= 0 ? c : (target > unit_cols ? target - unit_cols : 0);
+    }
+
+    /* Unchanged indentation is copied as it is, alignment included */
+    if (target == cols) {
+        if (len > cap) len = cap;
+        memcpy(buf, prev->chars, len);
+        return len;
+    }
+    return indent_text(target, buf, cap);
+}
+
+int indent_electric(void) {
+    int y = E.cy, x = E.cx - 1;
+    if (!auto_indent || y >= E.numrows || x < 0 || x >= E.row[y].size) return 0;
+    const erow *r = &E.row[y];
+    char c = r->chars[x];
+    if (c != ')' && c != ']' && c != '}') return 0;
+    int len;
+    int cols = indent_cols(r, &len);
+    if (len != x) return 0;
+
+    detect_unit();
+    int target = opener_cols(y, x);
+    if (target < 0 || (target == cols && indent_matches(r, len, cols))) return 0;
+    char buf[256];
+    int n = indent_text(target, buf, sizeof(buf));
+    editor_replace_range(y, 0, y, len, buf, n);
+    E.cx = n + 1;
+    return 1;
+}
+
+int editor_reindent(int y0, int y1) {
+    if (y0 < 0) y0 = 0;
+    if (y1 >= E.numrows) y1 = E.numrows - 1;
+    if (y1 < y0) return 0;
+    detect_unit();
+
+    int count = y1 - y0 + 1;
+    int *cols = editor_malloc(MEM_MISC, sizeof(int) * count);
+    if (cols == NULL) {
+        editor_set_status("Memory allocation failed");
+        return -1;
+    }
+
+    /* The first line follows the nearest non-blank line above it */
+    bracket_stack st = { NULL, 0, 0, 0 };
+    int len;
+    for (int y = y0 - 1; y >= 0; y--) {
+        indent_cols(&E.row[y], &len);
+        if (len < E.row[y].size) {
+            st.base = cols_after(y);
+            break;
+        }
+    }
+
+    int changed = 0, comment = 0;
+    line_shape s;
+    for (int i = 0; i < count; i++) {
+        const erow *r = &E.row[y0 + i];
+        int old = indent_cols(r, &len);
+        if (len == r->size) {
+            cols[i] = -1;
+            changed += r->size > 0;
+            continue;
+        }
+        if (comment) {
+            /* Block comment lines keep their indentation */
+            cols[i] = old;
+        } else {
+            cols[i] = stack_cols(&st, lead_closers(r, len));
+            if (cols[i] != old || !indent_matches(r, len, cols[i])) changed++;
+        }
+        scan_line(r, len, &comment, &s, &st, cols[i]);
+    }
+    editor_free(MEM_MISC, st.cols);
+
+    if (changed == 0) {
+        editor_free(MEM_MISC, cols);
+        return 0;
+    }
+    if (undo_begin_rows(y0, count) == -1) {
+        editor_free(MEM_MISC, cols);
+        editor_set_status("Memory allocation failed");
+        return -1;
+    }
+
+    /* Rows are shared with the undo record until they are rewritten */
+    char *ws = NULL;
+    int ws_cap = 0;
+    for (int i = 0; i < count; i++) {
+        erow *r = &E.row[y0 + i];
+        int old_len;
+        indent_cols(r, &old_len);
+        int new_len = 0;
+        if (cols[i] >= 0) {
+            if (indent_matches(r, old_len, cols[i])) continue;
+            if (cols[i] + 1 > ws_cap) {
+                int cap = ws_cap ? ws_cap : 64;
+                while (cap < cols[i] + 1) cap *= 2;
+                char *b = editor_realloc(MEM_MISC, ws, cap);
+                if (b == NULL) break;
+                ws = b;
+                ws_cap = cap;
+            }
+            new_len = indent_text(cols[i], ws, ws_cap);
+        } else if (r->size == 0) {
+            continue;
+        }
+        int size = r->size - old_len + new_len;
+        if (row_text_reserve(r, (size_t)(size > r->size ? size : r->size) + 1) == -1) break;
+        memmove(r->chars + new_len, r->chars + old_len, r->size - old_len);
+        if (new_len > 0) memcpy(r->chars, ws, new_len);
+        r->size = size;
+        r->chars[size] = '\0';
+    }
+    undo_end_rows(count);
+    editor_free(MEM_MISC, ws);
+    editor_free(MEM_MISC, cols);
+    E.dirty++;
+    return changed;
+}
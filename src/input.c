@@ -0,0 +1,1123 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Key reading and key handling for all editor modes.
+ */
+
+#include "abczed.h"
+#include "input.h"
+#include "motion.h"
+#include "operator.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <stddef.h>
+#include <string.h>
+
+/* Active input backend */
+static const input_backend *I = NULL;
+
+/* Keys pushed back with editor_unread_key() */
+static int pending_keys[16];
+
+/* Set by '"': the next key names the register for a yank or put */
+static int awaiting_register = 0;
+static int pending_len = 0;
+
+/* Set by 'q' and '@': the next key names the macro register */
+static int awaiting_record = 0;
+static int awaiting_macro = 0;
+
+/* Count typed before a command in NORMAL mode, 0 if none */
+static long count = 0;
+
+/* Set by f, t, F and T: the next key is the character to find */
+static int awaiting_find = 0;
+static long find_count = 1;
+
+/* Set by 'z': the next key is a fold command */
+static int awaiting_fold = 0;
+static long fold_count = 1;
+
+/* Set by 'm': the next key names the mark to set */
+static int awaiting_mark = 0;
+
+/* Set by 'r' in block selection: the next key replaces the block */
+static int awaiting_replace = 0;
+
+/* Text typed for a block 'I', 'A' or 'c'; applied to every row of the
+ * block when Enter or ESC ends it */
+static int block_insert = 0;            /* 'I', 'A', 'c' or 0 */
+static char block_text[128];
+static int block_len = 0;
+
+/* The last change, which '.' repeats */
+enum last_change_kind {
+    CHANGE_NONE = 0,
+    CHANGE_OPERATOR,        /* d or c (with the text typed after it) */
+    CHANGE_PUT,             /* p */
+    CHANGE_INSERT           /* Text typed after cc or Enter */
+};
+
+/* Text typed in INSERT mode */
+typedef struct typed_text {
+    char *b;
+    size_t len, cap;
+} typed_text;
+
+static int last_change = CHANGE_NONE;
+static long last_count = 1;
+static int last_register = '"';     /* Register a repeated put reads */
+static int last_put_before = 0;     /* The put was P */
+static operator_cmd last_op;
+static typed_text last_text;
+
+/* The insert being typed. Capture stops if the insert does something
+ * '.' cannot replay, such as moving the cursor. */
+static int inserting = 0;
+static long insert_count = 1;
+static int insert_after_op = 0;     /* The insert follows a c operator */
+static typed_text insert_text;
+
+/* A counted insert is one undo step: the row it started on, saved by
+ * reference, and the top of the undo stack then */
+static operation *insert_mark;
+static erow *insert_before;
+static int insert_nbefore, insert_y, insert_x;
+
+/* Select the backend used by editor_read_key() */
+void input_set_backend(const input_backend *backend) {
+    I = backend;
+}
+
+/* Read a key, returning pushed-back keys first */
+int editor_read_key(int timeout_ms) {
+    if (pending_len > 0) {
+        return pending_keys[--pending_len];
+    }
+    if (macro_replaying()) {
+        int c = macro_replay_next();
+        if (c != EKEY_NONE) return c;
+    }
+    if (I == NULL) return EKEY_NONE;
+    int c = I->read_key(timeout_ms);
+    if (c != EKEY_NONE && macro_recording()) macro_record_key(c);
+    return c;
+}
+
+void editor_flush_keys(void) {
+    pending_len = 0;
+    if (macro_replaying() || I == NULL) return;
+    while (I->read_key(0) != EKEY_NONE);
+}
+
+/* Push a key back so the next editor_read_key() returns it */
+void editor_unread_key(int c) {
+    if (pending_len < (int)(sizeof(pending_keys) / sizeof(pending_keys[0]))) {
+        pending_keys[pending_len++] = c;
+    }
+}
+
+/* Move the cursor one step */
+static void editor_move_cursor_once(int key) {
+    erow *row = (E.cy >= E.numrows) ? NULL : &E.row[E.cy];
+    
+    switch (key) {
+        case EKEY_LEFT:
+        case 'h':
+            if (E.cx > 0) {
+                E.cx--;
+            } else if (folds_visible(E.cy) > 0) {
+                /* Move to end of previous line */
+                E.cy = folds_row(folds_visible(E.cy) - 1);
+                E.cx = E.row[E.cy].size;
+            }
+            break;
+        case EKEY_RIGHT:
+        case 'l':
+            if (row && E.cx < row->size) {
+                E.cx++;
+            } else if (row && E.cx == row->size && folds_visible(E.cy) < folds_visible_count() - 1) {
+                /* Move to beginning of next line */
+                E.cy = folds_row(folds_visible(E.cy) + 1);
+                E.cx = 0;
+            }
+            break;
+        case EKEY_UP:
+        case 'k':
+            /* Lines hidden in closed folds are skipped */
+            if (folds_visible(E.cy) > 0) {
+                E.cy = folds_row(folds_visible(E.cy) - 1);
+                /* Adjust horizontal position if needed */
+                if (E.cx > E.row[E.cy].size)
+                    E.cx = E.row[E.cy].size;
+            }
+            break;
+        case EKEY_DOWN:
+        case 'j':
+            if (folds_visible(E.cy) < folds_visible_count() - 1) {
+                E.cy = folds_row(folds_visible(E.cy) + 1);
+                /* Adjust horizontal position if needed */
+                if (E.cx > E.row[E.cy].size)
+                    E.cx = E.row[E.cy].size;
+            }
+            break;
+        case EKEY_HOME:
+        case '0':
+            E.cx = 0;
+            break;
+        case EKEY_END:
+        case '$':
+            if (row) E.cx = row->size;
+            break;
+        case EKEY_PPAGE:  /* Page Up */
+            {
+                /* A screenful up from the top line, in screen rows */
+                int v = folds_visible(E.rowoff) - E.screenrows;
+                E.cy = folds_row(v > 0 ? v : 0);
+                /* Adjust cursor position if needed */
+                if (E.cy < E.numrows && E.cx > E.row[E.cy].size) {
+                    E.cx = E.row[E.cy].size;
+                }
+            }
+            break;
+        case EKEY_NPAGE:  /* Page Down */
+            {
+                /* A screenful down from the bottom line */
+                int v = folds_visible(E.rowoff) + 2 * E.screenrows - 1;
+                int last = folds_visible_count() - 1;
+                E.cy = folds_row(v < last ? v : (last > 0 ? last : 0));
+                /* Adjust cursor position if needed */
+                if (E.cy < E.numrows && E.cx > E.row[E.cy].size) {
+                    E.cx = E.row[E.cy].size;
+                }
+            }
+            break;
+    }
+}
+
+/* Move cursor */
+int editor_move_cursor(int key) {
+    return editor_move_cursor_n(key, 1);
+}
+
+/* Move the cursor n steps, stopping early at the edge of the buffer */
+int editor_move_cursor_n(int key, long n) {
+    int old_cx = E.cx, old_cy = E.cy;
+    for (long i = 0; i < n; i++) {
+        int cx = E.cx, cy = E.cy;
+        editor_move_cursor_once(key);
+        if (E.cx == cx && E.cy == cy) break;
+    }
+    if (csv_delim() && E.cy != old_cy && (key == 'j' || key == 'k' || key == EKEY_UP || key == EKEY_DOWN)) {
+        /* Up and down a CSV column */
+        E.cx = csv_same_column(old_cy, old_cx, E.cy);
+    }
+    
+    /* Update selection if in selection mode */
+    if (E.mode == MODE_SELECTION) {
+        editor_selection_update();
+    }
+    
+    /* Line start and end always succeed; other motions fail when the
+     * cursor is already as far as it can go */
+    if (E.cx == old_cx && E.cy == old_cy && key != EKEY_HOME && key != '0' &&
+        key != EKEY_END && key != '$') {
+        macro_replay_abort("motion failed");
+        return -1;
+    }
+    return 0;
+}
+
+static void editor_insert_drop_undo(void) {
+    for (int i = 0; i < insert_nbefore; i++) editor_free_row(&insert_before[i]);
+    editor_free(MEM_UNDO, insert_before);
+    insert_before = NULL;
+    insert_nbefore = 0;
+}
+
+/* Start capturing an insert that is to be typed n times */
+static void editor_insert_begin(long n) {
+    inserting = cursors_count() == 0;
+    insert_count = n;
+    insert_after_op = 0;
+    insert_text.len = 0;
+    
+    editor_insert_drop_undo();
+    if (inserting && n > 1) {
+        insert_before = editor_malloc(MEM_UNDO, sizeof(erow));
+        if (insert_before != NULL && E.cy < E.numrows) {
+            insert_before[0].size = E.row[E.cy].size;
+            insert_before[0].chars = row_text_ref(E.row[E.cy].chars);
+            insert_nbefore = 1;
+        }
+        insert_mark = E.undo_stack;
+        insert_y = E.cy;
+        insert_x = E.cx;
+    }
+}
+
+static void editor_insert_record(int c) {
+    if (!inserting) return;
+    if (insert_text.len == insert_text.cap) {
+        size_t cap = insert_text.cap ? insert_text.cap * 2 : 64;
+        char *b = editor_realloc(MEM_MISC, insert_text.b, cap);
+        if (b == NULL) {
+            inserting = 0;
+            return;
+        }
+        insert_text.b = b;
+        insert_text.cap = cap;
+    }
+    insert_text.b[insert_text.len++] = (char)c;
+}
+
+/* The cursor's line was reindented while typing: if this insert typed
+ * the line, record it again up to the cursor as it now reads */
+static void editor_insert_rerecord_line(void) {
+    if (!inserting) return;
+    size_t start = insert_text.len;
+    while (start > 0 && insert_text.b[start - 1] != '\n') start--;
+    if (start == 0) return;
+    insert_text.len = start;
+    for (int i = 0; i < E.cx; i++) editor_insert_record(E.row[E.cy].chars[i]);
+}
+
+/* Leaving INSERT mode: type the rest of a counted insert, folding it
+ * and the typed text into one undo step, and keep the text for '.' */
+static void editor_insert_end(void) {
+    if (!inserting || (insert_text.len == 0 && !insert_after_op)) {
+        inserting = 0;
+        editor_insert_drop_undo();
+        return;
+    }
+    inserting = 0;
+    if (insert_count > 1) {
+        editor_insert_text(insert_text.b, insert_text.len, insert_count - 1);
+        if (insert_before != NULL &&
+            undo_collapse(insert_mark, insert_x, insert_y, insert_before, insert_nbefore,
+                          E.cy - insert_y + 1) == 0) {
+            insert_before = NULL;
+            insert_nbefore = 0;
+        }
+    }
+    editor_insert_drop_undo();
+    
+    typed_text swap = last_text;
+    last_text = insert_text;
+    insert_text = swap;
+    if (insert_after_op) {
+        /* '.' runs the c again and types the same text */
+        last_change = CHANGE_OPERATOR;
+    } else {
+        last_change = CHANGE_INSERT;
+        last_count = insert_count;
+    }
+}
+
+/* Run a complete operator command */
+static void editor_run_operator(const operator_cmd *cmd) {
+    /* "cc" keeps its ABC meaning: just start inserting */
+    if (cmd->op == 'c' && cmd->key == 'c') {
+        E.mode = MODE_INSERT;
+        editor_insert_begin(cmd->count);
+        editor_set_status("-- INSERT --");
+        return;
+    }
+    if (operator_run(cmd) == -1 || cmd->op == 'y' || cmd->op == 'z') return;
+    
+    last_op = *cmd;
+    last_count = cmd->count;
+    if (cmd->op == 'c') {
+        /* The change is only complete once the typing ends */
+        last_change = CHANGE_NONE;
+        E.mode = MODE_INSERT;
+        editor_insert_begin(1);
+        insert_after_op = 1;
+        editor_set_status("-- INSERT --");
+    } else {
+        last_change = CHANGE_OPERATOR;
+    }
+}
+
+/* The key after 'z'. zf with a motion, or on the selection, and zF
+ * with a count make a fold; the others go to fold_command(). */
+static void editor_fold_key(int c) {
+    if (c == 'f' && E.mode == MODE_SELECTION) {
+        int y0 = E.sel_start_y < E.sel_end_y ? E.sel_start_y : E.sel_end_y;
+        int y1 = E.sel_start_y < E.sel_end_y ? E.sel_end_y : E.sel_start_y;
+        E.mode = MODE_NORMAL;
+        editor_selection_clear();
+        if (fold_create(y0, y1) == 0) E.cy = y0;
+    } else if (c == 'f') {
+        operator_begin('z', fold_count);
+    } else if (c == 'F') {
+        long last = E.cy + fold_count - 1;
+        fold_create(E.cy, last < E.numrows ? (int)last : E.numrows - 1);
+    } else {
+        fold_command(c, E.cy);
+    }
+}
+
+/* '.' on a c: replace its range with the text typed last time, as one
+ * undo step */
+static void editor_repeat_change_op(const operator_cmd *cmd) {
+    text_range r;
+    if (operator_range(cmd, &r) == -1) {
+        macro_replay_abort("motion failed");
+        return;
+    }
+    int ok = r.linewise ? editor_yank_lines(r.y0, r.y1 - r.y0 + 1)
+                        : register_yank(r.y0, r.x0, r.y1, r.x1);
+    if (ok == -1) {
+        editor_set_status("Memory allocation failed");
+        return;
+    }
+    editor_replace_range(r.y0, r.linewise ? 0 : r.x0, r.y1, r.x1, last_text.b ? last_text.b : "", last_text.len);
+    if (E.cx > 0) E.cx--;  /* As if ESC ended it */
+}
+
+/* '.': repeat the last change n times, or as many as it had if n is 0 */
+static void editor_repeat_change(long n) {
+    if (n > 0) last_count = n;
+    switch (last_change) {
+        case CHANGE_NONE:
+            editor_set_status("No previous change");
+            break;
+        case CHANGE_OPERATOR:
+            {
+                operator_cmd cmd = last_op;
+                cmd.count = last_count;
+                if (cmd.op == 'c') editor_repeat_change_op(&cmd);
+                else operator_run(&cmd);
+            }
+            break;
+        case CHANGE_PUT:
+            register_select(last_register);
+            editor_put(last_count, last_put_before);
+            break;
+        case CHANGE_INSERT:
+            editor_insert_text(last_text.b, last_text.len, last_count);
+            if (E.cx > 0) E.cx--;  /* As if ESC ended it */
+            break;
+    }
+}
+
+void editor_input_free(void) {
+    editor_free(MEM_MISC, last_text.b);
+    editor_free(MEM_MISC, insert_text.b);
+    memset(&last_text, 0, sizeof(last_text));
+    memset(&insert_text, 0, sizeof(insert_text));
+    editor_insert_drop_undo();
+    last_change = CHANGE_NONE;
+    inserting = 0;
+    count = 0;
+    operator_cancel();
+}
+
+/* Move the cursor to a motion's target; a motion that cannot move
+ * stops a running macro */
+static void editor_motion(int key, int arg, long n) {
+    motion_target t;
+    if (motion_target_of(key, arg, n, &t) == -1) {
+        macro_replay_abort("motion failed");
+        return;
+    }
+    if (motion_is_jump(key)) jump_push(E.cy, E.cx);
+    E.cy = t.y;
+    E.cx = t.x;
+    if (E.mode == MODE_SELECTION) {
+        editor_selection_update();
+    }
+}
+
+/* A NORMAL mode motion with multiple cursors moves each of them: it
+ * runs from every cursor in turn (keyed motions when arg is -1) */
+static void editor_cursors_motion(int key, int arg, long n) {
+    const cursor_pos *list = cursors_list();
+    for (int i = 0; i < cursors_count(); i++) {
+        E.cy = list[i].y;
+        E.cx = list[i].x;
+        if (arg == -1) editor_move_cursor_n(key, n);
+        else editor_motion(key, arg, n);
+        cursors_set(i, E.cy, E.cx);
+    }
+    cursors_settle();
+}
+
+/* Ctrl-O and Ctrl-I: steps entries back or forward in the jump list */
+static void editor_jump(long steps) {
+    int y, x;
+    if (E.numrows == 0 || jumps_go(steps, E.cy, E.cx, &y, &x) == -1) {
+        macro_replay_abort("no jump");
+        return;
+    }
+    E.cy = y < E.numrows ? y : E.numrows - 1;
+    E.cx = x < E.row[E.cy].size ? x : E.row[E.cy].size;
+}
+
+/* Set while editor_run_macro() is feeding keys */
+static int replay_running = 0;
+
+/* Handle the keys of the pushed macro until it ends or fails; the
+ * screen is not redrawn in between */
+static int editor_run_macro(void) {
+    int quit = 0;
+    replay_running = 1;
+    while (!quit && macro_replaying()) {
+        int c = macro_replay_next();
+        if (c == EKEY_NONE) break;
+        quit = editor_handle_key(c);
+    }
+    replay_running = 0;
+    return quit;
+}
+
+/* One key of a block insert */
+static void editor_handle_block_insert(int c) {
+    switch (c) {
+        case 27:  /* ESC and Enter apply the text */
+        case '\r':
+        case EKEY_ENTER:
+            if (block_insert == 'c') {
+                editor_block_change(block_text, block_len);
+            } else if (block_len > 0) {
+                editor_block_insert(block_text, block_len, block_insert == 'A');
+            }
+            block_insert = 0;
+            block_len = 0;
+            E.mode = MODE_NORMAL;
+            editor_selection_clear();
+            if (c == 27) {
+                editor_flush_keys();  /* Flush input buffer */
+            }
+            return;
+        case EKEY_BACKSPACE:
+        case 127:
+            if (block_len > 0) block_len--;
+            break;
+        default:
+            if (((c >= 32 && c <= 126) || c == '\t') &&
+                block_len < (int)sizeof(block_text) - 1) {
+                block_text[block_len++] = c;
+            }
+            break;
+    }
+    block_text[block_len] = '\0';
+    editor_set_status("-- BLOCK %s -- %s", block_insert == 'c' ? "CHANGE" : "INSERT", block_text);
+}
+
+/* One INSERT mode key with multiple cursors */
+static void editor_handle_cursors_key(int c) {
+    switch (c) {
+        case EKEY_NONE:
+            break;
+        case EKEY_BACKSPACE:
+        case 127:
+            cursors_delete(1, 0);
+            break;
+        case EKEY_LEFT:
+            cursors_move(-1);
+            break;
+        case EKEY_RIGHT:
+            cursors_move(1);
+            break;
+        case CTRL_KEY('z'):  /* Undo */
+            editor_undo();
+            cursors_clamp();
+            break;
+        case CTRL_KEY('y'):  /* Redo */
+            editor_redo();
+            cursors_clamp();
+            break;
+        case '\r':
+        case EKEY_ENTER:
+            editor_set_status("Line breaks are not supported with multiple cursors");
+            break;
+        default:
+            if ((c >= 32 && c <= 126) || c == '\t') {
+                char ch = (char)c;
+                cursors_insert(&ch, 1);
+            }
+            break;
+    }
+}
+
+/* Process keyboard input.
+ * Returns nonzero when the user asked to quit; the front end exits. */
+int editor_process_keypress() {
+    int c = editor_read_key(-1);
+    if (c == EKEY_NONE) return editor_handle_key(c);  /* Idle tick, not timed */
+
+    uint64_t start = stats_now();
+    int quit = editor_handle_key(c);
+    stats_timer_add(&S.keypress, start);
+    trace_key(c, start);
+    return quit;
+}
+
+/* Handle one key in the current mode; returns nonzero to quit */
+int editor_handle_key(int c) {
+    /* Ctrl-Shift-Q (Quit): works in all modes */
+    /* ncurses/PDCurses does not have a perfect portable code for Ctrl-Shift-Q,
+       but often Ctrl-Shift-Q is 17 (ASCII DC1, ^Q). Adjust if your terminal gives another code. */
+    if (c == 17) { /* Ctrl-Shift-Q or Ctrl-Q */
+        return 1;
+    }
+
+    /* The hex view has keys of its own outside the command line */
+    if (hex_state() && E.mode != MODE_COMMAND) return hex_key(c);
+
+    /* Register name after '"' (idle ticks keep waiting) */
+    if (awaiting_register && c != EKEY_NONE) {
+        awaiting_register = 0;
+        if (register_select(c) == -1) {
+            editor_set_status("Invalid register");
+        }
+        return 0;
+    }
+
+    /* Motion or text object after d, c or y; ESC cancels */
+    if (operator_pending() && c != EKEY_NONE) {
+        operator_cmd cmd;
+        if (operator_key(c, &cmd)) editor_run_operator(&cmd);
+        return 0;
+    }
+
+    /* Character to find after f, t, F or T; ESC cancels */
+    if (awaiting_find && c != EKEY_NONE) {
+        int key = awaiting_find;
+        awaiting_find = 0;
+        if (c != 27 && c > 0 && c < 0x100) {
+            if (E.mode == MODE_NORMAL && cursors_count() > 0) editor_cursors_motion(key, c, find_count);
+            else editor_motion(key, c, find_count);
+        }
+        return 0;
+    }
+
+    /* Mark name after 'm' */
+    if (awaiting_mark && c != EKEY_NONE) {
+        awaiting_mark = 0;
+        if (c != 27 && mark_set(c, E.cy, E.cx) == -1) {
+            editor_set_status("Marks are a-z");
+        }
+        return 0;
+    }
+
+    /* Fold command after 'z' */
+    if (awaiting_fold && c != EKEY_NONE) {
+        awaiting_fold = 0;
+        if (c != 27) editor_fold_key(c);
+        return 0;
+    }
+
+    /* Macro register after 'q' */
+    if (awaiting_record && c != EKEY_NONE) {
+        awaiting_record = 0;
+        if (macro_record_start(c) == -1) {
+            editor_set_status("Invalid register");
+        } else {
+            editor_set_status("recording @%c", c);
+        }
+        return 0;
+    }
+
+    /* Macro register after '@': run it, count times */
+    if (awaiting_macro && c != EKEY_NONE) {
+        long times = count > 0 ? count : 1;
+        awaiting_macro = 0;
+        count = 0;
+        if (macro_replay_push(c, times) == -1) {
+            if (!macro_replaying()) editor_set_status("Register @%c is empty", c);
+            return 0;
+        }
+        /* A macro run from a macro joins the replay already going */
+        if (replay_running) return 0;
+        return editor_run_macro();
+    }
+
+    /* Replacement character after 'r' */
+    if (awaiting_replace && c != EKEY_NONE) {
+        awaiting_replace = 0;
+        if (c >= 32 && c <= 126) {
+            editor_block_replace(c);
+        }
+        E.mode = MODE_NORMAL;
+        editor_selection_clear();
+        return 0;
+    }
+
+    /* Typing a block insert */
+    if (block_insert) {
+        if (c != EKEY_NONE) editor_handle_block_insert(c);
+        return 0;
+    }
+
+    /* Handle special keys for copy/paste/help */
+    if (c == CTRL_KEY('k')) {  /* Copy */
+        if (E.sel_start_x != -1) {
+            editor_copy_selection();
+            if (E.mode == MODE_SELECTION) {
+                editor_selection_clear();
+                E.mode = MODE_NORMAL;
+            }
+            return 0;
+        }
+    } else if (c == CTRL_KEY('v')) {  /* Paste */
+        inserting = 0;  /* Not replayed by '.' */
+        editor_paste();
+        return 0;
+    } else if (c == CTRL_KEY('h')) {  /* Help */
+        editor_set_status("HELP: cc=insert | Ctrl+Z=undo | Ctrl+Y=redo | Ctrl+A=select | Ctrl+K=copy");
+        return 0;
+    } else if (c == 8) {  /* Ctrl-Shift-H (often appears as ASCII BS, 8) */
+        editor_set_status("ABC Vi v0.0.3 - A difficult terminal-based text editor");
+        return 0;
+    }
+    
+    /* Handle ESC key to exit modes */
+    if (c == 27) {  /* ESC key */
+        /* For better responsiveness, immediately process ESC without checking for sequence */
+        if (E.mode != MODE_NORMAL) {
+            /* Save previous mode to handle cursor position correctly */
+            int prev_mode = E.mode;
+            
+            E.mode = MODE_NORMAL;
+            if (prev_mode == MODE_INSERT) editor_insert_end();
+            /* Move cursor back only if coming from INSERT mode */
+            if (prev_mode == MODE_INSERT && cursors_count() > 0)
+                cursors_move(-1);  /* All cursors back by one */
+            else if (prev_mode == MODE_INSERT && E.cx > 0 && E.numrows > 0)
+                E.cx--;  /* Move cursor back by one */
+            
+            E.commandbuf[0] = '\0';
+            E.commandlen = 0;
+            editor_selection_clear();
+            editor_set_status("-- NORMAL --");
+            
+            /* Clear any potential escape sequence that might be in the input buffer */
+            editor_flush_keys();  /* Flush input buffer */
+        } else {
+            /* In NORMAL mode ESC drops extra cursors */
+            if (cursors_count() > 0) {
+                cursors_clear();
+                editor_set_status("-- NORMAL --");
+            }
+            /* If already in NORMAL mode, just clear any escape sequence */
+            editor_flush_keys();  /* Flush input buffer */
+        }
+        return 0;
+    }
+    /* Handle key based on current mode */
+    switch (E.mode) {
+        case MODE_NORMAL:
+            /* Show NORMAL mode status */
+            editor_set_status("-- NORMAL --");
+            if (c == EKEY_NONE) break;
+            
+            /* Count prefix; '0' alone still goes to the line start */
+            if ((c >= '1' && c <= '9') || (c == '0' && count > 0)) {
+                if (count < 100000000) count = count * 10 + (c - '0');
+                break;
+            }
+            /* The count carries over '"x' to the command after it */
+            long typed = count;
+            long n = count > 0 ? count : 1;
+            if (c != '@' && c != '"') {
+                count = 0;
+            }
+            
+            switch (c) {
+/* ... */
+                case 'c':  /* Operators; "cc" enters insert mode (ABC Vi style) */
+                case 'd':
+                case 'y':
+                case '=':
+                    operator_begin(c, n);
+                    break;
+                case 'z':  /* Folds */
+                    awaiting_fold = 1;
+                    fold_count = n;
+                    break;
+                case 'm':  /* Set a mark */
+                    awaiting_mark = 1;
+                    break;
+                case CTRL_KEY('o'):  /* Back and forward in the jump list */
+                    editor_jump(-n);
+                    break;
+                case '\t':  /* Ctrl-I */
+                    editor_jump(n);
+                    break;
+                case ':':
+                    /* Enter command mode and reset command buffer */
+                    E.mode = MODE_COMMAND;
+                    E.commandbuf[0] = ':';
+                    E.commandlen = 1;
+                    E.commandbuf[E.commandlen] = '\0';
+                    editor_set_status(":");
+                    break;
+                case 'x':  /* Delete characters from the cursor: dl */
+                case 'X':  /* Delete characters before it: dh */
+                case 'D':  /* Delete to the end of the line: d$ */
+                case 'C':  /* Change to the end of the line: c$ */
+                case 'Y':  /* Yank lines: yy */
+                    if (c == 'x' && cursors_count() > 0) {
+                        cursors_delete(0, 1);
+                    } else {
+                        operator_cmd cmd;
+                        cmd.op = (c == 'C') ? 'c' : (c == 'Y') ? 'y' : 'd';
+                        cmd.key = (c == 'x') ? 'l' : (c == 'X') ? 'h' : (c == 'Y') ? 'y' : '$';
+                        cmd.arg = 0;
+                        cmd.count = n;
+                        editor_run_operator(&cmd);
+                    }
+                    break;
+                case '.':  /* Repeat the last change */
+                    editor_repeat_change(typed);
+                    break;
+                case CTRL_KEY('a'):  /* Select all */
+                    editor_select_all();
+                    E.mode = MODE_SELECTION;
+                    break;
+                case CTRL_KEY('k'):  /* Copy */
+                    if (E.sel_start_x != -1) {
+                        editor_copy_selection();
+                        editor_selection_clear();
+                    } else {
+                        editor_set_status("No selection to copy");
+                    }
+                    break;
+                case 'p':  /* Put, n times; lines go below the cursor's */
+                case 'P':  /* Lines go above it */
+                    last_register = register_pending();
+                    last_put_before = c == 'P';
+                    editor_put(n, last_put_before);
+                    last_change = CHANGE_PUT;
+                    last_count = n;
+                    break;
+                case '"':  /* Select register for the next yank or put */
+                    awaiting_register = 1;
+                    break;
+                case 'q':  /* Start or stop recording a macro */
+                    if (macro_recording()) {
+                        macro_record_stop();
+                        editor_set_status("-- NORMAL --");
+                    } else if (!macro_replaying()) {
+                        awaiting_record = 1;
+                    }
+                    break;
+                case '@':  /* Run a macro */
+                    awaiting_macro = 1;
+                    break;
+                case CTRL_KEY('z'):  /* Undo */
+                    editor_undo();
+                    break;
+                case CTRL_KEY('y'):  /* Redo */
+                    editor_redo();
+                    break;
+                case 'v':  /* Visual (selection) mode */
+                    E.mode = MODE_SELECTION;
+                    editor_selection_start();
+                    editor_set_status("-- VISUAL --");
+                    break;
+                case CTRL_KEY('b'):  /* Block visual mode */
+                    E.mode = MODE_SELECTION;
+                    editor_selection_start();
+                    E.sel_block = 1;
+                    editor_set_status("-- VISUAL BLOCK --");
+                    break;
+                case EKEY_LEFT:
+                case EKEY_RIGHT:
+                case EKEY_UP:
+                case EKEY_DOWN:
+                case 'h':
+                case 'j':
+                case 'k':
+                case 'l':
+                case EKEY_HOME:
+                case EKEY_END:
+                case EKEY_PPAGE:
+                case EKEY_NPAGE:
+                case '0':
+                case '$':
+                    if (cursors_count() > 0) editor_cursors_motion(c, -1, n);
+                    else editor_move_cursor_n(c, n);
+                    break;
+                case '\r':  /* Enter key */
+                case EKEY_ENTER: /* Some terminals send EKEY_ENTER instead */
+                    E.mode = MODE_INSERT;
+                    editor_insert_begin(n);
+                    editor_set_status("-- INSERT --");
+                    break;
+                /* Font size changes using Ctrl+Shift++ and Ctrl+Shift+- */
+                case 43:  /* '+' key (may require different handling in some terminals) */
+                    editor_change_font_size(1);
+                    break;
+                case 45:  /* '-' key */
+                    editor_change_font_size(-1);
+                    break;
+                default:
+                    /* Word, paragraph, bracket and find motions */
+                    if (motion_needs_char(c)) {
+                        awaiting_find = c;
+                        find_count = n;
+                    } else if (motion_is_key(c) && cursors_count() > 0) {
+                        editor_cursors_motion(c, 0, n);
+                    } else if (motion_is_key(c)) {
+                        editor_motion(c, 0, n);
+                    }
+                    break;
+            }
+            break;
+            
+        case MODE_INSERT:
+            /* With multiple cursors, edits go to all of them */
+            if (cursors_count() > 0) {
+                editor_handle_cursors_key(c);
+                break;
+            }
+            switch (c) {
+                case 27:  /* ESC key - already handled above */
+                    /* This should not be reached in normal cases */
+                    break;
+
+                /* Ctrl-C: Leave insert mode (like ESC) */
+                case 3: /* Ctrl-C */
+                    {
+                        int prev_mode = E.mode;
+                        E.mode = MODE_NORMAL;
+                        editor_insert_end();
+                        /* Move cursor back only if coming from INSERT mode */
+                        if (prev_mode == MODE_INSERT && E.cx > 0 && E.numrows > 0)
+                            E.cx--;  /* Move cursor back by one */
+                        E.commandbuf[0] = '\0';
+                        E.commandlen = 0;
+                        editor_selection_clear();
+                        editor_set_status("-- NORMAL --");
+                    }
+                    break;
+                /* No F1 key handling - use only ESC to exit insert mode */
+                case EKEY_BACKSPACE:
+                case 127:  /* Also backspace on some terminals */
+                    if (E.cx > 0 || E.cy > 0)
+                        editor_del_char();
+                    /* Deleting text from before the insert ends the capture */
+                    if (insert_text.len > 0) insert_text.len--;
+                    else inserting = 0;
+                    break;
+                case EKEY_LEFT:
+                case EKEY_RIGHT:
+                case EKEY_UP:
+                case EKEY_DOWN:
+                case EKEY_HOME:
+                case EKEY_END:
+                case EKEY_PPAGE:
+                case EKEY_NPAGE:
+                    editor_move_cursor(c);
+                    inserting = 0;
+                    break;
+                case CTRL_KEY('k'):  /* Copy (legacy, keep for compatibility) */
+                    if (E.sel_start_x != -1) {
+                        editor_copy_selection();
+                        editor_selection_clear();
+                    }
+                    break;
+                case CTRL_KEY('v'):  /* Paste */
+                    editor_paste();
+                    break;
+                case CTRL_KEY('z'):  /* Undo */
+                    editor_undo();
+                    inserting = 0;
+                    break;
+                case CTRL_KEY('y'):  /* Redo */
+                    editor_redo();
+                    inserting = 0;
+                    break;
+                case '\r':  /* Enter key */
+                case EKEY_ENTER: /* Some terminals send EKEY_ENTER instead */
+                    editor_insert_newline();
+                    editor_insert_record('\n');
+                    {
+                        /* Auto-indent; recorded so '.' types it too */
+                        char indent[256];
+                        int len = indent_newline(indent, sizeof(indent));
+                        if (len > 0) {
+                            editor_insert_text(indent, len, 1);
+                            for (int i = 0; i < len; i++) editor_insert_record(indent[i]);
+                        }
+                    }
+                    break;
+                default:
+                    /* Accept all printable ASCII and Tab in insert mode */
+                    if ((c >= 32 && c <= 126) || c == '\t') {
+                        editor_insert_char(c);
+                        editor_insert_record(c);
+                        if (indent_electric()) editor_insert_rerecord_line();
+                    }
+                    break;
+            }
+            break;
+            
+        case MODE_COMMAND:
+            switch (c) {
+                case ':': /* Enter command mode */
+                    E.mode = MODE_COMMAND;
+                    memset(E.commandbuf, 0, sizeof(E.commandbuf));  /* Clear entire buffer */
+                    E.commandbuf[0] = '\0';  /* Ensure null termination */
+                    E.commandlen = 0;
+                    break;
+                case 27:  /* ESC key */
+                    E.mode = MODE_NORMAL;
+                    memset(E.commandbuf, 0, sizeof(E.commandbuf));  /* Clear entire buffer */
+                    E.commandbuf[0] = '\0';  /* Ensure null termination */
+                    E.commandlen = 0;
+                    E.statusmsg[0] = '\0';
+                    break;
+                case '\r':  /* Enter key */
+                case EKEY_ENTER: /* Some terminals send EKEY_ENTER instead */
+                    if (E.commandlen > 0) {
+                        /* Process command (includes validation and prefix handling) */
+                        if (editor_process_command() == EDITOR_CMD_QUIT) {
+                            return 1;  /* Quit if command requested */
+                        }
+                    }
+                    /* Always return to normal mode after command */
+                    E.mode = MODE_NORMAL;
+                    memset(E.commandbuf, 0, sizeof(E.commandbuf));  /* Clear entire buffer */
+                    E.commandbuf[0] = '\0';  /* Ensure null termination */
+                    E.commandlen = 0;
+                    break;
+                case EKEY_BACKSPACE:
+                case 127:  /* Also backspace on some terminals */
+                    if (E.commandlen > 0) {
+                        E.commandlen--;
+                        E.commandbuf[E.commandlen] = '\0';
+                    }
+                    break;
+                default:
+                    /* Add character to command buffer if printable ASCII (32-126) */
+                    if (c >= 32 && c <= 126 && E.commandlen < (int)sizeof(E.commandbuf) - 1) {
+                        /* Special handling for colon character */
+                        if (c == ':') {
+                            /* If this is the first character, add it normally */
+                            if (E.commandlen == 0) {
+                                E.commandbuf[E.commandlen++] = c;
+                            }
+                            /* Otherwise, don't add multiple colons at the start */
+                            else if (E.commandbuf[0] == ':' && E.commandlen == 1) {
+                                /* Skip adding another colon */
+                            }
+                            /* For other positions, add normally */
+                            else {
+                                E.commandbuf[E.commandlen++] = c;
+                            }
+                        } else {
+                            /* Normal character - add it */
+                            E.commandbuf[E.commandlen++] = c;
+                        }
+                        E.commandbuf[E.commandlen] = '\0';
+                    }
+                    break;
+            }
+            break;
+            
+        case MODE_SELECTION:
+            switch (c) {
+                case 27:  /* ESC key */
+                    E.mode = MODE_NORMAL;
+                    editor_selection_clear();
+                    editor_set_status("-- NORMAL --");
+                    break;
+                case CTRL_KEY('k'):  /* Copy */
+                    editor_copy_selection();
+                    E.mode = MODE_NORMAL;
+                    editor_selection_clear();
+                    break;
+                case 'y':  /* Yank (copy) */
+                    editor_copy_selection();
+                    E.mode = MODE_NORMAL;
+                    editor_selection_clear();
+                    break;
+                case 'd':  /* Delete selection */
+                case 'x':
+                    editor_delete_selection();
+                    E.mode = MODE_NORMAL;
+                    editor_selection_clear();
+                    break;
+                case '"':  /* Select register for the next yank or delete */
+                    awaiting_register = 1;
+                    break;
+                case CTRL_KEY('n'):  /* A cursor on every selected line */
+                    {
+                        int y0 = E.sel_start_y < E.sel_end_y ? E.sel_start_y : E.sel_end_y;
+                        int y1 = E.sel_start_y < E.sel_end_y ? E.sel_end_y : E.sel_start_y;
+                        int n = cursors_add_lines(y0, y1, E.cx);
+                        E.mode = MODE_NORMAL;
+                        editor_selection_clear();
+                        editor_set_status("%d cursors (cc to insert, ESC to drop)", n);
+                    }
+                    break;
+                case CTRL_KEY('b'):  /* Switch between stream and block */
+                    E.sel_block = !E.sel_block;
+                    editor_set_status(E.sel_block ? "-- VISUAL BLOCK --" : "-- VISUAL --");
+                    break;
+                case 'I':  /* Block: insert before, append after, change */
+                case 'A':
+                case 'c':
+                    if (E.sel_block) {
+                        block_insert = c;
+                        block_len = 0;
+                        block_text[0] = '\0';
+                        editor_set_status("-- BLOCK %s --", c == 'c' ? "CHANGE" : "INSERT");
+                    }
+                    break;
+                case 'r':  /* Block: replace every character */
+                    if (E.sel_block) awaiting_replace = 1;
+                    break;
+                case 'z':  /* zf folds the selected lines */
+                    awaiting_fold = 1;
+                    fold_count = 1;
+                    break;
+                case '=':  /* Reindent the selected lines */
+                    {
+                        int y0 = E.sel_start_y < E.sel_end_y ? E.sel_start_y : E.sel_end_y;
+                        int y1 = E.sel_start_y < E.sel_end_y ? E.sel_end_y : E.sel_start_y;
+                        int n = editor_reindent(y0, y1);
+                        editor_selection_clear();
+                        E.mode = MODE_NORMAL;
+                        E.cy = y0;
+                        if (n >= 0) editor_set_status("%d lines reindented", n);
+                    }
+                    break;
+                case EKEY_LEFT:
+                case EKEY_RIGHT:
+                case EKEY_UP:
+                case EKEY_DOWN:
+                case 'h':
+                case 'j':
+                case 'k':
+                case 'l':
+                case EKEY_HOME:
+                case EKEY_END:
+                case EKEY_PPAGE:
+                case EKEY_NPAGE:
+                case '0':
+                case '$':
+                    editor_move_cursor(c);
+                    editor_selection_update();
+                    break;
+                default:
+                    if (motion_needs_char(c)) {
+                        awaiting_find = c;
+                        find_count = 1;
+                    } else if (motion_is_key(c)) {
+                        editor_motion(c, 0, 1);
+                    }
+                    break;
+            }
+            break;
+    }
+    
+    return 0;
+}
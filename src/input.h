@@ -0,0 +1,77 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Input backend interface.
+ *
+ * editor_process_keypress() reads keys through an input_backend instead
+ * of calling getch() directly. The terminal front end translates ncurses
+ * key codes to the EKEY_* codes below; the benchmark drivers feed keys
+ * from recorded scripts.
+ */
+
+#ifndef ABCZED_INPUT_H
+#define ABCZED_INPUT_H
+
+/* Define key codes */
+#define CTRL_KEY(k) ((k) & 0x1f)
+
+/* No key arrived within the timeout */
+#define EKEY_NONE (-1)
+
+/* Special keys (plain keys are their ASCII code) */
+enum editor_key {
+    EKEY_LEFT = 0x100,
+    EKEY_RIGHT,
+    EKEY_UP,
+    EKEY_DOWN,
+    EKEY_HOME,
+    EKEY_END,
+    EKEY_PPAGE,
+    EKEY_NPAGE,
+    EKEY_ENTER,
+    EKEY_BACKSPACE
+};
+
+/* Key source provided by a front end */
+typedef struct input_backend {
+    /* Return the next key, or EKEY_NONE if none arrives within timeout_ms.
+     * A negative timeout means the backend's normal idle wait. */
+    int (*read_key)(int timeout_ms);
+} input_backend;
+
+/* Select the backend used by editor_read_key() */
+void input_set_backend(const input_backend *backend);
+
+/* Read a key: pushed-back keys first, then keys of a running macro,
+ * then the backend */
+int editor_read_key(int timeout_ms);
+void editor_unread_key(int c);
+
+/* Drop pushed-back keys and whatever the terminal has already sent (the
+ * rest of an escape sequence); a running macro's keys are kept */
+void editor_flush_keys(void);
+
+/* Key handling (input.c). editor_move_cursor() returns -1 when the
+ * motion could not move, which also stops a running macro;
+ * editor_move_cursor_n() repeats it for a count and fails only if the
+ * cursor did not move at all. */
+int editor_move_cursor(int key);
+int editor_move_cursor_n(int key, long n);
+int editor_process_keypress(void);
+int editor_handle_key(int c);
+void editor_input_free(void);
+
+/* Macros (macro.c). Replay runs inside one keypress; a failed motion
+ * aborts it. */
+int macro_record_start(int name);
+void macro_record_stop(void);
+int macro_recording(void);
+void macro_record_key(int c);
+int macro_replay_push(int name, long count);
+int macro_replay_next(void);
+int macro_replaying(void);
+void macro_replay_abort(const char *why);
+void macros_free(void);
+
+#endif /* ABCZED_INPUT_H */
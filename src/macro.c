@@ -0,0 +1,154 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Keyboard macros: q<reg> records, [N]@<reg> replays.
+ *
+ * Recording keeps every key read from the input backend. Replay feeds
+ * the keys back through editor_read_key() from a stack of frames, one
+ * per running macro, so a macro can run another (or itself) without C
+ * recursion. The key handler runs the whole replay inside one keypress,
+ * so the screen is drawn once when it ends rather than once per key.
+ */
+
+#include "abczed.h"
+#include "input.h"
+
+#include <string.h>
+
+#define MACRO_COUNT     26
+#define MACRO_MAX_DEPTH 64
+
+typedef struct macro {
+    int *keys;
+    int len, cap;
+} macro;
+
+static macro macros[MACRO_COUNT];
+static macro rec;                   /* Keys of the recording in progress */
+static int recording = 0;           /* Register being recorded, or 0 */
+
+/* A running macro: its keys, the next one, and how many runs are left */
+typedef struct replay_frame {
+    const macro *m;
+    int pos;
+    long reps;
+} replay_frame;
+
+static replay_frame frames[MACRO_MAX_DEPTH];
+static int depth = 0;
+
+static macro *macro_get(int name) {
+    if (name >= 'a' && name <= 'z') return &macros[name - 'a'];
+    if (name >= 'A' && name <= 'Z') return &macros[name - 'A'];
+    return NULL;
+}
+
+int macro_record_start(int name) {
+    if (macro_get(name) == NULL || depth > 0) return -1;
+    rec.len = 0;
+    recording = name;
+    return 0;
+}
+
+/* Append n keys to m */
+static int macro_append(macro *m, const int *keys, int n) {
+    if (m->len + n > m->cap) {
+        int cap = m->cap ? m->cap : 64;
+        while (cap < m->len + n) cap *= 2;
+        int *grown = editor_realloc(MEM_MISC, m->keys, sizeof(int) * cap);
+        if (grown == NULL) return -1;
+        m->keys = grown;
+        m->cap = cap;
+    }
+    memcpy(m->keys + m->len, keys, sizeof(int) * n);
+    m->len += n;
+    return 0;
+}
+
+/* The register only takes the keys when recording stops, so "qa...@aq"
+ * runs the old contents of a, not the half-recorded ones */
+void macro_record_stop(void) {
+    macro *m = macro_get(recording);
+    /* The 'q' that stopped the recording was recorded too */
+    if (rec.len > 0) rec.len--;
+    if (recording >= 'A' && recording <= 'Z') {
+        /* "qA" appends to register a, like yanking into "A */
+        if (macro_append(m, rec.keys, rec.len) == -1) {
+            editor_set_status("Error: Out of memory");
+        }
+    } else {
+        macro swap = *m;
+        *m = rec;
+        rec = swap;
+    }
+    rec.len = 0;
+    recording = 0;
+}
+
+int macro_recording(void) {
+    return recording;
+}
+
+void macro_record_key(int c) {
+    if (recording == 0 || depth > 0) return;
+    if (macro_append(&rec, &c, 1) == -1) {
+        editor_set_status("Error: Out of memory, recording stopped");
+        recording = 0;
+    }
+}
+
+int macro_replay_push(int name, long count) {
+    const macro *m = macro_get(name);
+    if (m == NULL || m->len == 0 || count < 1) return -1;
+
+    /* Frames that have run out are dropped first, so a macro that ends by
+     * calling itself does not grow the stack */
+    while (depth > 0 && frames[depth - 1].pos == frames[depth - 1].m->len &&
+           frames[depth - 1].reps == 1) {
+        depth--;
+    }
+    if (depth == MACRO_MAX_DEPTH) {
+        macro_replay_abort("Macros nested too deeply");
+        return -1;
+    }
+    frames[depth].m = m;
+    frames[depth].pos = 0;
+    frames[depth].reps = count;
+    depth++;
+    return 0;
+}
+
+int macro_replay_next(void) {
+    while (depth > 0) {
+        replay_frame *f = &frames[depth - 1];
+        if (f->pos < f->m->len) return f->m->keys[f->pos++];
+        if (--f->reps > 0) {
+            f->pos = 0;
+            continue;
+        }
+        depth--;
+    }
+    return EKEY_NONE;
+}
+
+int macro_replaying(void) {
+    return depth > 0;
+}
+
+void macro_replay_abort(const char *why) {
+    if (depth == 0) return;
+    depth = 0;
+    editor_set_status("Macro stopped: %s", why);
+}
+
+void macros_free(void) {
+    for (int i = 0; i < MACRO_COUNT; i++) {
+        editor_free(MEM_MISC, macros[i].keys);
+        memset(&macros[i], 0, sizeof(macros[i]));
+    }
+    editor_free(MEM_MISC, rec.keys);
+    memset(&rec, 0, sizeof(rec));
+    recording = 0;
+    depth = 0;
+}
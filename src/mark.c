@@ -0,0 +1,99 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Marks and the jump list.
+ *
+ * Both are handles into the tracked positions of anchor.c, so they move
+ * with their lines as rows are inserted and deleted above them.
+ *
+ * Before a jump (a mark, %, { or }) the cursor position is appended to
+ * the jump list, dropping any older entry on the same line, and becomes
+ * the context mark that '' and `` return to. Ctrl-O walks back through
+ * the list and Ctrl-I forward again.
+ */
+
+#include "abczed.h"
+
+#include <string.h>
+
+#define JUMPS_MAX 100
+
+static int marks[26];
+static int context = -1;
+static int jumps[JUMPS_MAX];
+static int njumps, jump_pos;
+static int marks_ready;
+
+static void marks_init(void) {
+    if (marks_ready) return;
+    for (int i = 0; i < 26; i++) marks[i] = -1;
+    marks_ready = 1;
+}
+
+void marks_free(void) {
+    marks_init();
+    for (int i = 0; i < 26; i++) {
+        anchor_free(marks[i]);
+        marks[i] = -1;
+    }
+    anchor_free(context);
+    context = -1;
+    for (int i = 0; i < njumps; i++) anchor_free(jumps[i]);
+    njumps = jump_pos = 0;
+}
+
+/* Point *h at (y, x), creating its anchor if needed */
+static int track(int *h, int y, int x) {
+    if (*h >= 0 && anchor_set(*h, y, x) == 0) return 0;
+    *h = anchor_new(y, x);
+    return *h >= 0 ? 0 : -1;
+}
+
+int mark_set(int name, int y, int x) {
+    marks_init();
+    if (name < 'a' || name > 'z') return -1;
+    return track(&marks[name - 'a'], y, x);
+}
+
+int mark_get(int name, int *y, int *x) {
+    marks_init();
+    if (name == '\'' || name == '`') return anchor_get(context, y, x);
+    if (name < 'a' || name > 'z') return -1;
+    return anchor_get(marks[name - 'a'], y, x);
+}
+
+void jump_push(int y, int x) {
+    track(&context, y, x);
+
+    int kept = 0;
+    for (int i = 0; i < njumps; i++) {
+        int jy, jx;
+        if (anchor_get(jumps[i], &jy, &jx) == 0 && jy != y) {
+            jumps[kept++] = jumps[i];
+        } else {
+            anchor_free(jumps[i]);
+        }
+    }
+    njumps = kept;
+    if (njumps == JUMPS_MAX) {
+        anchor_free(jumps[0]);
+        memmove(&jumps[0], &jumps[1], sizeof(int) * (JUMPS_MAX - 1));
+        njumps--;
+    }
+    int h = anchor_new(y, x);
+    if (h >= 0) jumps[njumps++] = h;
+    jump_pos = njumps;
+}
+
+int jumps_go(long steps, int y, int x, int *py, int *px) {
+    /* Going back from the newest entry first saves where we are */
+    if (steps < 0 && jump_pos == njumps) {
+        jump_push(y, x);
+        jump_pos = njumps - 1;
+    }
+    long to = jump_pos + steps;
+    if (to < 0 || to >= njumps) return -1;
+    jump_pos = (int)to;
+    return anchor_get(jumps[jump_pos], py, px);
+}
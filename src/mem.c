@@ -0,0 +1,216 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Tagged allocator.
+ */
+
+#include "abczed.h"
+#include "mem.h"
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Size of a block as the allocator sees it. glibc and macOS can report
+ * it for any pointer; elsewhere each block carries a small header. */
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define BLOCK_SIZE(p) malloc_usable_size(p)
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define BLOCK_SIZE(p) malloc_size(p)
+#else
+#define MEM_HEADER
+typedef union mem_header {
+    size_t size;
+    long double align_ld;
+    void *align_p;
+} mem_header;
+#endif
+
+static mem_tag_stats tags[MEM_TAG_COUNT];
+
+static const char *tag_names[MEM_TAG_COUNT] = {
+    "row text", "row array", "undo", "registers", "render", "misc", "index"
+};
+
+static void account_alloc(enum mem_tag tag, size_t requested, size_t usable) {
+    mem_tag_stats *t = &tags[tag];
+    t->allocs++;
+    t->alloc_bytes += requested;
+    t->live_blocks++;
+    t->live_bytes += usable;
+    if (t->live_bytes > t->peak_bytes) t->peak_bytes = t->live_bytes;
+}
+
+static void account_free(enum mem_tag tag, size_t usable) {
+    mem_tag_stats *t = &tags[tag];
+    t->frees++;
+    t->live_blocks--;
+    t->live_bytes -= usable;
+}
+
+#ifdef MEM_HEADER
+
+void *editor_malloc(enum mem_tag tag, size_t size) {
+    mem_header *h = malloc(sizeof(mem_header) + size);
+    if (!h) return NULL;
+    h->size = size;
+    account_alloc(tag, size, size);
+    return h + 1;
+}
+
+void *editor_realloc(enum mem_tag tag, void *ptr, size_t size) {
+    if (!ptr) return editor_malloc(tag, size);
+    mem_header *h = (mem_header *)ptr - 1;
+    size_t old = h->size;
+    h = realloc(h, sizeof(mem_header) + size);
+    if (!h) return NULL;
+    h->size = size;
+    /* A resize counts as one allocation, not an alloc/free pair */
+    tags[tag].live_blocks--;
+    tags[tag].live_bytes -= old;
+    account_alloc(tag, size, size);
+    return h + 1;
+}
+
+void editor_free(enum mem_tag tag, void *ptr) {
+    if (!ptr) return;
+    mem_header *h = (mem_header *)ptr - 1;
+    account_free(tag, h->size);
+    free(h);
+}
+
+#else
+
+void *editor_malloc(enum mem_tag tag, size_t size) {
+    void *p = malloc(size);
+    if (p) account_alloc(tag, size, BLOCK_SIZE(p));
+    return p;
+}
+
+void *editor_realloc(enum mem_tag tag, void *ptr, size_t size) {
+    size_t old = ptr ? BLOCK_SIZE(ptr) : 0;
+    void *p = realloc(ptr, size);
+    if (!p) return NULL;
+    /* A resize counts as one allocation, not an alloc/free pair */
+    if (ptr) {
+        tags[tag].live_blocks--;
+        tags[tag].live_bytes -= old;
+    }
+    account_alloc(tag, size, BLOCK_SIZE(p));
+    return p;
+}
+
+void editor_free(enum mem_tag tag, void *ptr) {
+    if (!ptr) return;
+    account_free(tag, BLOCK_SIZE(ptr));
+    free(ptr);
+}
+
+#endif
+
+char *editor_strdup(enum mem_tag tag, const char *s) {
+    size_t len = strlen(s) + 1;
+    char *new = editor_malloc(tag, len);
+    if (new == NULL) return NULL;
+    return (char *)memcpy(new, s, len);
+}
+
+const mem_tag_stats *mem_stats(enum mem_tag tag) {
+    return &tags[tag];
+}
+
+const char *mem_tag_name(enum mem_tag tag) {
+    return tag_names[tag];
+}
+
+void mem_totals(mem_tag_stats *out) {
+    memset(out, 0, sizeof(*out));
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        out->live_blocks += tags[i].live_blocks;
+        out->live_bytes += tags[i].live_bytes;
+        out->peak_bytes += tags[i].peak_bytes;
+        out->allocs += tags[i].allocs;
+        out->frees += tags[i].frees;
+        out->alloc_bytes += tags[i].alloc_bytes;
+    }
+}
+
+void mem_reset_counters(void) {
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        tags[i].allocs = 0;
+        tags[i].frees = 0;
+        tags[i].alloc_bytes = 0;
+        tags[i].peak_bytes = tags[i].live_bytes;
+    }
+}
+
+/* Characters stored in the buffer, without terminators */
+static uint64_t text_bytes(void) {
+    uint64_t n = 0;
+    for (int i = 0; i < E.numrows; i++) n += (uint64_t)E.row[i].size;
+    return n;
+}
+
+void mem_summary(char *buf, size_t size) {
+    mem_tag_stats total;
+    char all[16], text[16], rows[16], undo[16], clip[16];
+
+    mem_totals(&total);
+    stats_format_bytes(all, sizeof(all), total.live_bytes);
+    stats_format_bytes(text, sizeof(text), tags[MEM_ROW_TEXT].live_bytes);
+    stats_format_bytes(rows, sizeof(rows), tags[MEM_ROW_ARRAY].live_bytes);
+    stats_format_bytes(undo, sizeof(undo), tags[MEM_UNDO].live_bytes);
+    stats_format_bytes(clip, sizeof(clip), tags[MEM_REGISTERS].live_bytes);
+    snprintf(buf, size, "mem %s: text %s rows %s undo %s regs %s, %lu blocks",
+             all, text, rows, undo, clip, total.live_blocks);
+}
+
+void mem_write_report(FILE *fp) {
+    mem_tag_stats total;
+    char live[16], peak[16], req[16];
+
+    fprintf(fp, "memory:\n");
+    fprintf(fp, "  %-10s %10s %10s %10s %10s %10s %10s\n",
+            "", "live", "blocks", "peak", "allocs", "frees", "requested");
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        const mem_tag_stats *t = &tags[i];
+        stats_format_bytes(live, sizeof(live), t->live_bytes);
+        stats_format_bytes(peak, sizeof(peak), t->peak_bytes);
+        stats_format_bytes(req, sizeof(req), t->alloc_bytes);
+        fprintf(fp, "  %-10s %10s %10lu %10s %10lu %10lu %10s\n",
+                tag_names[i], live, t->live_blocks, peak, t->allocs, t->frees, req);
+    }
+    mem_totals(&total);
+    stats_format_bytes(live, sizeof(live), total.live_bytes);
+    stats_format_bytes(req, sizeof(req), total.alloc_bytes);
+    fprintf(fp, "  %-10s %10s %10lu %10s %10lu %10lu %10s\n",
+            "total", live, total.live_blocks, "", total.allocs, total.frees, req);
+
+    /* What a line costs beyond its characters: its erow slot (including
+     * unused capacity of the row array) and the row block's terminator
+     * and malloc rounding */
+    if (E.numrows > 0) {
+        uint64_t text = text_bytes();
+        uint64_t held = tags[MEM_ROW_TEXT].live_bytes + tags[MEM_ROW_ARRAY].live_bytes;
+        stats_format_bytes(live, sizeof(live), text);
+        fprintf(fp, "  text       %10s in %d lines, %.1f bytes/line overhead\n",
+                live, E.numrows, held > text ? (double)(held - text) / E.numrows : 0.0);
+    }
+}
+
+unsigned long mem_write_leaks(FILE *fp) {
+    unsigned long blocks = 0;
+    char live[16];
+
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        if (tags[i].live_blocks == 0) continue;
+        stats_format_bytes(live, sizeof(live), tags[i].live_bytes);
+        fprintf(fp, "leak: %s: %lu blocks, %s still live\n",
+                tag_names[i], tags[i].live_blocks, live);
+        blocks += tags[i].live_blocks;
+    }
+    return blocks;
+}
@@ -0,0 +1,53 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Per-subsystem memory accounting.
+ *
+ * Every allocation in the core goes through editor_malloc() and friends
+ * (declared in abczed.h) with a tag naming the subsystem that owns it.
+ * Live bytes are the allocator's usable size of each block, so malloc
+ * rounding shows up as overhead against the text actually stored.
+ * ":mem" shows a summary, and the --stats-on-exit report includes the
+ * full breakdown plus anything still live after the editor state is
+ * freed.
+ */
+
+#ifndef ABCZED_MEM_H
+#define ABCZED_MEM_H
+
+#include "abczed.h"
+
+#include <stdint.h>
+#include <stdio.h>
+
+/* Counters for one tag */
+typedef struct mem_tag_stats {
+    unsigned long live_blocks;
+    uint64_t live_bytes;
+    uint64_t peak_bytes;            /* Highest live_bytes seen */
+    unsigned long allocs;           /* malloc/realloc calls */
+    unsigned long frees;            /* Frees of non-NULL pointers */
+    uint64_t alloc_bytes;           /* Bytes requested, cumulative */
+} mem_tag_stats;
+
+const mem_tag_stats *mem_stats(enum mem_tag tag);
+const char *mem_tag_name(enum mem_tag tag);
+
+/* Sum over all tags */
+void mem_totals(mem_tag_stats *out);
+
+/* Clear the cumulative counters; live bytes are kept, peaks restart at
+ * the live value */
+void mem_reset_counters(void);
+
+/* One-line summary for the status line */
+void mem_summary(char *buf, size_t size);
+
+/* Per-tag table plus per-line overhead */
+void mem_write_report(FILE *fp);
+
+/* Tags with blocks still live; returns the number of leaked blocks */
+unsigned long mem_write_leaks(FILE *fp);
+
+#endif /* ABCZED_MEM_H */
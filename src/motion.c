@@ -0,0 +1,370 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Word, paragraph, bracket, find-character and CSV field motions.
+ */
+
+#include "abczed.h"
+#include "motion.h"
+
+#include <string.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+/* Scanning a WORD: every class but blank */
+#define CHAR_NONBLANK 3
+
+/* 0 blank, 1 punctuation, 2 word. Bytes from 0x80 up are word
+ * characters, so UTF-8 letters join the words around them. */
+static const unsigned char class_table[256] = {
+    1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+    0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1, 1,
+    1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 2,
+    1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 1, 1, 1, 1,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+};
+
+/* Last f, t, F or T and its character, for ';' and ',' */
+static int last_find_key = 0;
+static int last_find_char = 0;
+
+int char_class(int c) {
+    return class_table[(unsigned char)c];
+}
+
+static int in_class(char ch, int cls) {
+    int c = class_table[(unsigned char)ch];
+    return cls == CHAR_NONBLANK ? c != CHAR_BLANK : c == cls;
+}
+
+#ifdef __SSE2__
+/* Bit i set if byte i of v is in cls; must agree with class_table */
+static int class_mask(__m128i v, int cls) {
+    /* x - lo <= hi - lo, unsigned, is lo <= x <= hi */
+#define IN_RANGE(x, lo, hi) \
+    _mm_cmpeq_epi8(_mm_min_epu8(_mm_sub_epi8((x), _mm_set1_epi8(lo)), \
+                                _mm_set1_epi8((hi) - (lo))), \
+                   _mm_sub_epi8((x), _mm_set1_epi8(lo)))
+
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')),
+                                 IN_RANGE(v, '\t', '\r'));
+    if (cls == CHAR_BLANK) return _mm_movemask_epi8(blank);
+    if (cls == CHAR_NONBLANK) return ~_mm_movemask_epi8(blank) & 0xFFFF;
+
+    __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+    __m128i word = _mm_or_si128(IN_RANGE(v, '0', '9'), IN_RANGE(lower, 'a', 'z'));
+    word = _mm_or_si128(word, _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+    word = _mm_or_si128(word, _mm_cmplt_epi8(v, _mm_setzero_si128()));  /* 0x80 and up */
+    if (cls == CHAR_WORD) return _mm_movemask_epi8(word);
+    return ~_mm_movemask_epi8(_mm_or_si128(blank, word)) & 0xFFFF;
+#undef IN_RANGE
+}
+#endif
+
+/* First index in [from, to) whose byte is not in cls, or to */
+static int skip_forward(const char *s, int from, int to, int cls) {
+    int i = from;
+#ifdef __SSE2__
+    for (; i + 16 <= to; i += 16) {
+        int m = class_mask(_mm_loadu_si128((const __m128i *)(s + i)), cls);
+        if (m != 0xFFFF) return i + __builtin_ctz(~m & 0xFFFF);
+    }
+#endif
+    while (i < to && in_class(s[i], cls)) i++;
+    return i;
+}
+
+/* Last index in [to, from] whose byte is not in cls, scanning down from
+ * from; to - 1 if every byte is */
+static int skip_backward(const char *s, int from, int to, int cls) {
+    int i = from;
+#ifdef __SSE2__
+    for (; i - 15 >= to; i -= 16) {
+        int m = class_mask(_mm_loadu_si128((const __m128i *)(s + i - 15)), cls);
+        if (m != 0xFFFF) return i - 15 + 31 - __builtin_clz(~m & 0xFFFF);
+    }
+#endif
+    while (i >= to && in_class(s[i], cls)) i--;
+    return i;
+}
+
+/* Class of the character at x; the end of the line counts as blank */
+static int class_at(const erow *r, int x, int big) {
+    if (x >= r->size) return CHAR_BLANK;
+    int c = class_table[(unsigned char)r->chars[x]];
+    return (big && c != CHAR_BLANK) ? CHAR_NONBLANK : c;
+}
+
+/* w, W: start of the next word; an empty line counts as a word */
+static void word_forward(int *py, int *px, int big) {
+    int y = *py, x = *px;
+    const erow *r = &E.row[y];
+    int c = class_at(r, x, big);
+    if (c != CHAR_BLANK) x = skip_forward(r->chars, x, r->size, c);
+    for (;;) {
+        x = skip_forward(r->chars, x, r->size, CHAR_BLANK);
+        if (x < r->size || y + 1 >= E.numrows) break;
+        r = &E.row[++y];
+        x = 0;
+        if (r->size == 0) break;
+    }
+    *py = y;
+    *px = x;
+}
+
+/* e, E: end of the word, or of the next one when already at an end */
+static void word_end(int *py, int *px, int big) {
+    int y = *py, x = *px + 1;
+    const erow *r = &E.row[y];
+    for (;;) {
+        if (x < r->size) x = skip_forward(r->chars, x, r->size, CHAR_BLANK);
+        if (x < r->size) break;
+        if (y + 1 >= E.numrows) return;  /* No word left */
+        r = &E.row[++y];
+        x = 0;
+    }
+    *py = y;
+    *px = skip_forward(r->chars, x, r->size, class_at(r, x, big)) - 1;
+}
+
+/* b, B: start of the word, or of the previous one when already at a
+ * start; an empty line counts as a word */
+static void word_back(int *py, int *px, int big) {
+    int y = *py, x = *px;
+    const erow *r = &E.row[y];
+    if (x > r->size) x = r->size;
+    for (;;) {
+        x = skip_backward(r->chars, x - 1, 0, CHAR_BLANK);
+        if (x >= 0) break;
+        if (y == 0) {
+            *py = 0;
+            *px = 0;
+            return;
+        }
+        r = &E.row[--y];
+        x = r->size;
+        if (x == 0) {
+            *py = y;
+            *px = 0;
+            return;
+        }
+    }
+    *py = y;
+    *px = skip_backward(r->chars, x, 0, class_at(r, x, big)) + 1;
+}
+
+/* }: the empty line after the paragraph, or the end of the buffer */
+static void paragraph_forward(int *py, int *px) {
+    int y = *py;
+    while (y < E.numrows - 1 && E.row[y].size == 0) y++;
+    while (y < E.numrows - 1 && E.row[y].size != 0) y++;
+    *py = y;
+    *px = E.row[y].size;
+}
+
+/* {: the empty line before the paragraph, or the start of the buffer */
+static void paragraph_back(int *py, int *px) {
+    int y = *py;
+    while (y > 0 && E.row[y].size == 0) y--;
+    while (y > 0 && E.row[y].size != 0) y--;
+    *py = y;
+    *px = 0;
+}
+
+static int is_bracket(char c) {
+    return c != '\0' && strchr("()[]{}", c) != NULL;
+}
+
+/* %: the bracket matching the first one at or after the cursor on its
+ * line */
+static int match_bracket(int *py, int *px) {
+    const erow *r = &E.row[*py];
+    int x = *px;
+    while (x < r->size && !is_bracket(r->chars[x])) x++;
+    if (x >= r->size) return -1;
+    return bracket_match(*py, x, py, px);
+}
+
+void motion_class_run(const erow *r, int x, int big, int *start, int *end) {
+    int c = class_at(r, x, big);
+    *start = skip_backward(r->chars, x, 0, c) + 1;
+    *end = skip_forward(r->chars, x, r->size, c);
+}
+
+/* f, t, F, T: the count'th ch on the line. A repeated t or T looks past
+ * the character it stopped next to, so ';' keeps moving. */
+static int find_char(int key, int ch, long count, int repeat, int *px) {
+    const erow *r = &E.row[E.cy];
+    int till = (key == 't' || key == 'T');
+    int skip = (repeat && till) ? 1 : 0;
+    int pos = -1;
+
+    if (key == 'f' || key == 't') {
+        int i = *px + 1 + skip;
+        for (long n = 0; n < count; n++) {
+            const char *hit = i < r->size ? memchr(r->chars + i, ch, r->size - i) : NULL;
+            if (hit == NULL) return -1;
+            pos = (int)(hit - r->chars);
+            i = pos + 1;
+        }
+        *px = till ? pos - 1 : pos;
+    } else {
+        int i = *px - 1 - skip;
+        if (i >= r->size) i = r->size - 1;
+        for (long n = 0; n < count; n++) {
+            while (i >= 0 && r->chars[i] != ch) i--;
+            if (i < 0) return -1;
+            pos = i--;
+        }
+        *px = till ? pos + 1 : pos;
+    }
+    return 0;
+}
+
+static int find_kind(int key) {
+    return (key == 'f' || key == 't') ? MOTION_INCLUSIVE : MOTION_EXCLUSIVE;
+}
+
+/* ',' runs the last find the other way */
+static int find_reverse(int key) {
+    switch (key) {
+        case 'f': return 'F';
+        case 'F': return 'f';
+        case 't': return 'T';
+        default:  return 't';
+    }
+}
+
+int motion_is_key(int key) {
+    return key > 0 && key < 0x80 && strchr("hjkl0$wbeWBE{}%ftFT;,'`[]", key) != NULL;
+}
+
+int motion_needs_char(int key) {
+    return key == 'f' || key == 't' || key == 'F' || key == 'T' || key == '\'' || key == '`';
+}
+
+int motion_is_jump(int key) {
+    return key == '%' || key == '{' || key == '}' || key == '\'' || key == '`';
+}
+
+/* ' and `: the line of a mark, at its first non-blank, or its exact
+ * position; marks left past the end of the buffer are clamped */
+static int goto_mark(int key, int name, int *py, int *px) {
+    int y, x;
+    if (mark_get(name, &y, &x) == -1) {
+        editor_set_status("Mark not set");
+        return -1;
+    }
+    if (y >= E.numrows) y = E.numrows - 1;
+    const erow *r = &E.row[y];
+    if (key == '\'') {
+        x = 0;
+        while (x < r->size && (r->chars[x] == ' ' || r->chars[x] == '\t')) x++;
+    } else if (x > r->size) {
+        x = r->size;
+    }
+    *py = y;
+    *px = x;
+    return 0;
+}
+
+int motion_target_of(int key, int arg, long count, motion_target *t) {
+    if (E.cy >= E.numrows) return -1;
+    int y = E.cy;
+    int x = E.cx < E.row[y].size ? E.cx : E.row[y].size;
+    int big = (key == 'W' || key == 'B' || key == 'E');
+    if (count < 1) count = 1;
+    t->kind = MOTION_EXCLUSIVE;
+
+    switch (key) {
+        case 'h':
+            x = count < x ? x - (int)count : 0;
+            break;
+        case 'l':
+            x = count < E.row[y].size - x ? x + (int)count : E.row[y].size;
+            break;
+        case 'j':
+            y = count < E.numrows - 1 - y ? y + (int)count : E.numrows - 1;
+            t->kind = MOTION_LINEWISE;
+            break;
+        case 'k':
+            y = count < y ? y - (int)count : 0;
+            t->kind = MOTION_LINEWISE;
+            break;
+        case '0':
+            x = 0;
+            break;
+        case '$':
+            x = E.row[y].size;
+            break;
+        case 'w':
+        case 'W':
+        case 'b':
+        case 'B':
+        case 'e':
+        case 'E':
+        case '{':
+        case '}':
+            /* Stop early once a step no longer moves */
+            for (long n = 0; n < count; n++) {
+                int py = y, px = x;
+                switch (key) {
+                    case 'w': case 'W': word_forward(&y, &x, big); break;
+                    case 'b': case 'B': word_back(&y, &x, big); break;
+                    case 'e': case 'E': word_end(&y, &x, big); break;
+                    case '}': paragraph_forward(&y, &x); break;
+                    default:  paragraph_back(&y, &x); break;
+                }
+                if (y == py && x == px) break;
+            }
+            if (key == 'e' || key == 'E') t->kind = MOTION_INCLUSIVE;
+            break;
+        case '%':
+            if (match_bracket(&y, &x) == -1) return -1;
+            t->kind = MOTION_INCLUSIVE;
+            break;
+        case 'f':
+        case 't':
+        case 'F':
+        case 'T':
+            last_find_key = key;
+            last_find_char = arg;
+            if (find_char(key, arg, count, 0, &x) == -1) return -1;
+            t->kind = find_kind(key);
+            break;
+        case '\'':
+        case '`':
+            if (goto_mark(key, arg, &y, &x) == -1) return -1;
+            t->kind = key == '\'' ? MOTION_LINEWISE : MOTION_EXCLUSIVE;
+            break;
+        case ']':
+        case '[':
+            /* Start of the next or previous CSV field */
+            if (!csv_delim()) return -1;
+            x = csv_next_field(y, x, key == ']' ? count : -count);
+            break;
+        case ';':
+        case ',':
+            {
+                if (last_find_key == 0) return -1;
+                int k = key == ';' ? last_find_key : find_reverse(last_find_key);
+                if (find_char(k, last_find_char, count, 1, &x) == -1) return -1;
+                t->kind = find_kind(k);
+            }
+            break;
+        default:
+            return -1;
+    }
+
+    if ((key == 'j' || key == 'k') && csv_delim()) x = csv_same_column(E.cy, x, y);
+    t->y = y;
+    t->x = x;
+    if (y == E.cy && x == E.cx && key != '0' && key != '$') return -1;
+    return 0;
+}
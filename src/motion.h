@@ -0,0 +1,56 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Cursor motions beyond h/j/k/l: words, paragraphs, bracket matching,
+ * finding a character on the line and going to a mark.
+ *
+ * Characters are classified with a 256-entry table, and runs of one
+ * class are skipped 16 bytes at a time with SSE2 where the compiler
+ * targets it, so a motion over a megabyte-long line of base64 costs a
+ * few microseconds rather than a byte-by-byte walk. A motion returns its
+ * target instead of moving the cursor, so operators can take the range
+ * from the cursor to the target.
+ */
+
+#ifndef ABCZED_MOTION_H
+#define ABCZED_MOTION_H
+
+#include "abczed.h"
+
+/* Character classes; a WORD (W, B, E) is any run of non-blanks */
+enum char_class {
+    CHAR_BLANK,
+    CHAR_PUNCT,
+    CHAR_WORD
+};
+
+/* How an operator takes the text up to a motion's target */
+enum motion_kind {
+    MOTION_EXCLUSIVE,       /* Up to the target, not including it */
+    MOTION_INCLUSIVE,       /* Including the character at the target */
+    MOTION_LINEWISE         /* Whole lines from the cursor's to the target's */
+};
+
+typedef struct motion_target {
+    int y, x;
+    int kind;
+} motion_target;
+
+int char_class(int c);
+
+/* Nonzero if key is a motion; motion_needs_char() if it takes a
+ * character argument (f, t, F, T, ' and `); motion_is_jump() if the
+ * jump list records where it started */
+int motion_is_key(int key);
+int motion_needs_char(int key);
+int motion_is_jump(int key);
+
+/* Where motion key, with its character argument, takes the cursor when
+ * repeated count times; -1 if it cannot move at all */
+int motion_target_of(int key, int arg, long count, motion_target *t);
+
+/* Bounds [*start, *end) of the run of x's character class on row r */
+void motion_class_run(const erow *r, int x, int big, int *start, int *end);
+
+#endif /* ABCZED_MOTION_H */
@@ -0,0 +1,354 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Operator-pending keys, text objects and the range engine.
+ */
+
+#include "abczed.h"
+#include "input.h"
+#include "motion.h"
+#include "operator.h"
+
+#include <string.h>
+
+/* Counts past this are treated as "all of it" */
+#define COUNT_MAX 100000000L
+
+/* The operator waiting for its motion or text object */
+static struct {
+    int op;                 /* 'd', 'c', 'y', '=', 'z' (zf), or 0 when none */
+    long count;             /* Count typed before the operator */
+    long count2;            /* Count typed after it, 0 if none */
+    int key;                /* f/t/F/T or i/a waiting for one more key */
+} pending;
+
+void operator_begin(int op, long count) {
+    pending.op = op;
+    pending.count = count > 0 ? count : 1;
+    pending.count2 = 0;
+    pending.key = 0;
+}
+
+int operator_pending(void) {
+    return pending.op != 0;
+}
+
+void operator_cancel(void) {
+    pending.op = 0;
+}
+
+/* Arrow keys work as motions too */
+static int motion_key(int c) {
+    switch (c) {
+        case EKEY_LEFT:  return 'h';
+        case EKEY_RIGHT: return 'l';
+        case EKEY_UP:    return 'k';
+        case EKEY_DOWN:  return 'j';
+        case EKEY_HOME:  return '0';
+        case EKEY_END:   return '$';
+        default:         return c;
+    }
+}
+
+int operator_key(int c, operator_cmd *cmd) {
+    if (c == 27) {
+        operator_cancel();
+        return 0;
+    }
+    if (pending.key) {
+        /* The character to find, or the kind of text object */
+        if (c <= 0 || c >= 0x100) {
+            operator_cancel();
+            return 0;
+        }
+        cmd->key = pending.key;
+        cmd->arg = c;
+    } else if ((c >= '1' && c <= '9') || (c == '0' && pending.count2 > 0)) {
+        if (pending.count2 < COUNT_MAX) pending.count2 = pending.count2 * 10 + (c - '0');
+        return 0;
+    } else if (motion_needs_char(c) || c == 'i' || c == 'a') {
+        pending.key = c;
+        return 0;
+    } else if (c == pending.op || motion_is_key(motion_key(c))) {
+        cmd->key = motion_key(c);
+        cmd->arg = 0;
+    } else {
+        operator_cancel();
+        return 0;
+    }
+
+    long n = pending.count * (pending.count2 > 0 ? pending.count2 : 1);
+    cmd->op = pending.op;
+    cmd->count = n < COUNT_MAX ? n : COUNT_MAX;
+    operator_cancel();
+    return 1;
+}
+
+/* iw, aw, iW, aW: the run of one class around the cursor on its line,
+ * count runs long. "a" adds the blanks after the word, or before it
+ * when there are none after. */
+static int word_object(int around, int big, long count, text_range *r) {
+    const erow *row = &E.row[E.cy];
+    if (row->size == 0) return -1;
+    int x = E.cx < row->size ? E.cx : row->size - 1;
+    int start, end, s, e;
+    motion_class_run(row, x, big, &start, &end);
+    int on_blank = char_class(row->chars[x]) == CHAR_BLANK;
+
+    for (long n = 1; n < count && end < row->size; n++) {
+        motion_class_run(row, end, big, &s, &end);
+    }
+    if (around) {
+        if (end < row->size && (on_blank || char_class(row->chars[end]) == CHAR_BLANK)) {
+            /* The blanks after a word, or the word after blanks */
+            motion_class_run(row, end, big, &s, &end);
+        } else if (!on_blank && start > 0 && char_class(row->chars[start - 1]) == CHAR_BLANK) {
+            motion_class_run(row, start - 1, big, &start, &e);
+        }
+    }
+    r->y0 = r->y1 = E.cy;
+    r->x0 = start;
+    r->x1 = end;
+    return 0;
+}
+
+/* i(, a( and the other brackets: the count'th pair around the cursor */
+static int bracket_object(int around, char open, long count, text_range *r) {
+    int oy = E.cy, ox = E.cx, cy, cx;
+    for (long n = 0; n < count; n++) {
+        /* Each further pair starts before the one already found */
+        if (n > 0) {
+            if (ox > 0) {
+                ox--;
+            } else if (oy > 0) {
+                oy--;
+                ox = E.row[oy].size;
+            } else {
+                return -1;
+            }
+        }
+        if (bracket_enclosing(open, oy, ox, &oy, &ox) == -1) return -1;
+    }
+    if (bracket_match(oy, ox, &cy, &cx) == -1) return -1;
+
+    r->y0 = oy;
+    r->x0 = ox;
+    r->y1 = cy;
+    r->x1 = cx + 1;
+    if (!around) {
+        r->x0++;
+        r->x1--;
+        /* Brackets at the end and start of lines leave those line
+         * breaks alone */
+        if (r->x0 == E.row[oy].size && r->y1 > r->y0) {
+            r->y0++;
+            r->x0 = 0;
+        }
+        int indent = 0;
+        while (indent < r->x1 && char_class(E.row[r->y1].chars[indent]) == CHAR_BLANK) indent++;
+        if (indent == r->x1 && r->y1 > r->y0) {
+            r->y1--;
+            r->x1 = E.row[r->y1].size;
+            /* Whole lines between brackets on lines of their own */
+            r->linewise = r->x0 == 0;
+        }
+    }
+    return 0;
+}
+
+/* i", a" and the other quotes: the quoted string on the cursor's line
+ * that holds the cursor, or the next one. "a" adds the blanks after the
+ * closing quote. */
+static int quote_object(int around, char quote, text_range *r) {
+    const erow *row = &E.row[E.cy];
+    int x = E.cx;
+    int open = -1, close = -1;
+    for (int i = 0; i < row->size; i++) {
+        if (row->chars[i] == '\\') {
+            i++;  /* Escaped */
+            continue;
+        }
+        if (row->chars[i] != quote) continue;
+        if (open < 0) {
+            open = i;
+        } else {
+            close = i;
+            if (close >= x) break;
+            open = -1;
+            close = -1;
+        }
+    }
+    if (open < 0 || close < 0) return -1;
+
+    r->y0 = r->y1 = E.cy;
+    if (around) {
+        r->x0 = open;
+        r->x1 = close + 1;
+        while (r->x1 < row->size && char_class(row->chars[r->x1]) == CHAR_BLANK) r->x1++;
+    } else {
+        r->x0 = open + 1;
+        r->x1 = close;
+    }
+    return 0;
+}
+
+static int text_object(int around, int obj, long count, text_range *r) {
+    r->linewise = 0;
+    switch (obj) {
+        case 'w': return word_object(around, 0, count, r);
+        case 'W': return word_object(around, 1, count, r);
+        case '(': case ')': case 'b': return bracket_object(around, '(', count, r);
+        case '[': case ']': return bracket_object(around, '[', count, r);
+        case '{': case '}': case 'B': return bracket_object(around, '{', count, r);
+        case '"': case '\'': case '`': return quote_object(around, (char)obj, r);
+        default: return -1;
+    }
+}
+
+/* cw on a word changes to the end of it, like ce: the count'th word end,
+ * counting the one under the cursor */
+static int change_word(const operator_cmd *cmd, motion_target *t) {
+    const erow *row = &E.row[E.cy];
+    int big = cmd->key == 'W';
+    int s, end;
+    motion_class_run(row, E.cx, big, &s, &end);
+    t->y = E.cy;
+    t->x = end - 1;
+    t->kind = MOTION_INCLUSIVE;
+    if (cmd->count <= 1) return 0;
+
+    int x = E.cx;
+    E.cx = t->x;
+    int ret = motion_target_of(big ? 'E' : 'e', 0, cmd->count - 1, t);
+    E.cx = x;
+    return ret;
+}
+
+int operator_range(const operator_cmd *cmd, text_range *r) {
+    if (E.cy >= E.numrows) return -1;
+    const erow *row = &E.row[E.cy];
+    int cx = E.cx < row->size ? E.cx : row->size;
+
+    /* dd, yy: count whole lines, a closed fold as one */
+    if (cmd->key == cmd->op) {
+        int last = E.cy;
+        for (long i = 1; i < cmd->count && last < E.numrows - 1; i++) {
+            int end = fold_closed_end(last);
+            last = (end >= 0 ? end : last) + 1;
+        }
+        if (fold_closed_end(last) >= 0) last = fold_closed_end(last);
+        r->y0 = E.cy;
+        r->y1 = last < E.numrows ? last : E.numrows - 1;
+        r->x0 = 0;
+        r->x1 = E.row[r->y1].size;
+        r->linewise = 1;
+        return 0;
+    }
+    if (cmd->key == 'i' || cmd->key == 'a') {
+        return text_object(cmd->key == 'a', cmd->arg, cmd->count, r);
+    }
+
+    motion_target t;
+    if (cmd->op == 'c' && (cmd->key == 'w' || cmd->key == 'W') && cx < row->size &&
+        char_class(row->chars[cx]) != CHAR_BLANK) {
+        if (change_word(cmd, &t) == -1) return -1;
+    } else if (motion_target_of(cmd->key, cmd->arg, cmd->count, &t) == -1) {
+        return -1;
+    }
+
+    int y0 = E.cy, x0 = cx, y1 = t.y, x1 = t.x;
+    if (y1 < y0 || (y1 == y0 && x1 < x0)) {
+        y0 = t.y;
+        x0 = t.x;
+        y1 = E.cy;
+        x1 = cx;
+    }
+    r->linewise = t.kind == MOTION_LINEWISE;
+    if (r->linewise) {
+        /* Whole lines take in the closed fold shown on the last one */
+        if (fold_closed_end(y1) >= 0) y1 = fold_closed_end(y1);
+        x0 = 0;
+        x1 = E.row[y1].size;
+    } else if (t.kind == MOTION_INCLUSIVE && x1 < E.row[y1].size) {
+        x1++;
+    } else if (t.kind == MOTION_EXCLUSIVE && x1 == 0 && y1 > y0) {
+        /* Ending at the start of a line stops at the end of the one
+         * before, so "dw" on a line's last word keeps the line break.
+         * Starting in the indent as well makes it whole lines ("d}"). */
+        y1--;
+        x1 = E.row[y1].size;
+        int indent = 0;
+        while (indent < x0 && char_class(E.row[y0].chars[indent]) == CHAR_BLANK) indent++;
+        if (indent == x0) {
+            r->linewise = 1;
+            x0 = 0;
+        }
+    }
+    r->y0 = y0;
+    r->x0 = x0;
+    r->y1 = y1;
+    r->x1 = x1;
+    return 0;
+}
+
+static int first_nonblank(int y) {
+    const erow *row = &E.row[y];
+    int x = 0;
+    while (x < row->size && (row->chars[x] == ' ' || row->chars[x] == '\t')) x++;
+    return x;
+}
+
+int operator_run(const operator_cmd *cmd) {
+    text_range r;
+    if (operator_range(cmd, &r) == -1) {
+        macro_replay_abort("motion failed");
+        return -1;
+    }
+
+    /* =: reindent the lines the range touches */
+    if (cmd->op == '=') {
+        if (editor_reindent(r.y0, r.y1) == -1) return -1;
+        E.cy = r.y0;
+        E.cx = first_nonblank(r.y0);
+        return 0;
+    }
+
+    /* zf: fold the lines the range touches */
+    if (cmd->op == 'z') {
+        if (fold_create(r.y0, r.y1) == -1) return -1;
+        E.cy = r.y0;
+        return 0;
+    }
+
+    if (r.linewise) {
+        int lines = r.y1 - r.y0 + 1;
+        if (cmd->op == 'd') {
+            E.cy = r.y0;
+            editor_delete_lines(lines);
+            return 0;
+        }
+        if (editor_yank_lines(r.y0, lines) == -1) {
+            editor_set_status("Memory allocation failed");
+            return -1;
+        }
+        /* c empties the lines but keeps one to type on */
+        if (cmd->op == 'c') {
+            editor_delete_range(r.y0, 0, r.y1, r.x1);
+        }
+        E.cy = r.y0;
+        E.cx = 0;
+        return 0;
+    }
+
+    if (register_yank(r.y0, r.x0, r.y1, r.x1) == -1) {
+        editor_set_status("Memory allocation failed");
+        return -1;
+    }
+    E.cy = r.y0;
+    E.cx = r.x0;
+    if (cmd->op != 'y') {
+        editor_delete_range(r.y0, r.x0, r.y1, r.x1);
+    }
+    return 0;
+}
@@ -0,0 +1,49 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Operators: d (delete), c (change), y (yank), = (reindent) and zf (fold)
+ * followed by a motion or a text object.
+ *
+ * The keys after the operator are collected one at a time as they
+ * arrive, like a register name after '"', so nothing waits on a timeout.
+ * A complete command is turned into a text range first: a motion's
+ * target seen from the cursor, or the bounds of a word, bracket pair or
+ * quoted string. The operator then applies to the whole range as one
+ * batched buffer edit and one undo step, whatever its size or count.
+ */
+
+#ifndef ABCZED_OPERATOR_H
+#define ABCZED_OPERATOR_H
+
+/* Text from (y0, x0) up to (y1, x1), or whole rows y0..y1 */
+typedef struct text_range {
+    int y0, x0, y1, x1;
+    int linewise;
+} text_range;
+
+/* A complete operator command, kept so '.' can run it again */
+typedef struct operator_cmd {
+    int op;                 /* 'd', 'c', 'y', '=', or 'z' for zf */
+    long count;             /* Both counts multiplied: 2d3w is 6 */
+    int key;                /* Motion key, the operator again (dd), or 'i'/'a' */
+    int arg;                /* Character for f/t/F/T, object for 'i'/'a' */
+} operator_cmd;
+
+/* Start an operator typed with count before it */
+void operator_begin(int op, long count);
+int operator_pending(void);
+void operator_cancel(void);
+
+/* Feed the next key; returns 1 and fills cmd once the command is
+ * complete, 0 while more keys are needed or after ESC cancels it */
+int operator_key(int c, operator_cmd *cmd);
+
+/* The range cmd covers from the cursor; -1 if there is none */
+int operator_range(const operator_cmd *cmd, text_range *r);
+
+/* Apply cmd: yank the range, and delete it for d and c, or reindent
+ * its lines for = or fold them for zf; -1 if the command covers no text */
+int operator_run(const operator_cmd *cmd);
+
+#endif /* ABCZED_OPERATOR_H */
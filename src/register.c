@@ -0,0 +1,252 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Registers: unnamed, "a-"z and the yank history "0-"9.
+ *
+ * A register holds pieces of row text blocks rather than copies of the
+ * text: yanking takes a reference on each row's block, and the buffer
+ * copies a block only when it next writes to a shared one. Register
+ * contents are reference counted as well, so the unnamed register, the
+ * history and a named register can all hold the same yank.
+ */
+
+#include "abczed.h"
+
+#include <stdio.h>
+#include <string.h>
+
+/* Register slots: unnamed, a-z, then history 0-9 (0 is the newest) */
+#define REG_UNNAMED 0
+#define REG_NAMED   1
+#define REG_HISTORY (REG_NAMED + 26)
+#define REG_COUNT   (REG_HISTORY + 10)
+
+static yank_text *regs[REG_COUNT];
+
+/* Register chosen with "x for the next yank or put */
+static int pending = REG_UNNAMED;
+static int pending_append = 0;
+
+static int register_slot(int name) {
+    if (name == '"') return REG_UNNAMED;
+    if (name >= 'a' && name <= 'z') return REG_NAMED + name - 'a';
+    if (name >= 'A' && name <= 'Z') return REG_NAMED + name - 'A';
+    if (name >= '0' && name <= '9') return REG_HISTORY + name - '0';
+    return -1;
+}
+
+static int slot_name(int slot) {
+    if (slot == REG_UNNAMED) return '"';
+    if (slot < REG_HISTORY) return 'a' + slot - REG_NAMED;
+    return '0' + slot - REG_HISTORY;
+}
+
+static yank_text *yank_new(int cap) {
+    yank_text *t = editor_malloc(MEM_REGISTERS, sizeof(yank_text));
+    if (t == NULL) return NULL;
+    t->refs = 1;
+    t->count = 0;
+    t->kind = YANK_CHARS;
+    t->lines = 1;
+    t->width = 0;
+    t->bytes = 0;
+    t->cap = cap > 0 ? cap : 1;
+    t->pieces = editor_malloc(MEM_REGISTERS, sizeof(yank_piece) * t->cap);
+    if (t->pieces == NULL) {
+        editor_free(MEM_REGISTERS, t);
+        return NULL;
+    }
+    return t;
+}
+
+yank_text *yank_ref(yank_text *t) {
+    if (t) t->refs++;
+    return t;
+}
+
+void yank_unref(yank_text *t) {
+    if (t == NULL || --t->refs > 0) return;
+    for (int i = 0; i < t->count; i++) row_text_unref(t->pieces[i].text);
+    editor_free(MEM_REGISTERS, t->pieces);
+    editor_free(MEM_REGISTERS, t);
+}
+
+/* Append a piece, taking a reference on its block */
+static int yank_add(yank_text *t, char *text, int start, int len, int eol) {
+    if (t->count == t->cap) {
+        yank_piece *p = editor_realloc(MEM_REGISTERS, t->pieces, sizeof(yank_piece) * t->cap * 2);
+        if (p == NULL) return -1;
+        t->pieces = p;
+        t->cap *= 2;
+    }
+    yank_piece *p = &t->pieces[t->count++];
+    p->text = row_text_ref(text);
+    p->start = start;
+    p->len = len;
+    p->eol = eol;
+    t->bytes += len + (eol ? 1 : 0);
+    if (eol) t->lines++;
+    return 0;
+}
+
+/* Store t in slot; the slot takes its own reference */
+static void register_set(int slot, yank_text *t) {
+    yank_unref(regs[slot]);
+    regs[slot] = yank_ref(t);
+}
+
+/* Copy of a followed by b, for "A-"Z appends; lines appended to text,
+ * or text to lines, make whole lines */
+static yank_text *yank_concat(const yank_text *a, const yank_text *b) {
+    yank_text *t = yank_new(a->count + b->count);
+    if (t == NULL) return NULL;
+    int lines = a->kind == YANK_LINES || b->kind == YANK_LINES;
+    for (int i = 0; i < a->count; i++) {
+        const yank_piece *p = &a->pieces[i];
+        yank_add(t, p->text, p->start, p->len, p->eol || (lines && i == a->count - 1));
+    }
+    for (int i = 0; i < b->count; i++) {
+        const yank_piece *p = &b->pieces[i];
+        yank_add(t, p->text, p->start, p->len, p->eol || (lines && i == b->count - 1));
+    }
+    if (lines) {
+        t->kind = YANK_LINES;
+        t->lines--;
+    } else if (a->kind == YANK_BLOCK && b->kind == YANK_BLOCK) {
+        t->kind = YANK_BLOCK;
+        t->width = a->width > b->width ? a->width : b->width;
+    }
+    return t;
+}
+
+/* Store a new yank in the selected register, the unnamed register and
+ * the history; takes over the caller's reference */
+static int register_store(yank_text *t) {
+    if (pending_append && regs[pending]) {
+        yank_text *joined = yank_concat(regs[pending], t);
+        yank_unref(t);
+        if (joined == NULL) return -1;
+        t = joined;
+    }
+
+    /* Shift the history down; the oldest entry falls off */
+    yank_unref(regs[REG_COUNT - 1]);
+    memmove(&regs[REG_HISTORY + 1], &regs[REG_HISTORY], sizeof(regs[0]) * 9);
+    regs[REG_HISTORY] = NULL;
+    register_set(REG_HISTORY, t);
+
+    if (pending != REG_UNNAMED && pending < REG_HISTORY) register_set(pending, t);
+    register_set(REG_UNNAMED, t);
+    yank_unref(t);
+
+    pending = REG_UNNAMED;
+    pending_append = 0;
+    return 0;
+}
+
+int register_select(int name) {
+    int slot = register_slot(name);
+    if (slot < 0) return -1;
+    pending = slot;
+    pending_append = (name >= 'A' && name <= 'Z');
+    return 0;
+}
+
+int register_yank(int y0, int x0, int y1, int x1) {
+    if (y0 < 0 || y1 >= E.numrows || y1 < y0) return -1;
+
+    yank_text *t = yank_new(y1 - y0 + 1);
+    if (t == NULL) return -1;
+    for (int y = y0; y <= y1; y++) {
+        erow *row = &E.row[y];
+        int start = (y == y0) ? x0 : 0;
+        int end = (y == y1) ? x1 : row->size;
+        if (start > row->size) start = row->size;
+        if (end > row->size) end = row->size;
+        if (end < start) end = start;
+        if (yank_add(t, row->chars, start, end - start, y < y1) == -1) {
+            yank_unref(t);
+            return -1;
+        }
+    }
+
+    return register_store(t);
+}
+
+int register_yank_lines(int y0, int y1) {
+    if (y0 < 0 || y1 >= E.numrows || y1 < y0) return -1;
+
+    /* Every row whole, each with its line break */
+    yank_text *t = yank_new(y1 - y0 + 1);
+    if (t == NULL) return -1;
+    for (int y = y0; y <= y1; y++) {
+        if (yank_add(t, E.row[y].chars, 0, E.row[y].size, 1) == -1) {
+            yank_unref(t);
+            return -1;
+        }
+    }
+    t->kind = YANK_LINES;
+    t->lines = y1 - y0 + 1;
+    return register_store(t);
+}
+
+int register_yank_block(int y0, int y1, int x0, int x1) {
+    if (y0 < 0 || y1 >= E.numrows || y1 < y0) return -1;
+
+    /* One piece per row: the bytes in display columns [x0, x1), a tab
+     * partly inside taken whole */
+    yank_text *t = yank_new(y1 - y0 + 1);
+    if (t == NULL) return -1;
+    for (int y = y0; y <= y1; y++) {
+        erow *row = &E.row[y];
+        int start = editor_row_rx_to_cx(row, x0);
+        int end = x1 > x0 ? editor_row_rx_to_cx(row, x1 - 1) + 1 : start;
+        if (end > row->size) end = row->size;
+        if (yank_add(t, row->chars, start, end - start, y < y1) == -1) {
+            yank_unref(t);
+            return -1;
+        }
+    }
+    t->kind = YANK_BLOCK;
+    t->width = x1 - x0;
+    return register_store(t);
+}
+
+int register_pending(void) {
+    return slot_name(pending);
+}
+
+const yank_text *register_take(void) {
+    const yank_text *t = regs[pending];
+    pending = REG_UNNAMED;
+    pending_append = 0;
+    return t;
+}
+
+const yank_text *register_get(int name) {
+    int slot = register_slot(name);
+    return slot < 0 ? NULL : regs[slot];
+}
+
+void register_list(char *buf, size_t size) {
+    size_t len = 0;
+    buf[0] = '\0';
+    for (int slot = 0; slot < REG_COUNT && len + 1 < size; slot++) {
+        if (regs[slot] == NULL) continue;
+        int n = snprintf(buf + len, size - len, "%s\"%c %dL", len ? " " : "",
+                         slot_name(slot), regs[slot]->lines);
+        if (n < 0 || (size_t)n >= size - len) break;
+        len += (size_t)n;
+    }
+    if (len == 0) snprintf(buf, size, "No registers set");
+}
+
+void registers_free(void) {
+    for (int slot = 0; slot < REG_COUNT; slot++) {
+        yank_unref(regs[slot]);
+        regs[slot] = NULL;
+    }
+    pending = REG_UNNAMED;
+    pending_append = 0;
+}
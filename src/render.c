@@ -0,0 +1,459 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Screen drawing on top of a render backend.
+ */
+
+#include "abczed.h"
+#include "compress.h"
+#include "encoding.h"
+#include "input.h"
+#include "render.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Active render backend */
+static const render_backend *R = NULL;
+
+/* Select the backend used by editor_refresh_screen() */
+void render_set_backend(const render_backend *backend) {
+    R = backend;
+}
+
+/* Offset, hex and text columns of the hex view; patched bytes stand out */
+static void editor_draw_hex_rows(const hex_view *v) {
+    static const char digits[] = "0123456789abcdef";
+    for (int y = 0; y < E.screenrows; y++) {
+        long long off = (v->top + y) * HEX_LINE_BYTES;
+        unsigned char bytes[HEX_LINE_BYTES], patched[HEX_LINE_BYTES];
+        size_t n = hex_read(off, bytes, patched, HEX_LINE_BYTES);
+        int x = 0;
+        if (n == 0) {
+            R->put_char(y, 0, '~', RA_DEFAULT);
+            x = 1;
+        } else {
+            char num[24];
+            x = snprintf(num, sizeof(num), "%0*llx", v->width, off);
+            R->put_str(y, 0, num, x, RA_LINENO);
+            for (size_t i = 0; i < n; i++) {
+                int attr = patched[i] ? RA_MATCH : RA_TEXT;
+                char hex[2] = { digits[bytes[i] >> 4], digits[bytes[i] & 0xf] };
+                int c = bytes[i] >= 32 && bytes[i] < 127 ? bytes[i] : '.';
+                R->put_str(y, hex_column((int)i, 0), hex, 2, attr);
+                R->put_char(y, hex_column((int)i, 1), c, attr);
+            }
+            x = hex_column((int)n, 1);
+        }
+        R->clear_to_eol(y, x);
+    }
+}
+
+/* One cell of the CSV view at column col of the whole table */
+static void csv_put(int y, int col, int c, int attr, int *x) {
+    col -= csv_coloff();
+    if (col < 0 || col >= E.screencols) return;
+    R->put_char(y, col, c, attr);
+    if (col + 1 > *x) *x = col + 1;
+}
+
+/* Rows as aligned columns under the sticky header */
+static void editor_draw_csv_rows(void) {
+    int head = csv_header_rows(), end = csv_coloff() + E.screencols;
+    for (int y = 0; y < E.screenrows; y++) {
+        int filerow = csv_screen_row(y), x = 0;
+        if (filerow >= E.numrows) {
+            R->put_char(y, 0, '~', RA_DEFAULT);
+            R->clear_to_eol(y, 1);
+            continue;
+        }
+        const erow *r = &E.row[filerow];
+        const int *ends;
+        int n = csv_fields(filerow, &ends), col = 0;
+        int x0 = 0, x1 = 0, sel = editor_selection_span(filerow, &x0, &x1);
+        for (int i = 0; i < n && col < end; i++) {
+            int s, e, w = csv_width(i);
+            csv_field(filerow, i, &s, &e);
+            for (int k = 0; k < w; k++) {
+                int at = s + k, attr = filerow < head ? RA_PROMPT : RA_TEXT;
+                if (sel && at >= x0 && at < x1) attr = RA_SELECTED;
+                csv_put(y, col + k, at < e ? r->chars[at] & 0xff : ' ', attr, &x);
+            }
+            if (i < n - 1) {
+                csv_put(y, col + w, ' ', RA_LINENO, &x);
+                csv_put(y, col + w + 1, '|', RA_LINENO, &x);
+                csv_put(y, col + w + 2, ' ', RA_LINENO, &x);
+            }
+            col += w + CSV_SEP;
+        }
+        R->clear_to_eol(y, x);
+    }
+}
+
+/* Draw the editor rows */
+void editor_draw_rows() {
+    int y;
+    char line_num[10];  /* Buffer for line numbers */
+    int gutter = diff_gutter_width();
+    int line_num_width = (E.show_line_numbers ? 4 : 0) + gutter;  /* Width of line number display and diff gutter */
+    int match_y = -1, match_x = -1;  /* Bracket matching the one under the cursor */
+    const hex_view *hv = hex_state();
+    if (hv) {
+        editor_draw_hex_rows(hv);
+        return;
+    }
+    if (csv_delim()) {
+        editor_draw_csv_rows();
+        return;
+    }
+    if (bracket_match(E.cy, E.cx, &match_y, &match_x) == -1) match_y = -1;
+    int top = folds_visible(E.rowoff);  /* Screen rows skip closed folds */
+
+    for (y = 0; y < E.screenrows; y++) {
+        int filerow = folds_row(top + y);
+        int fold_end;
+        int x = 0;  /* Column after the last cell drawn on this line */
+
+        /* Draw line numbers if enabled and we have content */
+        if (E.show_line_numbers && filerow < E.numrows) {
+            /* Format line number to fit in buffer */
+            /* Use a safe, fixed-width buffer for line number display */
+            if (filerow + 1 > 0 && filerow + 1 < 1000) {
+                /* Up to 3 digits */
+                snprintf(line_num, sizeof(line_num), "%3d ", filerow + 1);
+            } else if (filerow + 1 >= 1000 && filerow + 1 < 1000000) {
+                /* 4-6 digits, show as e.g. '999k' */
+                snprintf(line_num, sizeof(line_num), "%3dk", (filerow + 1) / 1000);
+            } else if (filerow + 1 >= 1000000) {
+                /* 7+ digits, show as '***' */
+                snprintf(line_num, sizeof(line_num), "***");
+            } else {
+                /* Negative or invalid row */
+                snprintf(line_num, sizeof(line_num), "???");
+            }
+
+            x = (int)strlen(line_num);
+            R->put_str(y, 0, line_num, x, RA_LINENO);
+        }
+        if (gutter && filerow < E.numrows) {
+            int mark = diff_mark(filerow);
+            R->put_char(y, line_num_width - 1, mark,
+                        mark == '+' ? RA_ADDED : mark == '~' ? RA_CHANGED : RA_DELETED);
+            x = line_num_width;
+        }
+
+        if (filerow >= E.numrows) {
+            if (E.numrows == 0 && y == E.screenrows / 3) {
+                char welcome[80];
+                int welcomelen = snprintf(welcome, sizeof(welcome),
+                    "ABC Vi -- version %s", ABCZED_VERSION);
+                if (welcomelen > E.screencols - line_num_width)
+                    welcomelen = E.screencols - line_num_width;
+                int padding = (E.screencols - line_num_width - welcomelen) / 2;
+                if (padding) {
+                    R->put_char(y, line_num_width, '~', RA_DEFAULT);
+                    padding--;
+                }
+                x = line_num_width + padding + 1;
+                R->put_str(y, x, welcome, (int)strlen(welcome), RA_TEXT);
+                x += (int)strlen(welcome);
+            } else {
+                R->put_char(y, line_num_width, '~', RA_DEFAULT);
+                x = line_num_width + 1;
+            }
+        } else if ((fold_end = fold_closed_end(filerow)) >= 0) {
+            /* A closed fold: its size and first line, filled out with '-' */
+            const erow *r = &E.row[filerow];
+            int width = E.screencols - line_num_width;
+            int skip = 0;
+            while (skip < r->size && (r->chars[skip] == ' ' || r->chars[skip] == '\t')) skip++;
+            char head[32];
+            int n = snprintf(head, sizeof(head), "+--%4d lines: ", fold_end - filerow + 1);
+            if (n > width) n = width;
+            int len = r->size - skip < width - n ? r->size - skip : width - n;
+            R->put_str(y, line_num_width, head, n, RA_FOLD);
+            R->put_str(y, line_num_width + n, r->chars + skip, len, RA_FOLD);
+            for (x = line_num_width + n + len; x < E.screencols; x++) R->put_char(y, x, '-', RA_FOLD);
+        } else {
+            int len = E.row[filerow].size - E.coloff;
+            if (len < 0) len = 0;
+            if (len > E.screencols - line_num_width)
+                len = E.screencols - line_num_width;
+
+            /* The selection covers one column range of the line, so the
+             * line is at most three runs: before, inside and after it */
+            const char *text = &E.row[filerow].chars[E.coloff];
+            int sel0 = len, sel1 = len;
+            int x0, x1;
+            if (len > 0 && editor_selection_span(filerow, &x0, &x1)) {
+                sel0 = x0 - E.coloff;
+                sel1 = x1 - E.coloff;
+                if (sel0 < 0) sel0 = 0;
+                if (sel1 > len || x1 == INT_MAX) sel1 = len;
+                if (sel0 > sel1) sel0 = sel1;
+            }
+            if (sel0 > 0)
+                R->put_str(y, line_num_width, text, sel0, RA_TEXT);
+            if (sel1 > sel0)
+                R->put_str(y, line_num_width + sel0, text + sel0, sel1 - sel0, RA_SELECTED);
+            if (len > sel1)
+                R->put_str(y, line_num_width + sel1, text + sel1, len - sel1, RA_TEXT);
+            if (len > 0) x = line_num_width + len;
+
+            /* Extra cursors on this line */
+            for (int i = cursors_row_start(filerow); i < cursors_count(); i++) {
+                const cursor_pos *p = &cursors_list()[i];
+                int col = p->x - E.coloff;
+                if (p->y != filerow) break;
+                if (col < 0 || col >= E.screencols - line_num_width) continue;
+                int c = p->x < E.row[filerow].size ? E.row[filerow].chars[p->x] & 0xff : ' ';
+                R->put_char(y, line_num_width + col, c, RA_SELECTED);
+                if (line_num_width + col + 1 > x) x = line_num_width + col + 1;
+            }
+
+            int col = match_x - E.coloff;
+            if (filerow == match_y && col >= 0 && col < E.screencols - line_num_width) {
+                R->put_char(y, line_num_width + col, E.row[filerow].chars[match_x] & 0xff, RA_MATCH);
+            }
+        }
+        R->clear_to_eol(y, x);
+    }
+}
+
+/* Draw the status bar */
+void editor_draw_status_bar() {
+    /* Left status */
+    char status[80], rstatus[80], format[32] = "";
+    if (E.eol != EOL_LF || E.encoding != ENC_UTF8 || E.bom || E.compression != COMP_NONE) {
+        /* Only files not saved as plain UTF-8 with LF say how they are */
+        static const char *eols[] = { "", " crlf", " cr" };
+        snprintf(format, sizeof(format), " [%s%s%s%s%s]", encoding_name(E.encoding),
+                 E.bom ? "-bom" : "", eols[E.eol], E.compression != COMP_NONE ? " " : "",
+                 E.compression != COMP_NONE ? compress_name(E.compression) : "");
+    }
+    const hex_view *hv = hex_state();
+    int len;
+    if (hv) {
+        len = snprintf(status, sizeof(status), "%.20s [hex] - %lld bytes %s",
+            E.filename, hv->size, E.dirty ? "(modified)" : "");
+    } else {
+        len = snprintf(status, sizeof(status), "%.20s%s%s - %d lines %s",
+            E.filename ? E.filename : "[No Name]", format, csv_delim() ? " [csv]" : "", E.numrows,
+            E.dirty ? "(modified)" : "");
+    }
+
+    /* Right status with enhanced info */
+    char rec[16] = "";
+    if (macro_recording()) snprintf(rec, sizeof(rec), "rec @%c | ", macro_recording());
+    int rlen;
+    if (hv) {
+        rlen = snprintf(rstatus, sizeof(rstatus), "%s | %dx%d | 0x%llx | %d%%",
+            E.mode == MODE_INSERT ? "REPLACE" : E.mode == MODE_COMMAND ? "COMMAND" : "NORMAL",
+            E.screencols, E.screenrows, hv->cursor,
+            hv->size ? (int)(hv->cursor * 100 / hv->size) : 0);
+    } else {
+        rlen = snprintf(rstatus, sizeof(rstatus), "%s%s | %dx%d | %d:%d | %d%%",
+            rec,
+            E.mode == MODE_NORMAL ? "NORMAL" :
+            E.mode == MODE_INSERT ? "INSERT" :
+            E.mode == MODE_SELECTION ? (E.sel_block ? "BLOCK" : "SELECT") : "COMMAND",
+            E.screencols, E.screenrows,
+            E.cy + 1, E.cx + 1,
+            E.numrows ? (E.cy * 100) / E.numrows : 0);
+    }
+
+    /* Ensure status fits within screen */
+    if (len > E.screencols) len = E.screencols;
+    R->put_str(E.screenrows, 0, status, len, RA_STATUS);
+
+    /* Fill middle space */
+    int space_left = E.screencols - len - rlen;
+    if (space_left > 0) {
+        for (int i = 0; i < space_left; i++) {
+            R->put_char(E.screenrows, len + i, ' ', RA_STATUS);
+        }
+    }
+
+    /* Print right status if there's room */
+    if (E.screencols - len >= rlen) {
+        R->put_str(E.screenrows, E.screencols - rlen, rstatus, rlen, RA_STATUS);
+    }
+}
+
+/* Draw the command line */
+void editor_draw_command_line() {
+    /* Get terminal dimensions */
+    int max_y, max_x;
+    R->get_size(&max_y, &max_x);
+
+    /* Check if we have space for command line */
+    if (E.screenrows + 1 >= max_y) {
+        return;  /* Not enough space */
+    }
+
+    /* Clear the command line area */
+    R->clear_to_eol(E.screenrows + 1, 0);
+
+    if (E.mode == MODE_COMMAND) {
+        /* Ensure command buffer is properly terminated */
+        if (E.commandlen < 0) E.commandlen = 0;
+        if (E.commandlen >= (int)sizeof(E.commandbuf)) {
+            E.commandlen = (int)sizeof(E.commandbuf) - 1;
+        }
+        E.commandbuf[E.commandlen] = '\0';  /* Always null-terminate */
+
+        /* Draw command prompt */
+        R->put_char(E.screenrows + 1, 0, ':', RA_PROMPT);
+
+        /* Calculate available space for command */
+        int available_width = max_x - 1;  /* -1 for the colon */
+        if (available_width < 1) available_width = 1;
+
+        /* Print command content - only printable ASCII characters */
+        for (int i = 0; i < available_width && i < E.commandlen; i++) {
+            unsigned char c = (unsigned char)E.commandbuf[i];
+            /* Only display printable ASCII characters (32-126) */
+            if (c >= 32 && c <= 126) {
+                /* Special handling for colon - only show one at the beginning */
+                if (c == ':' && i == 0) {
+                    /* Already displayed by the prompt */
+                    continue;
+                }
+                R->put_char(E.screenrows + 1, i + 1, c, RA_PROMPT);
+            } else {
+                /* Skip non-printable characters in display */
+                R->put_char(E.screenrows + 1, i + 1, ' ', RA_PROMPT);
+            }
+        }
+
+        /* Clear any remaining space in the command line */
+        for (int i = E.commandlen + 1; i <= available_width; i++) {
+            R->put_char(E.screenrows + 1, i, ' ', RA_PROMPT);
+        }
+
+        /* Position cursor */
+        int cursor_pos = E.commandlen + 1;
+        if (cursor_pos > available_width) cursor_pos = available_width;
+        R->move_cursor(E.screenrows + 1, cursor_pos);
+    } else {
+        /* Show status message with timeout */
+        static time_t last_status_time = 0;
+        static const int STATUS_TIMEOUT = 5;  /* 5 seconds */
+
+        time_t current_time = time(NULL);
+        if (E.statusmsg[0] != '\0' &&
+            current_time - last_status_time < STATUS_TIMEOUT) {
+
+            /* Use different colors for different message types */
+            int attr;
+            if (strstr(E.statusmsg, "Error") == E.statusmsg) {
+                attr = RA_SELECTED;  /* Error messages */
+            } else if (strstr(E.statusmsg, "Warning") == E.statusmsg) {
+                attr = RA_LINENO;  /* Warning messages */
+            } else {
+                attr = RA_STATUS;  /* Normal messages */
+            }
+
+            int msglen = (int)strlen(E.statusmsg);
+            if (msglen > max_x) msglen = max_x;
+            R->put_str(E.screenrows + 1, 0, E.statusmsg, msglen, attr);
+        } else {
+            E.statusmsg[0] = '\0';  /* Clear old messages */
+        }
+
+        /* Update last status time when new message is set */
+        if (E.statusmsg[0] != '\0') {
+            last_status_time = current_time;
+        }
+    }
+}
+
+/* Refresh the screen with current editor content */
+void editor_refresh_screen() {
+    uint64_t start = stats_now();
+
+    /* Save current cursor position */
+    int saved_cx = E.cx;
+    int saved_cy = E.cy;
+
+    /* Check if terminal size has changed */
+    int current_rows, current_cols;
+    R->get_size(&current_rows, &current_cols);
+    if (current_rows != E.screenrows + 2 || current_cols != E.screencols) {
+        /* Update editor dimensions */
+        if (current_rows < 3) {
+            /* If terminal is too small, set minimum usable size */
+            E.screenrows = 1;
+        } else {
+            /* Reserve bottom 2 rows for status bar and command line */
+            E.screenrows = current_rows - 2;
+        }
+        E.screencols = current_cols;
+        if (E.screencols < 20) E.screencols = 20;
+    }
+
+    editor_scroll();
+    uint64_t t = trace_phase(TP_SCROLL, start);
+
+    /* Use erase instead of clear for better performance */
+    R->erase();
+
+    /* Handle screen redraw */
+    editor_draw_rows();
+    t = trace_phase(TP_ROWS, t);
+    editor_draw_status_bar();
+    t = trace_phase(TP_STATUS, t);
+    editor_draw_command_line();
+    t = trace_phase(TP_CMDLINE, t);
+
+    /* Position cursor */
+    const hex_view *hv = hex_state();
+    if (E.mode == MODE_COMMAND) {
+        /* Position cursor in command line */
+        R->move_cursor(E.screenrows + 1, E.commandlen + 1);  /* +1 for the colon */
+    } else if (hv) {
+        int i = (int)(hv->cursor % HEX_LINE_BYTES);
+        int screen_x = hex_column(i, hv->text) + (hv->text ? 0 : hv->nibble);
+        int screen_y = (int)(hv->cursor / HEX_LINE_BYTES - hv->top);
+        R->move_cursor(screen_y, screen_x < E.screencols ? screen_x : E.screencols - 1);
+    } else if (csv_delim()) {
+        int head = csv_header_rows();
+        int screen_y = 0, screen_x = 0;
+        if (saved_cy < E.numrows) {
+            screen_y = saved_cy < head ? saved_cy : saved_cy - E.rowoff + head;
+            screen_x = csv_display_x(saved_cy, saved_cx) - csv_coloff();
+        }
+        if (screen_y < 0) screen_y = 0;
+        if (screen_y >= E.screenrows) screen_y = E.screenrows - 1;
+        if (screen_x < 0) screen_x = 0;
+        if (screen_x >= E.screencols) screen_x = E.screencols - 1;
+        R->move_cursor(screen_y, screen_x);
+    } else {
+        /* Calculate screen coordinates */
+        int screen_y = folds_visible(saved_cy) - folds_visible(E.rowoff);
+        int screen_x = saved_cx - E.coloff + diff_gutter_width();
+
+        /* Ensure cursor stays within visible screen bounds */
+        if (screen_y >= 0 && screen_y < E.screenrows &&
+            screen_x >= 0 && screen_x < E.screencols) {
+            R->move_cursor(screen_y, screen_x);
+        } else {
+            /* If cursor would be outside visible area, place it at a valid position */
+            if (screen_y < 0) screen_y = 0;
+            if (screen_y >= E.screenrows) screen_y = E.screenrows - 1;
+            if (screen_x < 0) screen_x = 0;
+            if (screen_x >= E.screencols) screen_x = E.screencols - 1;
+            R->move_cursor(screen_y, screen_x);
+        }
+    }
+
+    /* Force screen update */
+    R->flush();
+    trace_phase(TP_FLUSH, t);
+    stats_timer_add(&S.refresh, start);
+    trace_frame_end();
+}
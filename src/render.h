@@ -0,0 +1,72 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Render backend interface.
+ *
+ * editor_refresh_screen() and the draw functions in render.c only talk
+ * to the screen through a render_backend. The terminal front end plugs
+ * in an ncurses backend; render_grid.c provides an in-memory cell grid
+ * used for headless runs and frame benchmarks.
+ */
+
+#ifndef ABCZED_RENDER_H
+#define ABCZED_RENDER_H
+
+/* Cell attributes, mapped to colors by each backend */
+enum render_attr {
+    RA_DEFAULT,     /* Terminal default (empty-line '~' markers) */
+    RA_TEXT,        /* Normal text */
+    RA_SELECTED,    /* Selected text, error messages */
+    RA_STATUS,      /* Status bar, normal messages */
+    RA_LINENO,      /* Line numbers, warning messages */
+    RA_PROMPT,      /* Command line prompt (bold) */
+    RA_MATCH,       /* Bracket matching the one under the cursor */
+    RA_FOLD,        /* Closed fold lines */
+    RA_ADDED,       /* Diff gutter: added lines */
+    RA_CHANGED,     /* Diff gutter: changed lines */
+    RA_DELETED      /* Diff gutter: deleted lines */
+};
+
+/* Screen operations provided by a backend */
+typedef struct render_backend {
+    void (*get_size)(int *rows, int *cols);        /* Full screen size */
+    void (*erase)(void);                           /* Blank the whole screen */
+    void (*put_char)(int y, int x, int c, int attr);
+    void (*put_str)(int y, int x, const char *s, int len, int attr);
+    void (*clear_to_eol)(int y, int x);            /* Blank from (y, x) to end of line */
+    void (*move_cursor)(int y, int x);
+    void (*flush)(void);                           /* End of frame */
+} render_backend;
+
+/* Select the backend used by editor_refresh_screen() */
+void render_set_backend(const render_backend *backend);
+
+/* Drawing (render.c) */
+void editor_draw_rows(void);
+void editor_draw_status_bar(void);
+void editor_draw_command_line(void);
+void editor_refresh_screen(void);
+
+/* In-memory cell grid backend (render_grid.c) */
+typedef struct render_cell {
+    unsigned char c;
+    unsigned char attr;
+} render_cell;
+
+/* Counters accumulated by the grid backend since render_grid_init() */
+typedef struct render_grid_stats {
+    unsigned long frames;          /* flush() calls */
+    unsigned long cells_written;   /* put_char/put_str/clear cells touched */
+    unsigned long cells_changed;   /* Cells that differ from the last frame */
+    unsigned long tty_bytes;       /* Bytes a terminal update would have sent */
+} render_grid_stats;
+
+int render_grid_init(int rows, int cols);
+void render_grid_free(void);
+const render_backend *render_grid_backend(void);
+const render_cell *render_grid_cell(int y, int x);
+void render_grid_get_stats(render_grid_stats *stats);
+void render_grid_reset_stats(void);
+
+#endif /* ABCZED_RENDER_H */
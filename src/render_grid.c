@@ -0,0 +1,155 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * In-memory cell grid render backend.
+ *
+ * Draw calls land in a back grid. On flush the back grid is compared
+ * with the previous frame, the way curses computes a terminal update,
+ * and the bytes that update would have written to the TTY are counted:
+ * a cursor-position sequence whenever the next changed cell is not where
+ * the cursor already is, an SGR sequence whenever the attribute changes,
+ * and one byte per character.
+ */
+
+#include "abczed.h"
+#include "render.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Cost of an SGR attribute change such as "\x1b[0;37;40m" */
+#define SGR_BYTES 10
+
+static struct {
+    int rows, cols;
+    render_cell *back;     /* Frame being drawn */
+    render_cell *front;    /* Last flushed frame */
+    int cursor_y, cursor_x;
+    render_grid_stats stats;
+} G;
+
+/* Length of the cursor-position sequence "\x1b[<y>;<x>H" */
+static int cup_bytes(int y, int x) {
+    int n = 4;
+    for (y++; y >= 10; y /= 10) n++;
+    for (x++; x >= 10; x /= 10) n++;
+    return n + 2;
+}
+
+static void grid_get_size(int *rows, int *cols) {
+    *rows = G.rows;
+    *cols = G.cols;
+}
+
+static void grid_erase(void) {
+    for (int i = 0; i < G.rows * G.cols; i++) {
+        G.back[i].c = ' ';
+        G.back[i].attr = RA_DEFAULT;
+    }
+}
+
+static void grid_put_char(int y, int x, int c, int attr) {
+    if (y < 0 || y >= G.rows || x < 0 || x >= G.cols) return;
+    render_cell *cell = &G.back[y * G.cols + x];
+    cell->c = (unsigned char)c;
+    cell->attr = (unsigned char)attr;
+    G.stats.cells_written++;
+}
+
+static void grid_put_str(int y, int x, const char *s, int len, int attr) {
+    for (int i = 0; i < len; i++) {
+        grid_put_char(y, x + i, s[i], attr);
+    }
+}
+
+static void grid_clear_to_eol(int y, int x) {
+    for (; x < G.cols; x++) {
+        grid_put_char(y, x, ' ', RA_DEFAULT);
+    }
+}
+
+static void grid_move_cursor(int y, int x) {
+    G.cursor_y = y;
+    G.cursor_x = x;
+}
+
+/* Diff the back grid against the last frame and account the TTY update */
+static void grid_flush(void) {
+    int ty = -1, tx = -1;   /* Where the terminal cursor is */
+    int tattr = -1;         /* Attribute the terminal has active */
+
+    for (int y = 0; y < G.rows; y++) {
+        for (int x = 0; x < G.cols; x++) {
+            int i = y * G.cols + x;
+            if (G.back[i].c == G.front[i].c && G.back[i].attr == G.front[i].attr)
+                continue;
+
+            if (y != ty || x != tx) G.stats.tty_bytes += cup_bytes(y, x);
+            if (G.back[i].attr != tattr) {
+                G.stats.tty_bytes += SGR_BYTES;
+                tattr = G.back[i].attr;
+            }
+            G.stats.tty_bytes++;
+            G.stats.cells_changed++;
+            G.front[i] = G.back[i];
+            ty = y;
+            tx = x + 1;
+        }
+    }
+
+    if (G.cursor_y != ty || G.cursor_x != tx)
+        G.stats.tty_bytes += cup_bytes(G.cursor_y, G.cursor_x);
+    G.stats.frames++;
+}
+
+static const render_backend grid_backend = {
+    grid_get_size,
+    grid_erase,
+    grid_put_char,
+    grid_put_str,
+    grid_clear_to_eol,
+    grid_move_cursor,
+    grid_flush
+};
+
+/* Allocate a rows x cols grid; returns -1 on allocation failure */
+int render_grid_init(int rows, int cols) {
+    render_grid_free();
+
+    G.back = editor_malloc(MEM_RENDER, sizeof(render_cell) * rows * cols);
+    G.front = editor_malloc(MEM_RENDER, sizeof(render_cell) * rows * cols);
+    if (!G.back || !G.front) {
+        render_grid_free();
+        return -1;
+    }
+    G.rows = rows;
+    G.cols = cols;
+    grid_erase();
+    memcpy(G.front, G.back, sizeof(render_cell) * rows * cols);
+    return 0;
+}
+
+void render_grid_free(void) {
+    editor_free(MEM_RENDER, G.back);
+    editor_free(MEM_RENDER, G.front);
+    memset(&G, 0, sizeof(G));
+}
+
+const render_backend *render_grid_backend(void) {
+    return &grid_backend;
+}
+
+/* Cell of the last flushed frame */
+const render_cell *render_grid_cell(int y, int x) {
+    if (y < 0 || y >= G.rows || x < 0 || x >= G.cols) return NULL;
+    return &G.front[y * G.cols + x];
+}
+
+void render_grid_get_stats(render_grid_stats *stats) {
+    *stats = G.stats;
+}
+
+void render_grid_reset_stats(void) {
+    memset(&G.stats, 0, sizeof(G.stats));
+}
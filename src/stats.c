@@ -0,0 +1,130 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Always-on performance counters.
+ */
+
+#include "abczed.h"
+#include "mem.h"
+#include "stats.h"
+
+#include <stdlib.h>
+#include <time.h>
+
+editor_stats S;
+
+uint64_t stats_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+void stats_timer_add(stats_timer *t, uint64_t start) {
+    uint64_t ns = stats_now() - start;
+    t->count++;
+    t->total_ns += ns;
+    if (ns > t->max_ns) t->max_ns = ns;
+}
+
+void stats_reset(void) {
+    memset(&S, 0, sizeof(S));
+    mem_reset_counters();
+}
+
+/* Bytes held by one record; saved rows count only their erow slots,
+ * since their text is shared with the buffer until written */
+static uint64_t operation_bytes(const operation *op) {
+    return sizeof(operation) + (op->line ? (uint64_t)op->line_size + 1 : 0) +
+           (uint64_t)op->nrows * sizeof(erow) + (op->ys ? (uint64_t)op->nrows * sizeof(int) : 0);
+}
+
+void stats_undo_usage(unsigned long *depth, uint64_t *bytes, unsigned long *redo_depth) {
+    *depth = 0;
+    *bytes = 0;
+    for (operation *op = E.undo_stack; op; op = op->next) {
+        (*depth)++;
+        *bytes += operation_bytes(op);
+    }
+    *redo_depth = 0;
+    for (operation *op = E.redo_stack; op; op = op->next) {
+        (*redo_depth)++;
+        *bytes += operation_bytes(op);
+    }
+}
+
+/* Format a byte count as B/K/M/G */
+void stats_format_bytes(char *buf, size_t size, uint64_t n) {
+    if (n < 1024) snprintf(buf, size, "%lluB", (unsigned long long)n);
+    else if (n < 1024 * 1024) snprintf(buf, size, "%.1fK", n / 1024.0);
+    else if (n < 1024ull * 1024 * 1024) snprintf(buf, size, "%.1fM", n / (1024.0 * 1024));
+    else snprintf(buf, size, "%.1fG", n / (1024.0 * 1024 * 1024));
+}
+
+static double timer_avg_us(const stats_timer *t) {
+    return t->count ? t->total_ns / 1e3 / t->count : 0.0;
+}
+
+/* Throughput in MB/s for bytes handled in total_ns */
+static double throughput_mbs(uint64_t bytes, const stats_timer *t) {
+    return t->total_ns ? bytes / (t->total_ns / 1e9) / (1024.0 * 1024) : 0.0;
+}
+
+void stats_summary(char *buf, size_t size) {
+    unsigned long depth, redo_depth;
+    uint64_t undo_bytes;
+    char moved[16], undo[16];
+    mem_tag_stats mem;
+
+    stats_undo_usage(&depth, &undo_bytes, &redo_depth);
+    stats_format_bytes(moved, sizeof(moved), S.row_move_bytes + S.char_move_bytes);
+    stats_format_bytes(undo, sizeof(undo), undo_bytes);
+    mem_totals(&mem);
+    snprintf(buf, size, "draw %.0f/%.0fus key %.0f/%.0fus moved %s allocs %lu undo %lu/%s",
+             timer_avg_us(&S.refresh), S.refresh.max_ns / 1e3,
+             timer_avg_us(&S.keypress), S.keypress.max_ns / 1e3,
+             moved, mem.allocs, depth, undo);
+}
+
+static void report_timer(FILE *fp, const char *name, const stats_timer *t) {
+    fprintf(fp, "  %-10s %10lu calls  avg %10.1f us  max %10.1f us  total %10.1f ms\n",
+            name, t->count, timer_avg_us(t), t->max_ns / 1e3, t->total_ns / 1e6);
+}
+
+void stats_write_report(FILE *fp) {
+    unsigned long depth, redo_depth;
+    uint64_t undo_bytes;
+    char b1[16], b2[16];
+
+    stats_undo_usage(&depth, &undo_bytes, &redo_depth);
+
+    fprintf(fp, "abczed stats\n");
+    fprintf(fp, "timing:\n");
+    report_timer(fp, "refresh", &S.refresh);
+    report_timer(fp, "keypress", &S.keypress);
+    report_timer(fp, "open", &S.open);
+    report_timer(fp, "save", &S.save);
+
+    stats_format_bytes(b1, sizeof(b1), S.open_bytes);
+    stats_format_bytes(b2, sizeof(b2), S.save_bytes);
+    fprintf(fp, "file i/o:\n");
+    fprintf(fp, "  open       %10s  %8.1f MB/s\n", b1, throughput_mbs(S.open_bytes, &S.open));
+    fprintf(fp, "  save       %10s  %8.1f MB/s\n", b2, throughput_mbs(S.save_bytes, &S.save));
+
+    mem_write_report(fp);
+
+    stats_format_bytes(b1, sizeof(b1), S.row_move_bytes);
+    stats_format_bytes(b2, sizeof(b2), S.char_move_bytes);
+    fprintf(fp, "memmove:\n");
+    fprintf(fp, "  row array  %10s\n", b1);
+    fprintf(fp, "  in rows    %10s\n", b2);
+
+    stats_format_bytes(b1, sizeof(b1), undo_bytes);
+    fprintf(fp, "undo:\n");
+    fprintf(fp, "  undo depth %10lu\n", depth);
+    fprintf(fp, "  redo depth %10lu\n", redo_depth);
+    fprintf(fp, "  bytes      %10s\n", b1);
+
+    fprintf(fp, "buffer:\n");
+    fprintf(fp, "  rows       %10d\n", E.numrows);
+}
@@ -0,0 +1,72 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Always-on performance counters.
+ *
+ * The main loop and the hot paths bump these counters as they run; they
+ * cost a clock read or an add, so they stay enabled in every build.
+ * ":stats" shows a summary, ":stats <file>" writes the full report,
+ * ":profile" resets the counters, and --stats-on-exit prints the report
+ * when the editor quits.
+ */
+
+#ifndef ABCZED_STATS_H
+#define ABCZED_STATS_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Call count plus total and worst duration of a timed section */
+typedef struct stats_timer {
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} stats_timer;
+
+typedef struct editor_stats {
+    stats_timer refresh;            /* editor_refresh_screen() */
+    stats_timer keypress;           /* Handling of one key, excluding the wait for it */
+    uint64_t row_move_bytes;        /* Bytes memmoved shifting the row array */
+    uint64_t char_move_bytes;       /* Bytes memmoved inside a row */
+    stats_timer open;               /* editor_open() */
+    uint64_t open_bytes;
+    stats_timer save;               /* editor_save() */
+    uint64_t save_bytes;
+} editor_stats;
+
+extern editor_stats S;
+
+/* Monotonic clock in nanoseconds */
+uint64_t stats_now(void);
+
+/* Add the time since start (from stats_now()) to a timer */
+void stats_timer_add(stats_timer *t, uint64_t start);
+
+/* memmove that counts the bytes it moves */
+static inline void stats_row_move(void *dst, const void *src, size_t n) {
+    S.row_move_bytes += n;
+    memmove(dst, src, n);
+}
+
+static inline void stats_char_move(void *dst, const void *src, size_t n) {
+    S.char_move_bytes += n;
+    memmove(dst, src, n);
+}
+
+void stats_reset(void);
+
+/* Format a byte count as B/K/M/G */
+void stats_format_bytes(char *buf, size_t size, uint64_t n);
+
+/* Walk the undo and redo stacks; depth in records, bytes including text */
+void stats_undo_usage(unsigned long *depth, uint64_t *bytes, unsigned long *redo_depth);
+
+/* One-line summary for the status line */
+void stats_summary(char *buf, size_t size);
+
+/* Full multi-line report, including the memory breakdown from mem.c */
+void stats_write_report(FILE *fp);
+
+#endif /* ABCZED_STATS_H */
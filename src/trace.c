@@ -0,0 +1,218 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Frame-time histograms and the slow-frame ring buffer.
+ */
+
+#include "abczed.h"
+#include "input.h"
+#include "stats.h"
+#include "trace.h"
+
+#include <string.h>
+
+static const char *phase_names[TP_COUNT] = {
+    "key", "scroll", "rows", "status", "cmdline", "flush"
+};
+
+static const char *hist_names[TH_COUNT] = { "key", "refresh", "frame" };
+
+static trace_hist hists[TH_COUNT];
+
+/* Frame being built: key time is added by trace_key(), the refresh
+ * phases by trace_phase() */
+static trace_record current = { .key = EKEY_NONE };
+static int current_has_key = 0;
+static unsigned long frames = 0;
+
+/* Slow frames, ring[(ring_next - 1) % TRACE_RING_SIZE] is the newest */
+static trace_record ring[TRACE_RING_SIZE];
+static unsigned long ring_next = 0;
+
+static uint64_t threshold_ns = TRACE_DEFAULT_THRESHOLD_NS;
+
+/* Histogram bucket for a value in nanoseconds */
+static int bucket_of(uint64_t v) {
+    if (v < TRACE_SUB_BUCKETS) return (int)v;
+    int msb = 63;
+    while (!(v >> msb)) msb--;
+    int shift = msb - TRACE_SUB_BITS;
+    return (shift + 1) * TRACE_SUB_BUCKETS + (int)((v >> shift) & (TRACE_SUB_BUCKETS - 1));
+}
+
+/* Largest value that lands in bucket b */
+static uint64_t bucket_high(int b) {
+    if (b < TRACE_SUB_BUCKETS) return (uint64_t)b;
+    int shift = b / TRACE_SUB_BUCKETS - 1;
+    uint64_t low = (uint64_t)(TRACE_SUB_BUCKETS + b % TRACE_SUB_BUCKETS) << shift;
+    return low + (((uint64_t)1 << shift) - 1);
+}
+
+static void hist_record(trace_hist *h, uint64_t ns) {
+    h->counts[bucket_of(ns)]++;
+    h->count++;
+    h->total_ns += ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+}
+
+uint64_t trace_hist_percentile(const trace_hist *h, double pct) {
+    if (h->count == 0) return 0;
+    unsigned long rank = (unsigned long)(pct / 100.0 * h->count + 0.5);
+    if (rank < 1) rank = 1;
+    if (rank > h->count) rank = h->count;
+
+    unsigned long seen = 0;
+    for (int b = 0; b < TRACE_BUCKETS; b++) {
+        seen += h->counts[b];
+        if (seen >= rank) {
+            uint64_t v = bucket_high(b);
+            return v < h->max_ns ? v : h->max_ns;
+        }
+    }
+    return h->max_ns;
+}
+
+const trace_hist *trace_histogram(enum trace_hist_id id) {
+    return &hists[id];
+}
+
+void trace_key(int key, uint64_t start) {
+    uint64_t ns = stats_now() - start;
+    hist_record(&hists[TH_KEY], ns);
+    current.key = key;
+    current.phase_ns[TP_KEY] += ns;
+    current_has_key = 1;
+}
+
+uint64_t trace_phase(enum trace_phase phase, uint64_t start) {
+    uint64_t now = stats_now();
+    current.phase_ns[phase] += now - start;
+    return now;
+}
+
+void trace_frame_end(void) {
+    uint64_t refresh_ns = 0;
+    for (int p = TP_SCROLL; p < TP_COUNT; p++) refresh_ns += current.phase_ns[p];
+
+    current.total_ns = refresh_ns + current.phase_ns[TP_KEY];
+    current.frame = ++frames;
+    hist_record(&hists[TH_REFRESH], refresh_ns);
+    if (current_has_key) hist_record(&hists[TH_FRAME], current.total_ns);
+
+    if (current.total_ns > threshold_ns) {
+        current.when = time(NULL);
+        current.mode = E.mode;
+        current.numrows = E.numrows;
+        current.cx = E.cx;
+        current.cy = E.cy;
+        ring[ring_next++ % TRACE_RING_SIZE] = current;
+    }
+
+    memset(&current, 0, sizeof(current));
+    current.key = EKEY_NONE;
+    current_has_key = 0;
+}
+
+void trace_reset(void) {
+    memset(hists, 0, sizeof(hists));
+    memset(&current, 0, sizeof(current));
+    current.key = EKEY_NONE;
+    current_has_key = 0;
+    frames = 0;
+    ring_next = 0;
+}
+
+void trace_set_threshold(uint64_t ns) {
+    threshold_ns = ns;
+}
+
+uint64_t trace_threshold(void) {
+    return threshold_ns;
+}
+
+void trace_summary(char *buf, size_t size) {
+    const trace_hist *h = &hists[TH_FRAME];
+    snprintf(buf, size, "frames %lu p50 %.0fus p99 %.0fus max %.0fus slow %lu (>%.1fms)",
+             h->count,
+             trace_hist_percentile(h, 50.0) / 1e3,
+             trace_hist_percentile(h, 99.0) / 1e3,
+             h->max_ns / 1e3,
+             ring_next, threshold_ns / 1e6);
+}
+
+/* Readable name for a key code */
+static void key_name(char *buf, size_t size, int key) {
+    static const char *special[] = {
+        "<Left>", "<Right>", "<Up>", "<Down>", "<Home>", "<End>",
+        "<PageUp>", "<PageDown>", "<CR>", "<BS>"
+    };
+
+    if (key == EKEY_NONE) snprintf(buf, size, "-");
+    else if (key >= EKEY_LEFT && key <= EKEY_BACKSPACE) snprintf(buf, size, "%s", special[key - EKEY_LEFT]);
+    else if (key == 27) snprintf(buf, size, "<Esc>");
+    else if (key == '\t') snprintf(buf, size, "<Tab>");
+    else if (key == ' ') snprintf(buf, size, "<Space>");
+    else if (key > 0 && key < 32) snprintf(buf, size, "<C-%c>", key + 'a' - 1);
+    else if (key > 32 && key < 127) snprintf(buf, size, "%c", key);
+    else snprintf(buf, size, "<%d>", key);
+}
+
+static const char *mode_name(int mode) {
+    switch (mode) {
+        case MODE_NORMAL:    return "NORMAL";
+        case MODE_INSERT:    return "INSERT";
+        case MODE_SELECTION: return "SELECT";
+        default:             return "COMMAND";
+    }
+}
+
+void trace_dump(FILE *fp) {
+    fprintf(fp, "abczed trace\n");
+    fprintf(fp, "threshold %.3f ms, %lu frames, %lu slow\n", threshold_ns / 1e6, frames, ring_next);
+
+    fprintf(fp, "latency (us):\n");
+    fprintf(fp, "  %-8s %10s %10s %10s %10s %10s %10s %10s\n",
+            "", "count", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (int i = 0; i < TH_COUNT; i++) {
+        const trace_hist *h = &hists[i];
+        fprintf(fp, "  %-8s %10lu %10.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n",
+                hist_names[i], h->count,
+                h->count ? h->total_ns / 1e3 / h->count : 0.0,
+                trace_hist_percentile(h, 50.0) / 1e3,
+                trace_hist_percentile(h, 90.0) / 1e3,
+                trace_hist_percentile(h, 99.0) / 1e3,
+                trace_hist_percentile(h, 99.9) / 1e3,
+                h->max_ns / 1e3);
+    }
+
+    /* Non-empty buckets of the frame histogram, upper bound and count */
+    fprintf(fp, "frame histogram (us <= bound: count):\n");
+    for (int b = 0; b < TRACE_BUCKETS; b++) {
+        if (hists[TH_FRAME].counts[b]) {
+            fprintf(fp, "  %12.3f: %u\n", bucket_high(b) / 1e3, hists[TH_FRAME].counts[b]);
+        }
+    }
+
+    unsigned long first = ring_next > TRACE_RING_SIZE ? ring_next - TRACE_RING_SIZE : 0;
+    fprintf(fp, "slow frames (us):\n");
+    fprintf(fp, "  %8s %-19s %-10s %-7s %9s %11s %10s", "frame", "time", "key", "mode",
+            "rows", "cursor", "total");
+    for (int p = 0; p < TP_COUNT; p++) fprintf(fp, " %9s", phase_names[p]);
+    fprintf(fp, "\n");
+
+    for (unsigned long i = first; i < ring_next; i++) {
+        const trace_record *r = &ring[i % TRACE_RING_SIZE];
+        char key[16], when[32], cursor[24];
+        struct tm tm;
+
+        key_name(key, sizeof(key), r->key);
+        localtime_r(&r->when, &tm);
+        strftime(when, sizeof(when), "%Y-%m-%d %H:%M:%S", &tm);
+        snprintf(cursor, sizeof(cursor), "%d:%d", r->cy + 1, r->cx + 1);
+        fprintf(fp, "  %8lu %-19s %-10s %-7s %9d %11s %10.1f", r->frame, when, key,
+                mode_name(r->mode), r->numrows, cursor, r->total_ns / 1e3);
+        for (int p = 0; p < TP_COUNT; p++) fprintf(fp, " %9.1f", r->phase_ns[p] / 1e3);
+        fprintf(fp, "\n");
+    }
+}
@@ -0,0 +1,98 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Frame-time histograms and slow-frame tracing.
+ *
+ * A frame is the handling of one key plus the screen refresh that
+ * follows it. Key handling, refresh and whole-frame times go into
+ * log-linear (HDR-style) histograms with ~6% bucket precision, so
+ * percentiles stay cheap to record and accurate from nanoseconds to
+ * seconds. Frames slower than the threshold also leave a record (key,
+ * mode, buffer size, cursor, per-phase times) in a ring buffer that
+ * ":trace dump" writes out.
+ */
+
+#ifndef ABCZED_TRACE_H
+#define ABCZED_TRACE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+/* Parts of a frame that are timed separately */
+enum trace_phase {
+    TP_KEY,         /* editor_handle_key() */
+    TP_SCROLL,      /* Size check and editor_scroll() */
+    TP_ROWS,        /* Erase and editor_draw_rows() */
+    TP_STATUS,      /* editor_draw_status_bar() */
+    TP_CMDLINE,     /* editor_draw_command_line() */
+    TP_FLUSH,       /* Cursor placement and backend flush */
+    TP_COUNT
+};
+
+/* Histograms kept by the tracer */
+enum trace_hist_id {
+    TH_KEY,         /* Per key handled */
+    TH_REFRESH,     /* Per refresh, idle ticks included */
+    TH_FRAME,       /* Key plus the refresh after it */
+    TH_COUNT
+};
+
+/* 16 linear sub-buckets per power of two: values below 16ns are exact,
+ * larger ones land within 1/16 of their true value */
+#define TRACE_SUB_BITS 4
+#define TRACE_SUB_BUCKETS (1 << TRACE_SUB_BITS)
+#define TRACE_BUCKETS ((64 - TRACE_SUB_BITS + 1) * TRACE_SUB_BUCKETS)
+
+typedef struct trace_hist {
+    uint32_t counts[TRACE_BUCKETS];
+    unsigned long count;
+    uint64_t total_ns;
+    uint64_t max_ns;
+} trace_hist;
+
+/* One slow frame */
+typedef struct trace_record {
+    unsigned long frame;            /* Frame number since the last reset */
+    time_t when;                    /* Wall-clock time, for matching user reports */
+    int key;                        /* Last key handled, EKEY_NONE for idle frames */
+    int mode;                       /* enum editor_mode after the key */
+    int numrows;
+    int cx, cy;
+    uint64_t total_ns;
+    uint64_t phase_ns[TP_COUNT];
+} trace_record;
+
+/* Slow frames kept for ":trace dump"; older ones are overwritten */
+#define TRACE_RING_SIZE 256
+
+/* Default slow-frame threshold: one frame at 60Hz */
+#define TRACE_DEFAULT_THRESHOLD_NS 16000000u
+
+/* Record the time since start (from stats_now()) as handling of key */
+void trace_key(int key, uint64_t start);
+
+/* Add the time since start to a refresh phase; returns the current time
+ * so phases can be chained */
+uint64_t trace_phase(enum trace_phase phase, uint64_t start);
+
+/* Close the current frame: update the histograms and keep a trace
+ * record if it was slow */
+void trace_frame_end(void);
+
+void trace_reset(void);
+void trace_set_threshold(uint64_t ns);
+uint64_t trace_threshold(void);
+
+/* Histogram queries */
+const trace_hist *trace_histogram(enum trace_hist_id id);
+uint64_t trace_hist_percentile(const trace_hist *h, double pct);
+
+/* One-line summary for the status line */
+void trace_summary(char *buf, size_t size);
+
+/* Percentiles, histogram buckets and the slow-frame records, oldest first */
+void trace_dump(FILE *fp);
+
+#endif /* ABCZED_TRACE_H */
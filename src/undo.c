@@ -0,0 +1,387 @@
+/**
+ * ABCZed - A lightweight terminal-based text editor using C.
+ * Copyright (c) 2025 Cyril John Magayaga
+ *
+ * Undo/redo operation stacks.
+ */
+
+#include "abczed.h"
+#include "stats.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Free operation memory */
+void free_operation(operation *op) {
+    if (op->line) editor_free(MEM_UNDO, op->line);
+    for (int i = 0; i < op->nrows; i++) editor_free_row(&op->rows[i]);
+    editor_free(MEM_UNDO, op->rows);
+    editor_free(MEM_UNDO, op->ys);
+    editor_free(MEM_UNDO, op);
+}
+
+/* Free operations stack */
+void free_operations_stack(operation *stack) {
+    operation *current = stack;
+    while (current != NULL) {
+        operation *next = current->next;
+        free_operation(current);
+        current = next;
+    }
+}
+
+/* Push operation to stack */
+void push_operation(operation **stack, enum operation_type type, int cx, int cy, char c, char *line, int line_size) {
+    operation *op = editor_malloc(MEM_UNDO, sizeof(operation));
+    op->type = type;
+    op->cx = cx;
+    op->cy = cy;
+    op->c = c;
+    
+    if (line && line_size > 0) {
+        op->line = editor_malloc(MEM_UNDO, line_size + 1);
+        memcpy(op->line, line, line_size);
+        op->line[line_size] = '\0';
+    } else {
+        op->line = NULL;
+    }
+    
+    op->line_size = line_size;
+    op->rows = NULL;
+    op->nrows = 0;
+    op->span = 0;
+    op->ys = NULL;
+    op->next = *stack;
+    *stack = op;
+}
+
+/* Start a batched edit of rows [at, at+count). The rows are saved by
+ * reference, so a row is only copied if the edit actually writes it. */
+int undo_begin_rows(int at, int count) {
+    if (at < 0 || count < 0 || at + count > E.numrows) return -1;
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow) * (count > 0 ? count : 1));
+    if (rows == NULL) return -1;
+    for (int i = 0; i < count; i++) {
+        rows[i].size = E.row[at + i].size;
+        rows[i].chars = row_text_ref(E.row[at + i].chars);
+    }
+    
+    push_operation(&E.undo_stack, OP_REPLACE_ROWS, E.cx, at, 0, NULL, 0);
+    E.undo_stack->rows = rows;
+    E.undo_stack->nrows = count;
+    E.undo_stack->span = count;
+    
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+    return 0;
+}
+
+/* Finish the batched edit: it left count rows where the saved ones were */
+void undo_end_rows(int count) {
+    if (E.undo_stack && E.undo_stack->type == OP_REPLACE_ROWS) {
+        E.undo_stack->span = count;
+    }
+}
+
+int undo_collapse(operation *mark, int cx, int at, erow *before, int nbefore, int span) {
+    operation *op = E.undo_stack;
+    while (op != NULL && op != mark) op = op->next;
+    if (op != mark) return -1;
+
+    while (E.undo_stack != mark) {
+        op = E.undo_stack;
+        E.undo_stack = op->next;
+        free_operation(op);
+    }
+    push_operation(&E.undo_stack, OP_REPLACE_ROWS, cx, at, 0, NULL, 0);
+    E.undo_stack->rows = before;
+    E.undo_stack->nrows = nbefore;
+    E.undo_stack->span = span;
+    return 0;
+}
+
+int undo_begin_row_set(const int *ys, int count) {
+    for (int i = 0; i < count; i++) {
+        if (ys[i] < 0 || ys[i] >= E.numrows) return -1;
+    }
+    erow *rows = editor_malloc(MEM_UNDO, sizeof(erow) * (count > 0 ? count : 1));
+    int *saved = editor_malloc(MEM_UNDO, sizeof(int) * (count > 0 ? count : 1));
+    if (rows == NULL || saved == NULL) {
+        editor_free(MEM_UNDO, rows);
+        editor_free(MEM_UNDO, saved);
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        saved[i] = ys[i];
+        rows[i].size = E.row[ys[i]].size;
+        rows[i].chars = row_text_ref(E.row[ys[i]].chars);
+    }
+
+    push_operation(&E.undo_stack, OP_SWAP_ROWS, E.cx, count > 0 ? ys[0] : E.cy, 0, NULL, 0);
+    E.undo_stack->rows = rows;
+    E.undo_stack->ys = saved;
+    E.undo_stack->nrows = count;
+    E.undo_stack->span = count;
+
+    free_operations_stack(E.redo_stack);
+    E.redo_stack = NULL;
+    return 0;
+}
+
+/* Swap the rows an OP_SWAP_ROWS saved with the ones now at their rows;
+ * undo and redo are the same swap */
+static void swap_row_set(operation *op) {
+    for (int i = 0; i < op->nrows; i++) {
+        int y = op->ys[i];
+        if (y >= E.numrows) continue;
+        erow row = E.row[y];
+        E.row[y] = op->rows[i];
+        op->rows[i] = row;
+        editor_row_changed(y);
+    }
+    E.cy = op->cy < E.numrows ? op->cy : (E.numrows > 0 ? E.numrows - 1 : 0);
+    E.cx = op->cx;
+    if (E.cy < E.numrows && E.cx > E.row[E.cy].size) E.cx = E.row[E.cy].size;
+    E.dirty++;
+}
+
+/* Swap the rows an OP_REPLACE_ROWS saved with the ones now in the
+ * buffer; undo and redo are the same swap */
+static int swap_replaced_rows(operation *op) {
+    int restored = op->nrows;
+    if (editor_swap_rows(op->cy, op->span, &op->rows, &op->nrows) == -1) {
+        editor_set_status("Memory allocation failed");
+        return -1;
+    }
+    op->span = restored;
+    E.cy = op->cy < E.numrows ? op->cy : (E.numrows > 0 ? E.numrows - 1 : 0);
+    E.cx = op->cx;
+    if (E.cy < E.numrows && E.cx > E.row[E.cy].size) E.cx = E.row[E.cy].size;
+    return 0;
+}
+
+/* Undo last operation */
+void editor_undo() {
+    if (E.undo_stack == NULL) {
+        editor_set_status("Nothing to undo");
+        return;
+    }
+    
+    operation *op = E.undo_stack;
+    
+    /* A batched edit moves to the redo stack whole */
+    if (op->type == OP_SWAP_ROWS) {
+        swap_row_set(op);
+        E.undo_stack = op->next;
+        op->next = E.redo_stack;
+        E.redo_stack = op;
+        return;
+    }
+    if (op->type == OP_REPLACE_ROWS) {
+        if (swap_replaced_rows(op) == 0) {
+            E.undo_stack = op->next;
+            op->next = E.redo_stack;
+            E.redo_stack = op;
+        }
+        return;
+    }
+    
+    E.undo_stack = op->next;
+    
+    switch (op->type) {
+        case OP_INSERT_CHAR:
+            /* To undo an insert, delete the character */
+            E.cx = op->cx;
+            E.cy = op->cy;
+            if (E.cy < E.numrows) {
+                erow *row = &E.row[E.cy];
+                if (E.cx < row->size && row_text_reserve(row, row->size + 1) == 0) {
+                    stats_char_move(&row->chars[E.cx], &row->chars[E.cx + 1], row->size - E.cx);
+                    row->size--;
+                    E.dirty++;
+                }
+            }
+            break;
+            
+        case OP_DELETE_CHAR:
+            /* To undo a delete, insert the character */
+            E.cx = op->cx;
+            E.cy = op->cy;
+            if (E.cy < E.numrows) {
+                erow *row = &E.row[E.cy];
+                if (row_text_reserve(row, row->size + 2) == -1) {
+                    editor_set_status("Memory allocation failed");
+                    return;
+                }
+                stats_char_move(&row->chars[E.cx + 1], &row->chars[E.cx], row->size - E.cx + 1);
+                row->size++;
+                row->chars[E.cx] = op->c;
+                E.dirty++;
+            }
+            break;
+            
+        case OP_INSERT_LINE:
+            /* To undo an inserted line, delete it */
+            editor_del_row(op->cy);
+            E.cx = 0;
+            E.cy = op->cy;
+            break;
+            
+        case OP_DELETE_LINE:
+            /* To undo a deleted line, insert it back */
+            editor_insert_row(op->cy, op->line, op->line_size);
+            E.cx = 0;
+            E.cy = op->cy;
+            break;
+            
+        case OP_NEWLINE:
+            /* To undo a newline, we need to merge the current line with the previous one */
+            if (E.cy > 0) {
+                erow *prev_row = &E.row[E.cy - 1];
+                erow *curr_row = &E.row[E.cy];
+                
+                /* Save the original line content for redo */
+                char *line_copy = NULL;
+                if (op->line) {
+                    line_copy = editor_strdup(MEM_UNDO, op->line);
+                }
+                
+                /* Merge the current line into the previous one */
+                int new_size = prev_row->size + curr_row->size;
+                if (row_text_reserve(prev_row, new_size + 1) == 0) {
+                    memcpy(prev_row->chars + prev_row->size, curr_row->chars, curr_row->size);
+                    prev_row->size = new_size;
+                    prev_row->chars[new_size] = '\0';
+                    
+                    /* Delete the current row */
+                    editor_del_row(E.cy);
+                    
+                    /* Update cursor position */
+                    E.cy--;
+                    E.cx = op->cx;
+                    E.dirty++;
+                    
+                    /* Update the operation for redo */
+                    editor_free(MEM_UNDO, op->line);
+                    op->line = line_copy;
+                    if (line_copy) {
+                        op->line_size = strlen(line_copy);
+                    } else {
+                        op->line_size = 0;
+                    }
+                }
+            }
+            break;
+            
+        case OP_REPLACE_ROWS:
+        case OP_SWAP_ROWS:
+            /* Handled above */
+            break;
+    }
+    
+    /* Add to redo stack */
+    push_operation(&E.redo_stack, op->type, op->cx, op->cy, op->c, op->line, op->line_size);
+    
+    free_operation(op);
+}
+
+/* Redo last undone operation */
+void editor_redo() {
+    if (E.redo_stack == NULL) {
+        editor_set_status("Nothing to redo");
+        return;
+    }
+    
+    operation *op = E.redo_stack;
+    
+    if (op->type == OP_SWAP_ROWS) {
+        swap_row_set(op);
+        E.redo_stack = op->next;
+        op->next = E.undo_stack;
+        E.undo_stack = op;
+        return;
+    }
+    if (op->type == OP_REPLACE_ROWS) {
+        if (swap_replaced_rows(op) == 0) {
+            E.redo_stack = op->next;
+            op->next = E.undo_stack;
+            E.undo_stack = op;
+        }
+        return;
+    }
+    
+    E.redo_stack = op->next;
+    
+    switch (op->type) {
+        case OP_INSERT_CHAR:
+            /* To redo an insert, insert the character again */
+            E.cx = op->cx;
+            E.cy = op->cy;
+            editor_insert_char(op->c);
+            break;
+            
+        case OP_DELETE_CHAR:
+            /* To redo a delete, delete the character again */
+            E.cx = op->cx + 1;
+            E.cy = op->cy;
+            editor_del_char();
+            break;
+            
+        case OP_INSERT_LINE:
+            /* To redo an inserted line, insert it again */
+            editor_insert_row(op->cy, op->line, op->line_size);
+            E.cx = 0;
+            E.cy = op->cy;
+            break;
+            
+        case OP_DELETE_LINE:
+            /* To redo a deleted line, delete it again */
+            editor_del_row(op->cy);
+            E.cx = 0;
+            E.cy = op->cy;
+            break;
+            
+        case OP_NEWLINE:
+            /* To redo a newline, we need to split the line at the cursor position */
+            if (E.cy < E.numrows) {
+                /* Save the current cursor position */
+                int save_cx = E.cx;
+                int save_cy = E.cy;
+                
+                /* Set cursor to the position where newline was inserted */
+                E.cx = op->cx;
+                E.cy = op->cy;
+                
+                /* Insert a newline at the cursor position */
+                editor_insert_newline();
+                
+                /* If there was text after the cursor, restore it to the new line */
+                if (op->line && op->line_size > 0) {
+                    erow *new_row = &E.row[E.cy];
+                    char *text = row_text_new(op->line, op->line_size);
+                    if (text) {
+                        row_text_unref(new_row->chars);
+                        new_row->chars = text;
+                        new_row->size = op->line_size;
+                        editor_row_changed(E.cy);
+                    }
+                }
+                
+                /* Restore cursor position */
+                E.cx = save_cx;
+                E.cy = save_cy;
+            }
+            break;
+            
+        case OP_REPLACE_ROWS:
+        case OP_SWAP_ROWS:
+            /* Handled above */
+            break;
+    }
+    
+    /* Add back to undo stack */
+    push_operation(&E.undo_stack, op->type, op->cx, op->cy, op->c, op->line, op->line_size);
+    
+    free_operation(op);
+}
+